@@ -0,0 +1,234 @@
+//
+//  main.cpp
+//  coreKit
+//
+//
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <coreKit/Log/BinaryLogger.hpp>
+#include <coreKit/Log/ForwardSink.hpp>
+#include <coreKit/Log/Log.hpp>
+#include <coreKit/Log/Logger.hpp>
+#include <coreKit/Utils/Histogram.hpp>
+
+static coreKit::Logger textLogger( { "coreKit", "SampleText" }, coreKit::Logger::Type::Internal, spdlog::level::info );
+static coreKit::BinaryLogger binaryLogger( { "coreKit", "SampleBinary" }, coreKit::Logger::Type::Internal, spdlog::level::info );
+
+// Log call latency in nanoseconds, over all threads
+
+template<typename LoggerType>
+static coreKit::Histogram::Snapshot bench(LoggerType &logger, size_t threadCount, size_t recordCount) {
+    
+    coreKit::Histogram histogram;
+    std::vector<std::thread> threads;
+    
+    for (size_t thread = 0; thread < threadCount; thread++) {
+        threads.emplace_back([&logger, &histogram, thread, recordCount]() {
+            for (size_t record = 0; record < recordCount; record++) {
+                
+                auto start = std::chrono::steady_clock::now();
+                logger->info("Thread {} record {} value {} state {}", thread, record, record * 3.5, "nominal");
+                auto end = std::chrono::steady_clock::now();
+                
+                histogram.record(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+            }
+        });
+    }
+    
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    
+    logger->flush();
+    
+    return histogram.snapshot();
+}
+
+static void print(const char *name, const coreKit::Histogram::Snapshot &snapshot) {
+    printf("  %-12s : p50 %8llu ns, p99 %8llu ns, p99.9 %8llu ns, max %8llu ns\n", name,
+           static_cast<unsigned long long>(snapshot.quantile(0.5)),
+           static_cast<unsigned long long>(snapshot.quantile(0.99)),
+           static_cast<unsigned long long>(snapshot.quantile(0.999)),
+           static_cast<unsigned long long>(snapshot._max));
+}
+
+// Decode a binary log file to the standard output
+
+static int decode(const std::string &path, size_t limit) {
+    
+    std::ifstream stream(path, std::ios::binary);
+    
+    if (!stream) {
+        std::cerr << "Can't open " << path << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    try {
+        
+        coreKit::BinaryFormat::Decoder decoder(stream);
+        coreKit::BinaryFormat::Entry entry;
+        
+        size_t count = 0;
+        
+        while (decoder.next(entry)) {
+            
+            if (count++ >= limit) {
+                continue;
+            }
+            
+            time_t seconds = static_cast<time_t>(entry._time / 1000000000);
+            struct tm date;
+            char buffer[32];
+            
+            localtime_r(&seconds, &date);
+            strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &date);
+            
+            printf("[%s.%06llu] [%s] [%s] [%llu] %s\n", buffer,
+                   static_cast<unsigned long long>((entry._time / 1000) % 1000000),
+                   entry._logger.c_str(),
+                   spdlog::level::to_str(entry._level),
+                   static_cast<unsigned long long>(entry._threadId),
+                   entry._text.c_str());
+        }
+        
+        printf("%zu records, %llu dropped%s\n", count,
+               static_cast<unsigned long long>(decoder.getDropped()),
+               decoder.isTruncated() ? ", last record truncated" : "");
+        
+    } catch (const std::exception &e) {
+        std::cerr << "Decoding failed : " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, const char*argv[]) {
+    
+    // Parse command line arguments
+    
+    size_t threadCount;
+    size_t recordCount;
+    size_t limit;
+    std::string decodePath;
+    coreKit::BinaryLog::Config config;
+    
+    {
+        namespace po        = boost::program_options;
+        namespace po_style  = boost::program_options::command_line_style;
+        
+        po::options_description desc { "Options :" };
+        
+        // Options definition
+        
+        desc.add_options()
+        ("help,h", "Display this help screen")
+        ("threads,t", po::value<size_t>()->default_value(4), "Logging threads for the benchmark")
+        ("records,r", po::value<size_t>()->default_value(100000), "Records per thread")
+        ("capacity,c", po::value<size_t>()->default_value(1 << 20), "Binary ring bytes per thread")
+        ("overflow,o", po::value<std::string>()->default_value("block"), "Full ring policy (block, drop or count)")
+        ("output,f", po::value<std::string>()->default_value("sample_binlog.bin"), "Binary log file written by the benchmark")
+        ("decode,d", po::value<std::string>(), "Decode a binary log file, then exit")
+        ("limit,l", po::value<size_t>()->default_value(20), "Records printed by the decoder");
+        
+        // Boost program options initialization
+        
+        po::variables_map vm;
+        
+        {
+            po::store(po::command_line_parser(argc, argv).options(desc).style(po_style::unix_style | po_style::case_insensitive).run(), vm);
+            po::notify(vm);
+            
+            if (vm.count("help")) {
+                std::cout << desc << std::endl;
+                
+                return EXIT_SUCCESS;
+            }
+            
+            threadCount = vm["threads"].as<size_t>();
+            recordCount = vm["records"].as<size_t>();
+            limit       = vm["limit"].as<size_t>();
+            
+            if (vm.count("decode")) {
+                decodePath = vm["decode"].as<std::string>();
+            }
+            
+            auto overflow = vm["overflow"].as<std::string>();
+            
+            config._capacity    = vm["capacity"].as<size_t>();
+            config._period      = 1000;
+            config._path        = vm["output"].as<std::string>();
+            config._text        = false;
+            
+            if (overflow == "block") {
+                config._overflow = coreKit::AsyncQueue::Overflow::Block;
+            } else if (overflow == "drop") {
+                config._overflow = coreKit::AsyncQueue::Overflow::Drop;
+            } else if (overflow == "count") {
+                config._overflow = coreKit::AsyncQueue::Overflow::Count;
+            } else {
+                std::cerr << "Unknown overflow policy : " << overflow << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    
+    // Decoder
+    
+    if (!decodePath.empty()) {
+        return decode(decodePath, limit);
+    }
+    
+    // Add log sink (The text benchmark writes to memory, formatting is what it measures)
+    
+    size_t written = 0;
+    
+    auto sink = std::make_shared<coreKit::ForwardSink_mt>([&written](const coreKit::ForwardSink_mt::Msg &msg) {
+        written += (msg.formatted.size() != 0);
+    });
+    
+    coreKit::Log::subscribe(sink, coreKit::Logger::Type::Internal);
+    
+    // Binary log while stopped (Formatted synchronously, as text)
+    
+    binaryLogger->info("Welcome to coreKit ! ({} {} {})", 42, 1.5, "arguments");
+    
+    // Benchmark
+    
+    std::cout << "Log call latency (" << threadCount << " threads, " << recordCount << " records each)" << std::endl;
+    
+    print("text", bench(textLogger, threadCount, recordCount));
+    
+    coreKit::BinaryLog::start(config);
+    
+    print("binary", bench(binaryLogger, threadCount, recordCount));
+    
+    coreKit::BinaryLog::stop();
+    
+    auto stats = coreKit::BinaryLog::getStats();
+    
+    printf("  Text records %zu, binary records %llu in %llu batches (%llu bytes, %.1f per record), %llu dropped, %llu blocked calls\n", written,
+           static_cast<unsigned long long>(stats._written),
+           static_cast<unsigned long long>(stats._batches),
+           static_cast<unsigned long long>(stats._bytes),
+           stats._written ? static_cast<double>(stats._bytes) / stats._written : 0.0,
+           static_cast<unsigned long long>(stats._dropped),
+           static_cast<unsigned long long>(stats._blocked));
+    
+    coreKit::Log::unsubscribe(sink, coreKit::Logger::Type::Internal);
+    
+    // Decode what was written
+    
+    std::cout << "Decoded " << config._path << std::endl;
+    
+    return decode(config._path, 5);
+}
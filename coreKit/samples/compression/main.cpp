@@ -0,0 +1,240 @@
+//
+//  main.cpp
+//  coreKit
+//
+//
+
+#include <atomic>
+#include <ctime>
+#include <cstdio>
+#include <future>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <coreKit/Metrics/Registry.hpp>
+#include <coreKit/Stream/Client.hpp>
+#include <coreKit/Stream/Server.hpp>
+#include <coreKit/Utils/Crc.hpp>
+
+using namespace coreKit::Stream;
+
+// Telemetry like frames (Repetitive text with a few changing values)
+
+static std::vector<std::string> makeFrames(size_t count) {
+    
+    std::vector<std::string> result;
+    std::mt19937 random(42);
+    
+    char buffer[512];
+    
+    for (size_t index = 0; index < count; index++) {
+        
+        int length = snprintf(buffer, sizeof(buffer),
+                              "{\"type\":\"telemetry\",\"sequence\":%zu,\"position\":{\"latitude\":%.6f,\"longitude\":%.6f,\"altitude\":%.1f},"
+                              "\"battery\":{\"voltage\":%.2f,\"current\":%.2f,\"level\":%u},\"status\":\"%s\"}",
+                              index,
+                              48.0 + (random() % 100000) / 1e6,
+                              2.0 + (random() % 100000) / 1e6,
+                              (random() % 12000) / 10.0,
+                              22.0 + (random() % 300) / 100.0,
+                              (random() % 4000) / 100.0,
+                              static_cast<unsigned int>(random() % 100),
+                              (random() % 50 == 0 ? "warning" : "nominal"));
+        
+        result.push_back(std::string(buffer, length));
+    }
+    
+    return result;
+}
+
+static uint64_t bytesReceived() {
+    
+    auto snapshot = coreKit::Metrics::Registry::snapshot();
+    auto iterator = snapshot._counters.find("coreKit.Stream.Session.BytesReceived");
+    
+    return (iterator != snapshot._counters.end() ? iterator->second : 0);
+}
+
+int main(int argc, const char*argv[]) {
+    
+    // Parse command line arguments
+    
+    size_t count;
+    size_t threshold;
+    Session::Framing framing;
+    
+    {
+        namespace po        = boost::program_options;
+        namespace po_style  = boost::program_options::command_line_style;
+        
+        po::options_description desc { "Options :" };
+        
+        // Options definition
+        
+        desc.add_options()
+        ("help,h", "Display this help screen")
+        ("count,c", po::value<size_t>()->default_value(20000), "Number of frames to be sent per mode")
+        ("threshold", po::value<size_t>()->default_value(64), "Frames smaller than this are sent raw (Bytes)")
+        ("checked", "Use the checked framing (Header check and payload CRC-32C)");
+        
+        // Boost program options initialization
+        
+        po::variables_map vm;
+        
+        {
+            po::store(po::command_line_parser(argc, argv).options(desc).style(po_style::unix_style | po_style::case_insensitive).run(), vm);
+            po::notify(vm);
+            
+            if (vm.count("help")) {
+                std::cout << desc << std::endl;
+                
+                return EXIT_SUCCESS;
+            }
+            
+            count = vm["count"].as<size_t>();
+            threshold = vm["threshold"].as<size_t>();
+            framing = (vm.count("checked") ? Session::Framing::Checked : Session::Framing::Length);
+        }
+        
+        if (count == 0) {
+            std::cerr << "At least one frame must be sent" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    
+    auto frames = makeFrames(count);
+    
+    size_t payloadSize = 0;
+    uint32_t payloadCrc = 0;
+    for (const auto &frame : frames) {
+        payloadSize += frame.size();
+        payloadCrc = coreKit::crc32(payloadCrc, frame.data(), frame.size());
+    }
+    
+    // Same frames, sent over a local TCP session with each mode
+    
+    struct Mode {
+        
+        const char *_name;
+        Session::Compression _compression;
+        
+    };
+    
+    std::vector<Mode> modes = {
+        { "none",           { Session::Codec::None, 0,          false } },
+        { "lz4",            { Session::Codec::Lz4,  threshold,  false } },
+        { "lz4 + dict",     { Session::Codec::Lz4,  threshold,  true  } }
+    };
+    
+    std::cout << "Frames   : " << count << " x " << payloadSize / count << " Bytes on average" << std::endl;
+    
+    for (const auto &mode : modes) {
+        
+        try {
+            
+            std::atomic<size_t> received(0);
+            std::atomic<size_t> receivedSize(0);
+            uint32_t receivedCrc = 0;
+            std::promise<void> done;
+            
+            // Server (Only decodes, announces what it supports)
+            
+            auto server = makeServer("tcp://127.0.0.1:0");
+            
+            Server::Callbacks serverCallbacks = {
+                
+                // OnDataReceived
+                [&](Server::SessionId, const void *data, size_t dataLength) {
+                    
+                    receivedSize += dataLength;
+                    receivedCrc = coreKit::crc32(receivedCrc, data, dataLength);
+                    if (++received == count) {
+                        done.set_value();
+                    }
+                },
+                
+                // OnClosed
+                nullptr,
+                
+                // OnNewSession
+                nullptr,
+                
+                // OnSessionDisconnected
+                nullptr,
+                
+                // Compression (Announces the codec it decodes, frames are only received)
+                { Session::Codec::Lz4, 0, false },
+                
+                // Framing
+                framing
+                
+            };
+            
+            std::promise<void> accepted;
+            server->accept(serverCallbacks, [&accepted](const std::exception_ptr error) {
+                if (error) {
+                    accepted.set_exception(error);
+                } else {
+                    accepted.set_value();
+                }
+            });
+            accepted.get_future().get();
+            
+            // Client
+            
+            auto client = makeClient(server->getLocalUri());
+            
+            Client::Callbacks clientCallbacks = {
+                nullptr, nullptr, mode._compression, framing
+            };
+            
+            std::promise<void> opened;
+            client->open(clientCallbacks, [&opened](const std::exception_ptr error) {
+                if (error) {
+                    opened.set_exception(error);
+                } else {
+                    opened.set_value();
+                }
+            }, 2000);
+            opened.get_future().get();
+            
+            // Send every frame, measure the process CPU time (Both sides included)
+            
+            auto wireStart = bytesReceived();
+            auto cpuStart = std::clock();
+            
+            for (const auto &frame : frames) {
+                client->send(Session::Buffer(frame.data(), frame.size()), nullptr);
+            }
+            
+            if (done.get_future().wait_for(std::chrono::seconds(30)) != std::future_status::ready) {
+                throw std::runtime_error("Some frames were never received");
+            }
+            
+            auto cpuTime = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+            auto wireSize = bytesReceived() - wireStart;
+            
+            if (receivedSize != payloadSize || receivedCrc != payloadCrc) {
+                throw std::runtime_error("Received payloads do not match");
+            }
+            
+            std::cout << "Mode     : " << mode._name << "\n"
+            << "  Wire   : " << wireSize << " Bytes (" << (100.0 * wireSize) / payloadSize << " % of the payloads)\n"
+            << "  CPU    : " << (cpuTime * 1e6) / count << " us per frame" << std::endl;
+            
+            std::promise<void> closed;
+            client->close([&closed]() { closed.set_value(); });
+            closed.get_future().wait();
+            
+        } catch (const std::exception &exception) {
+            std::cerr << "Mode " << mode._name << " failed : " << exception.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    
+    return EXIT_SUCCESS;
+}
@@ -7,6 +7,10 @@
 #include <iostream>
 
 #include <coreKit/Config/Config.hpp>
+#include <coreKit/Log/Log.hpp>
+#include <coreKit/Log/Logger.hpp>
+
+static coreKit::Logger logger( { "coreKit", "SampleConfig" } );
 
 const coreKit::ConfigList configList_1({ "Video", "TestSource" }, {
     
@@ -63,6 +67,25 @@ int main() {
         std::cout << "Framerate (fps)    : " << coreKit::Config::get_generic("Video.TestSource.Framerate") << std::endl;
     }
     
+    {
+        // Runtime log levels (Applied to the live loggers, as on a config file reload)
+        std::cout<<"\n\nLog levels : \n";
+        
+        coreKit::Config::getParam_generic("coreKit.Log.Levels")->subscribe([](const coreKit::Parameter &parameter) {
+            std::cout << "Levels changed     : " << parameter.get_generic() << std::endl;
+        });
+        
+        std::cout << "Debug enabled      : " << logger.should_log(spdlog::level::debug) << std::endl;
+        
+        coreKit::Config::set_generic("coreKit.Log.Levels", "{ coreKit.SampleConfig: warn }");
+        
+        std::cout << "Debug enabled      : " << logger.should_log(spdlog::level::debug) << std::endl;
+        
+        coreKit::Config::set_generic("coreKit.Log.Levels", "{ coreKit: debug }");
+        
+        std::cout << "Debug enabled      : " << logger.should_log(spdlog::level::debug) << std::endl;
+    }
+    
     // Exit
     
     return EXIT_SUCCESS;
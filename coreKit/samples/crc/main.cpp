@@ -0,0 +1,271 @@
+//
+//  main.cpp
+//  coreKit
+//
+//
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <coreKit/Utils/Context.hpp>
+#include <coreKit/Utils/Crc.hpp>
+#include <coreKit/Utils/CrcEngine.hpp>
+
+// Reference tables (Built bit by bit, used with the byte-at-a-time crc<T>)
+
+template<typename T>
+static std::vector<T> makeReflectedTable(T polynomial) {
+    
+    std::vector<T> result(256);
+    
+    for (size_t index = 0; index < 256; index++) {
+        
+        T crc = static_cast<T>(index);
+        for (int bit = 0; bit < 8; bit++) {
+            crc = static_cast<T>((crc & 1) ? (crc >> 1) ^ polynomial : crc >> 1);
+        }
+        
+        result[index] = crc;
+    }
+    
+    return result;
+}
+
+static std::vector<uint16_t> makeCcittTable() {
+    
+    std::vector<uint16_t> result(256);
+    
+    for (size_t index = 0; index < 256; index++) {
+        
+        uint16_t crc = static_cast<uint16_t>(index << 8);
+        for (int bit = 0; bit < 8; bit++) {
+            crc = static_cast<uint16_t>((crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1);
+        }
+        
+        result[index] = crc;
+    }
+    
+    return result;
+}
+
+// Throughput in MB/s
+
+template<typename Function>
+static double measure(const std::vector<uint8_t> &buffer, size_t size, size_t totalSize, const Function &function) {
+    
+    size_t iterations = std::max<size_t>(totalSize / size, 1);
+    
+    uint64_t result = 0;
+    
+    auto start = std::chrono::steady_clock::now();
+    for (size_t iteration = 0; iteration < iterations; iteration++) {
+        result += function(static_cast<uint32_t>(result), buffer.data(), size);
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    // Keep the result alive
+    
+    volatile uint64_t sink = result;
+    (void) sink;
+    
+    return (iterations * size) / (elapsed * 1e6);
+}
+
+template<typename T, typename Function>
+static bool run(const char *name,
+                const std::vector<T> &table,
+                const Function &function,
+                const std::vector<uint8_t> &buffer,
+                const std::vector<size_t> &sizes,
+                size_t totalSize) {
+    
+    auto reference = [&table](T crc, const void *data, size_t dataLength) {
+        return coreKit::crc<T>(crc, data, dataLength, table.data());
+    };
+    
+    // Correctness (Every length up to 1 KB, misaligned buffers and chained calls)
+    
+    std::mt19937 random(7);
+    
+    for (size_t length = 0; length <= 1024; length++) {
+        
+        size_t offset = length % 8;
+        size_t split = (length != 0 ? random() % length : 0);
+        T seed = static_cast<T>(random());
+        
+        auto expected = reference(seed, buffer.data() + offset, length);
+        auto whole = function(seed, buffer.data() + offset, length);
+        auto chained = function(function(seed, buffer.data() + offset, split), buffer.data() + offset + split, length - split);
+        
+        if (whole != expected || chained != expected) {
+            std::cerr << name << " : Mismatch with the reference for " << length << " bytes" << std::endl;
+            return false;
+        }
+    }
+    
+    // Throughput
+    
+    std::cout << name << "\n";
+    
+    for (auto size : sizes) {
+        
+        auto referenceRate = measure(buffer, size, totalSize, reference);
+        auto rate = measure(buffer, size, totalSize, function);
+        
+        printf("  %8zu Bytes : %9.1f MB/s reference, %9.1f MB/s dispatched (x %.1f)\n", size, referenceRate, rate, rate / referenceRate);
+    }
+    
+    return true;
+}
+
+// Presets (Check value and throughput on the largest buffer)
+
+template<typename Engine>
+static void preset(const char *name,
+                   const std::vector<uint8_t> &buffer,
+                   size_t size,
+                   size_t totalSize) {
+    
+    auto rate = measure(buffer, size, totalSize, [](uint32_t crc, const void *data, size_t dataLength) {
+        return Engine::finalize(Engine::update(static_cast<typename Engine::Value>(crc), data, dataLength));
+    });
+    
+    printf("  %-16s : check 0x%016llx, %9.1f MB/s\n", name, static_cast<unsigned long long>(Engine::compute("123456789", 9)), rate);
+}
+
+int main(int argc, const char*argv[]) {
+    
+    // Parse command line arguments
+    
+    size_t totalSize;
+    size_t threadCount;
+    
+    {
+        namespace po        = boost::program_options;
+        namespace po_style  = boost::program_options::command_line_style;
+        
+        po::options_description desc { "Options :" };
+        
+        // Options definition
+        
+        desc.add_options()
+        ("help,h", "Display this help screen")
+        ("megabytes,m", po::value<size_t>()->default_value(256), "Bytes to be processed per measurement (MB)")
+        ("threads,t", po::value<size_t>()->default_value(std::thread::hardware_concurrency()), "Worker threads for the parallel CRC");
+        
+        // Boost program options initialization
+        
+        po::variables_map vm;
+        
+        {
+            po::store(po::command_line_parser(argc, argv).options(desc).style(po_style::unix_style | po_style::case_insensitive).run(), vm);
+            po::notify(vm);
+            
+            if (vm.count("help")) {
+                std::cout << desc << std::endl;
+                
+                return EXIT_SUCCESS;
+            }
+            
+            totalSize = vm["megabytes"].as<size_t>() * 1000 * 1000;
+            threadCount = vm["threads"].as<size_t>();
+        }
+    }
+    
+    const std::vector<size_t> sizes = { 16, 64, 256, 1024, 4096, 65536, 1024 * 1024 };
+    
+    std::vector<uint8_t> buffer(sizes.back() + 16);
+    std::mt19937 random(42);
+    for (auto &byte : buffer) {
+        byte = static_cast<uint8_t>(random());
+    }
+    
+    bool success = true;
+    
+    success &= run<uint16_t>("crc16 (CCITT)", makeCcittTable(), [](uint16_t crc, const void *data, size_t dataLength) {
+        return coreKit::crc16(crc, data, dataLength);
+    }, buffer, sizes, totalSize);
+    
+    success &= run<uint32_t>("crc32", makeReflectedTable<uint32_t>(0xEDB88320), [](uint32_t crc, const void *data, size_t dataLength) {
+        return coreKit::crc32(crc, data, dataLength);
+    }, buffer, sizes, totalSize);
+    
+    success &= run<uint32_t>("crc32c", makeReflectedTable<uint32_t>(0x82F63B78), [](uint32_t crc, const void *data, size_t dataLength) {
+        return coreKit::crc32c(crc, data, dataLength);
+    }, buffer, sizes, totalSize);
+    
+    success &= run<uint64_t>("crc64 (Jones)", makeReflectedTable<uint64_t>(UINT64_C(0x95AC9329AC4BC9B5)), [](uint64_t crc, const void *data, size_t dataLength) {
+        return coreKit::crc64(crc, data, dataLength);
+    }, buffer, sizes, totalSize);
+    
+    // Compile time engines
+    
+    std::cout << "Presets" << std::endl;
+    
+    preset<coreKit::Crc8Smbus>("CRC-8/SMBUS", buffer, sizes.back(), totalSize);
+    preset<coreKit::Crc15Can>("CRC-15/CAN", buffer, sizes.back(), totalSize);
+    preset<coreKit::Crc16Modbus>("CRC-16/MODBUS", buffer, sizes.back(), totalSize);
+    preset<coreKit::Crc16Ibm3740>("CRC-16/IBM-3740", buffer, sizes.back(), totalSize);
+    preset<coreKit::Crc24OpenPgp>("CRC-24/OPENPGP", buffer, sizes.back(), totalSize);
+    preset<coreKit::Crc32Bzip2>("CRC-32/BZIP2", buffer, sizes.back(), totalSize);
+    preset<coreKit::Crc32Iscsi>("CRC-32/ISCSI", buffer, sizes.back(), totalSize);
+    preset<coreKit::Crc64Ecma182>("CRC-64/ECMA-182", buffer, sizes.back(), totalSize);
+    preset<coreKit::Crc64Xz>("CRC-64/XZ", buffer, sizes.back(), totalSize);
+    
+    // Parallel CRC over one large buffer
+    
+    if (success && threadCount != 0) {
+        
+        coreKit::Context context(threadCount);
+        context.start();
+        
+        std::vector<uint8_t> large(totalSize);
+        for (size_t index = 0; index < large.size(); index++) {
+            large[index] = buffer[index % buffer.size()];
+        }
+        
+        std::cout << "Parallel (" << threadCount << " threads, " << large.size() / 1000000 << " MB)" << std::endl;
+        
+        struct Type {
+            
+            const char *_name;
+            coreKit::CrcType _type;
+            
+        };
+        
+        for (const auto &type : { Type { "crc32", coreKit::CrcType::Crc32 }, Type { "crc32c", coreKit::CrcType::Crc32c }, Type { "crc64", coreKit::CrcType::Crc64 } }) {
+            
+            auto start = std::chrono::steady_clock::now();
+            
+            coreKit::CrcStream stream(type._type);
+            stream.update(large.data(), large.size());
+            
+            auto middle = std::chrono::steady_clock::now();
+            
+            auto result = coreKit::crcParallel(context, type._type, 0, large.data(), large.size());
+            
+            auto end = std::chrono::steady_clock::now();
+            
+            if (result != stream.getValue()) {
+                std::cerr << type._name << " : Parallel CRC mismatch" << std::endl;
+                success = false;
+            }
+            
+            auto serialTime = std::chrono::duration<double>(middle - start).count();
+            auto parallelTime = std::chrono::duration<double>(end - middle).count();
+            
+            printf("  %-6s : %9.1f MB/s serial, %9.1f MB/s parallel (x %.1f)\n", type._name,
+                   large.size() / (serialTime * 1e6), large.size() / (parallelTime * 1e6), serialTime / parallelTime);
+        }
+        
+        context.stop();
+    }
+    
+    return (success ? EXIT_SUCCESS : EXIT_FAILURE);
+}
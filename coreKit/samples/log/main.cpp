@@ -4,12 +4,153 @@
 //
 //
 
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <coreKit/Log/ForwardSink.hpp>
 #include <coreKit/Log/Logger.hpp>
 #include <coreKit/Log/Log.hpp>
+#include <coreKit/Utils/Histogram.hpp>
 
 static coreKit::Logger logger( { "coreKit", "SampleLogger"  } );
+static coreKit::Logger benchLogger( { "coreKit", "SampleBench" }, coreKit::Logger::Type::Internal, spdlog::level::info );
+
+// Log call latency in nanoseconds, over all threads
+
+static coreKit::Histogram::Snapshot bench(size_t threadCount, size_t recordCount) {
+    
+    coreKit::Histogram histogram;
+    std::vector<std::thread> threads;
+    
+    for (size_t thread = 0; thread < threadCount; thread++) {
+        threads.emplace_back([&histogram, thread, recordCount]() {
+            for (size_t record = 0; record < recordCount; record++) {
+                
+                auto start = std::chrono::steady_clock::now();
+                benchLogger->info("Thread {} record {} value {}", thread, record, record * 3.5);
+                auto end = std::chrono::steady_clock::now();
+                
+                histogram.record(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+            }
+        });
+    }
+    
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    
+    benchLogger->flush();
+    
+    return histogram.snapshot();
+}
+
+// Mean log call cost in nanoseconds, over all threads
+
+static double cost(size_t threadCount, size_t recordCount, spdlog::level::level_enum level) {
+    
+    std::vector<std::thread> threads;
+    std::vector<uint64_t> durations(threadCount);
+    
+    for (size_t thread = 0; thread < threadCount; thread++) {
+        threads.emplace_back([&durations, thread, recordCount, level]() {
+            
+            auto start = std::chrono::steady_clock::now();
+            
+            for (size_t record = 0; record < recordCount; record++) {
+                benchLogger->log(level, "Thread {} record {} value {}", thread, record, record * 3.5);
+            }
+            
+            auto end = std::chrono::steady_clock::now();
+            
+            durations[thread] = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        });
+    }
+    
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    
+    uint64_t total = 0;
+    for (auto duration : durations) {
+        total += duration;
+    }
+    
+    return static_cast<double>(total) / (threadCount * recordCount);
+}
+
+static void print(const char *name, const coreKit::Histogram::Snapshot &snapshot) {
+    printf("  %-12s : p50 %8llu ns, p99 %8llu ns, p99.9 %8llu ns, max %8llu ns\n", name,
+           static_cast<unsigned long long>(snapshot.quantile(0.5)),
+           static_cast<unsigned long long>(snapshot.quantile(0.99)),
+           static_cast<unsigned long long>(snapshot.quantile(0.999)),
+           static_cast<unsigned long long>(snapshot._max));
+}
 
-int main() {
+int main(int argc, const char*argv[]) {
+    
+    // Parse command line arguments
+    
+    size_t threadCount;
+    size_t recordCount;
+    uint64_t sinkDelay;
+    coreKit::AsyncQueue::Config config;
+    
+    {
+        namespace po        = boost::program_options;
+        namespace po_style  = boost::program_options::command_line_style;
+        
+        po::options_description desc { "Options :" };
+        
+        // Options definition
+        
+        desc.add_options()
+        ("help,h", "Display this help screen")
+        ("threads,t", po::value<size_t>()->default_value(8), "Logging threads for the benchmark (0 skips it)")
+        ("records,r", po::value<size_t>()->default_value(20000), "Records per thread")
+        ("delay,d", po::value<uint64_t>()->default_value(2), "Benchmark sink write time in microseconds (Slow console)")
+        ("capacity,c", po::value<size_t>()->default_value(4096), "Asynchronous ring capacity per thread")
+        ("overflow,o", po::value<std::string>()->default_value("block"), "Full ring policy (block, drop or count)");
+        
+        // Boost program options initialization
+        
+        po::variables_map vm;
+        
+        {
+            po::store(po::command_line_parser(argc, argv).options(desc).style(po_style::unix_style | po_style::case_insensitive).run(), vm);
+            po::notify(vm);
+            
+            if (vm.count("help")) {
+                std::cout << desc << std::endl;
+                
+                return EXIT_SUCCESS;
+            }
+            
+            threadCount = vm["threads"].as<size_t>();
+            recordCount = vm["records"].as<size_t>();
+            sinkDelay   = vm["delay"].as<uint64_t>();
+            
+            auto overflow = vm["overflow"].as<std::string>();
+            
+            config._capacity    = vm["capacity"].as<size_t>();
+            config._period      = 1000;
+            
+            if (overflow == "block") {
+                config._overflow = coreKit::AsyncQueue::Overflow::Block;
+            } else if (overflow == "drop") {
+                config._overflow = coreKit::AsyncQueue::Overflow::Drop;
+            } else if (overflow == "count") {
+                config._overflow = coreKit::AsyncQueue::Overflow::Count;
+            } else {
+                std::cerr << "Unknown overflow policy : " << overflow << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+    }
     
     // Add log sink
     
@@ -22,7 +163,7 @@ int main() {
             sink = std::make_shared<spdlog::sinks::ansicolor_stdout_sink_mt>();
         }
         
-        coreKit::Log::subscribe(sink);
+        coreKit::Log::subscribe(sink, coreKit::Logger::Type::Public);
     }
     
     // Log
@@ -37,6 +178,73 @@ int main() {
         logger->error    ("Welcome to coreKit !");
     }
     
+    // Rate limit (A flapping link, 5 records per second then a summary every 100 ms)
+    
+    {
+        coreKit::Log::setRateLimit("coreKit.SampleLogger", { 5, 5, 0, 100000 });
+        
+        auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(300);
+        
+        for (size_t attempt = 0; std::chrono::steady_clock::now() < end; attempt++) {
+            COREKIT_LOG_ERROR(logger, "Link is down, attempt {}", attempt);
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        
+        auto stats = coreKit::Log::getRateLimiter({ "coreKit", "SampleLogger" })->getStats();
+        
+        printf("  Rate limit : %llu records written, %llu suppressed\n",
+               static_cast<unsigned long long>(stats._admitted),
+               static_cast<unsigned long long>(stats._suppressed));
+        
+        coreKit::Log::resetRateLimit("coreKit.SampleLogger");
+    }
+    
+    // Benchmark (Synchronous then asynchronous log calls into a slow sink)
+    
+    if (threadCount != 0) {
+        
+        // Note : No sink subscribed yet, enabled records are only formatted
+        
+        std::cout << "Log call cost (" << threadCount << " threads, " << recordCount << " records each)" << std::endl;
+        
+        printf("  %-12s : %8.1f ns\n", "disabled", cost(threadCount, recordCount, spdlog::level::debug));
+        printf("  %-12s : %8.1f ns\n", "enabled", cost(threadCount, recordCount, spdlog::level::info));
+        
+        size_t written = 0;
+        
+        auto sink = std::make_shared<coreKit::ForwardSink_mt>([sinkDelay, &written](const coreKit::ForwardSink_mt::Msg &msg) {
+            
+            auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(sinkDelay);
+            while (std::chrono::steady_clock::now() < end) {
+                // Busy sink
+            }
+            
+            written += (msg.formatted.size() != 0);
+        });
+        
+        coreKit::Log::subscribe(sink, coreKit::Logger::Type::Internal);
+        
+        std::cout << "Log call latency (" << threadCount << " threads, " << recordCount << " records each, " << sinkDelay << " us sink)" << std::endl;
+        
+        print("synchronous", bench(threadCount, recordCount));
+        
+        coreKit::Log::enableAsync(config);
+        
+        print("asynchronous", bench(threadCount, recordCount));
+        
+        coreKit::Log::disableAsync();
+        
+        auto stats = coreKit::Log::getAsyncStats();
+        
+        printf("  Written %zu records (%llu asynchronous in %llu batches), %llu dropped, %llu blocked calls\n", written,
+               static_cast<unsigned long long>(stats._written),
+               static_cast<unsigned long long>(stats._batches),
+               static_cast<unsigned long long>(stats._dropped),
+               static_cast<unsigned long long>(stats._blocked));
+        
+        coreKit::Log::unsubscribe(sink, coreKit::Logger::Type::Internal);
+    }
+    
     // Exit
     
     return EXIT_SUCCESS;
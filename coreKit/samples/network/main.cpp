@@ -0,0 +1,576 @@
+//
+//  main.cpp
+//  coreKit
+//
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include <boost/program_options.hpp>
+
+#include <coreKit/Metrics/Trace.hpp>
+#include <coreKit/Network/NetworkEmulator.hpp>
+#include <coreKit/Network/NetworkTrace.hpp>
+#include <coreKit/Network/ReliableAdapter.hpp>
+#include <coreKit/Network/VirtualClock.hpp>
+#include <coreKit/Utils/Context.hpp>
+
+using namespace coreKit::Network;
+
+static std::map<std::string, NetworkType> networkTypes = {
+    { "perfect" , NetworkType::Perfect  },
+    { "bad"     , NetworkType::Bad      },
+    { "3g"      , NetworkType::HSDPA_3G },
+    { "edge"    , NetworkType::Edge     },
+    { "gprs"    , NetworkType::GPRS     },
+    { "wifi"    , NetworkType::Wifi     },
+    { "lte"     , NetworkType::LTE      },
+    { "satellite", NetworkType::Satellite }
+};
+
+static std::map<std::string, ReliableAdapter::Scheduling> schedulings = {
+    { "strict"  , ReliableAdapter::Scheduling::Strict   },
+    { "weighted", ReliableAdapter::Scheduling::Weighted }
+};
+
+// Commands start with this marker, payloads with their index
+
+static const uint32_t CommandMarker = UINT32_MAX;
+
+int main(int argc, const char*argv[]) {
+    
+    // Parse command line arguments
+    
+    std::string profile;
+    std::string downlinkProfile;
+    size_t payloadSize;
+    size_t count;
+    uint64_t interval_us;
+    size_t mtu;
+    uint64_t batchDelay_us;
+    size_t batchSize;
+    size_t reorderBufferSize;
+    uint64_t holeTimeout_us;
+    bool lanes;
+    std::string scheduling;
+    size_t window;
+    size_t bulkWindow;
+    unsigned int commandWeight;
+    size_t commands;
+    uint64_t commandInterval_ms;
+    size_t fecGroupSize;
+    bool fecAdaptive;
+    uint64_t fecDelay_us;
+    uint64_t rto_ms;
+    uint64_t seed;
+    bool virtualTime;
+    std::string tracePath;
+    NetworkTrace::Ptr trace;
+    bool traceLoop;
+    double traceScale;
+    std::string latencyTracePath;
+    uint64_t timeout_ms;
+    
+    {
+        namespace po        = boost::program_options;
+        namespace po_style  = boost::program_options::command_line_style;
+        
+        po::options_description desc { "Options :" };
+        
+        // Options definition
+        
+        desc.add_options()
+        ("help,h", "Display this help screen")
+        ("profile,p", po::value<std::string>()->default_value("bad"), "Emulated network (perfect, bad, 3g, edge, gprs, wifi, lte, satellite)")
+        ("downlink-profile", po::value<std::string>()->default_value(""), "Emulated network for acknowledgments (Same as profile by default)")
+        ("size,s", po::value<size_t>()->default_value(1024 * 1024), "Payload size in bytes")
+        ("count,c", po::value<size_t>()->default_value(1), "Number of payloads to be sent")
+        ("interval,i", po::value<uint64_t>()->default_value(0), "Interval between payloads in microseconds")
+        ("mtu,m", po::value<size_t>()->default_value(1400), "ReliableAdapter MTU (0 disables fragmentation)")
+        ("batch-delay", po::value<uint64_t>()->default_value(0), "Batching delay in microseconds (0 disables batching)")
+        ("batch-size", po::value<size_t>()->default_value(1200), "Maximum batch size in bytes")
+        ("ordered", po::value<size_t>()->default_value(0), "Reorder buffer size (0 disables ordered delivery)")
+        ("hole-timeout", po::value<uint64_t>()->default_value(500000), "Ordered delivery hole timeout in microseconds")
+        ("lanes", "Send commands and payloads on separate lanes")
+        ("scheduling", po::value<std::string>()->default_value("strict"), "Lanes scheduling (strict, weighted)")
+        ("window", po::value<size_t>()->default_value(0), "Maximum number of in flight messages (0 = unlimited)")
+        ("bulk-window", po::value<size_t>()->default_value(0), "Maximum number of in flight payloads (0 = unlimited)")
+        ("command-weight", po::value<unsigned int>()->default_value(1), "Commands lane weight (Payloads lane weight is 1)")
+        ("commands", po::value<size_t>()->default_value(0), "Number of commands sent while payloads are transfered")
+        ("command-interval", po::value<uint64_t>()->default_value(10), "Interval between commands in milliseconds")
+        ("fec", po::value<size_t>()->default_value(0), "Messages per parity packet (0 disables forward error correction)")
+        ("fec-adaptive", "Adjust parity groups to the observed loss rate")
+        ("fec-delay", po::value<uint64_t>()->default_value(2000), "Maximum time a partial group waits for its parity in microseconds")
+        ("rto", po::value<uint64_t>()->default_value(0), "Retransmission timeout in milliseconds (0 uses the adapter default)")
+        ("seed", po::value<uint64_t>()->default_value(0), "Emulated links seed (0 picks a random one)")
+        ("virtual", "Run on a virtual clock (Deterministic with a seed)")
+        ("trace", po::value<std::string>()->default_value(""), "Replay a network trace (CSV or binary) on both links")
+        ("trace-loop", "Loop the network trace")
+        ("trace-scale", po::value<double>()->default_value(1), "Network trace time scale (0.5 replays twice as fast)")
+        ("latency-trace", po::value<std::string>()->default_value(""), "Record per message stages into a Chrome trace (JSON)")
+        ("timeout,t", po::value<uint64_t>()->default_value(60000), "Global timeout in milliseconds");
+        
+        // Boost program options initialization
+        
+        po::variables_map vm;
+        
+        {
+            po::store(po::command_line_parser(argc, argv).options(desc).style(po_style::unix_style | po_style::case_insensitive).run(), vm);
+            po::notify(vm);
+            
+            if (vm.count("help")) {
+                std::cout << desc << std::endl;
+                
+                return EXIT_SUCCESS;
+            }
+            
+            profile = vm["profile"].as<std::string>();
+            downlinkProfile = vm["downlink-profile"].as<std::string>();
+            payloadSize = vm["size"].as<size_t>();
+            count = vm["count"].as<size_t>();
+            interval_us = vm["interval"].as<uint64_t>();
+            mtu = vm["mtu"].as<size_t>();
+            batchDelay_us = vm["batch-delay"].as<uint64_t>();
+            batchSize = vm["batch-size"].as<size_t>();
+            reorderBufferSize = vm["ordered"].as<size_t>();
+            holeTimeout_us = vm["hole-timeout"].as<uint64_t>();
+            lanes = (vm.count("lanes") != 0);
+            scheduling = vm["scheduling"].as<std::string>();
+            window = vm["window"].as<size_t>();
+            bulkWindow = vm["bulk-window"].as<size_t>();
+            commandWeight = vm["command-weight"].as<unsigned int>();
+            commands = vm["commands"].as<size_t>();
+            commandInterval_ms = vm["command-interval"].as<uint64_t>();
+            fecGroupSize = vm["fec"].as<size_t>();
+            fecAdaptive = (vm.count("fec-adaptive") != 0);
+            fecDelay_us = vm["fec-delay"].as<uint64_t>();
+            rto_ms = vm["rto"].as<uint64_t>();
+            seed = vm["seed"].as<uint64_t>();
+            virtualTime = (vm.count("virtual") != 0);
+            tracePath = vm["trace"].as<std::string>();
+            traceLoop = (vm.count("trace-loop") != 0);
+            traceScale = vm["trace-scale"].as<double>();
+            latencyTracePath = vm["latency-trace"].as<std::string>();
+            timeout_ms = vm["timeout"].as<uint64_t>();
+        }
+        
+        if (payloadSize < sizeof(uint32_t)) {
+            std::cerr << "Payload size must be at least " << sizeof(uint32_t) << " bytes" << std::endl;
+            return EXIT_FAILURE;
+        }
+        
+        if (count == 0) {
+            std::cerr << "At least one payload must be sent" << std::endl;
+            return EXIT_FAILURE;
+        }
+        
+        if (networkTypes.find(profile) == networkTypes.end()) {
+            std::cerr << "Unknown network profile '" << profile << "'" << std::endl;
+            return EXIT_FAILURE;
+        }
+        
+        if (downlinkProfile.empty()) {
+            downlinkProfile = profile;
+        } else if (networkTypes.find(downlinkProfile) == networkTypes.end()) {
+            std::cerr << "Unknown network profile '" << downlinkProfile << "'" << std::endl;
+            return EXIT_FAILURE;
+        }
+        
+        if (schedulings.find(scheduling) == schedulings.end()) {
+            std::cerr << "Unknown scheduling '" << scheduling << "'" << std::endl;
+            return EXIT_FAILURE;
+        }
+        
+        if (!tracePath.empty()) {
+            try {
+                trace = NetworkTrace::load(tracePath);
+            } catch (const std::exception &e) {
+                std::cerr << e.what() << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        
+        if (!latencyTracePath.empty()) {
+            coreKit::Metrics::Trace::enable(1 << 18);
+        }
+    }
+    
+    // Note : The virtual clock runs the io service from the main thread
+    
+    coreKit::Context context(2);
+    auto &ioService = context.getIoService();
+    
+    VirtualClock::Ptr clock = nullptr;
+    if (virtualTime) {
+        clock = std::make_shared<VirtualClock>(ioService);
+    }
+    
+    auto now = [clock]() -> uint64_t {
+        if (clock) {
+            return clock->now();
+        }
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    };
+    
+    // Sender -> Uplink -> Receiver -> Downlink -> Sender
+    
+    // Note : Lane 0 carries commands, lane 1 payloads
+    
+    std::vector<ReliableAdapter::LaneConfig> laneConfigs;
+    if (lanes) {
+        laneConfigs.push_back( { 0, commandWeight, 0, nullptr } );
+        laneConfigs.push_back( { bulkWindow, 1, 0, nullptr } );
+    }
+    
+    const uint8_t commandLane = 0;
+    const uint8_t bulkLane = (lanes ? 1 : 0);
+    
+    std::function<uint64_t(size_t)> timeoutFunc = nullptr;
+    if (rto_ms != 0) {
+        timeoutFunc = [rto_ms](size_t) { return rto_ms * 1000; };
+    }
+    
+    ReliableAdapter::Config config = {
+        timeout_ms * 1000, timeoutFunc, mtu,
+        { batchDelay_us, batchSize },
+        { reorderBufferSize, holeTimeout_us, ReliableAdapter::HolePolicy::Skip },
+        { laneConfigs, schedulings[scheduling], window },
+        { fecGroupSize, fecAdaptive, fecDelay_us },
+        clock
+    };
+    
+    // Note : Each direction gets its own seed
+    
+    auto uplinkConfig = NetworkEmulator::makeConfig(networkTypes[profile]);
+    uplinkConfig._seed = seed;
+    uplinkConfig._clock = clock;
+    
+    auto downlinkConfig = NetworkEmulator::makeConfig(networkTypes[downlinkProfile]);
+    downlinkConfig._seed = (seed != 0 ? seed + 1 : 0);
+    downlinkConfig._clock = clock;
+    
+    if (trace) {
+        uplinkConfig._replay = { trace, traceLoop, traceScale };
+        downlinkConfig._replay = uplinkConfig._replay;
+    }
+    
+    // Note : Outgoing is the uplink (Payloads), incomming the downlink (Acknowledgments)
+    
+    auto sender     = std::make_shared<ReliableAdapter>(ioService, config);
+    auto receiver   = std::make_shared<ReliableAdapter>(ioService, config);
+    auto link       = std::make_shared<NetworkEmulator>(ioService, uplinkConfig, downlinkConfig);
+    
+    // Payloads (Each one starts with its index)
+    
+    std::vector<std::vector<uint8_t> > payloads(count, std::vector<uint8_t>(payloadSize));
+    for (uint32_t index = 0; index < count; index++) {
+        auto &payload = payloads[index];
+        for (size_t i = 0; i < payloadSize; i++) {
+            payload[i] = static_cast<uint8_t>(i * 31 + index);
+        }
+        memcpy(payload.data(), &index, sizeof(index));
+    }
+    
+    std::promise<void> received;
+    std::promise<void> acknowledged;
+    
+    std::atomic_size_t receivedCount(0), acknowledgedCount(0), outOfOrder(0);
+    uint32_t lastIndex = 0;
+    std::atomic_size_t uplinkPackets(0), downlinkPackets(0);
+    
+    sender->init( {
+        nullptr,
+        [link, &uplinkPackets](const Buffer &buffer, const WriteCallback &writeCallback) {
+            uplinkPackets++;
+            link->handleOutgoingData(buffer, writeCallback);
+        },
+        nullptr
+    } );
+    
+    link->init( {
+        [sender](const Buffer &buffer, const WriteCallback &writeCallback) { sender->handleIncommingData(buffer, writeCallback); },
+        [receiver](const Buffer &buffer, const WriteCallback &writeCallback) { receiver->handleIncommingData(buffer, writeCallback); },
+        nullptr
+    } );
+    
+    receiver->init( {
+        [&](const Buffer &buffer, const WriteCallback &writeCallback) {
+            
+            auto data = boost::asio::buffer_cast<const uint8_t*>(buffer);
+            auto dataSize = boost::asio::buffer_size(buffer);
+            
+            uint32_t index;
+            memcpy(&index, data, sizeof(index));
+            
+            if (index == CommandMarker) {
+                if (writeCallback) {
+                    writeCallback(nullptr);
+                }
+                return;
+            }
+            
+            if (index >= count || std::vector<uint8_t>(data, data + dataSize) != payloads[index]) {
+                std::cerr << "Received payload does not match" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            
+            if (receivedCount > 0 && index < lastIndex) {
+                outOfOrder++;
+            }
+            lastIndex = index;
+            
+            if (++receivedCount == count) {
+                received.set_value();
+            }
+            
+            if (writeCallback) {
+                writeCallback(nullptr);
+            }
+        },
+        [link, &downlinkPackets](const Buffer &buffer, const WriteCallback &writeCallback) {
+            downlinkPackets++;
+            link->handleIncommingData(buffer, writeCallback);
+        },
+        nullptr
+    } );
+    
+    // Payloads sending (Latency from send to acknowledgment)
+    
+    auto start = now();
+    std::atomic<uint64_t> end(0);
+    
+    std::vector<uint64_t> payloadLatencies(count);
+    std::atomic_bool failed(false);
+    
+    auto sendPayload = [&](size_t index) {
+        
+        auto sent = now();
+        sender->handleOutgoingData(boost::asio::buffer(payloads[index]), bulkLane, [&, index, sent](const std::exception_ptr error) {
+            
+            // Note : Each payload callback writes its own latency
+            
+            payloadLatencies[index] = now() - sent;
+            
+            if (error) {
+                if (!failed.exchange(true)) {
+                    acknowledged.set_exception(error);
+                }
+            } else if (++acknowledgedCount == count) {
+                end = now();
+                acknowledged.set_value();
+            }
+        });
+    };
+    
+    // Commands sending (Latency from send to acknowledgment)
+    
+    std::mutex latenciesMutex;
+    std::vector<uint64_t> latencies;
+    std::promise<void> commandsAcknowledged;
+    
+    std::vector<std::vector<uint8_t> > commandBuffers(commands, std::vector<uint8_t>(2 * sizeof(uint32_t)));
+    
+    auto sendCommand = [&](uint32_t index) {
+        
+        auto &command = commandBuffers[index];
+        memcpy(command.data(), &CommandMarker, sizeof(CommandMarker));
+        memcpy(command.data() + sizeof(CommandMarker), &index, sizeof(index));
+        
+        auto sent = now();
+        sender->handleOutgoingData(boost::asio::buffer(command), commandLane, [&, sent](const std::exception_ptr error) {
+            
+            std::lock_guard<std::mutex> lock(latenciesMutex);
+            
+            if (error) {
+                latencies.push_back(UINT64_MAX);
+            } else {
+                latencies.push_back(now() - sent);
+            }
+            
+            if (latencies.size() == commands) {
+                commandsAcknowledged.set_value();
+            }
+        });
+    };
+    
+    auto acknowledgedFuture = acknowledged.get_future();
+    auto commandsFuture = commandsAcknowledged.get_future();
+    auto receivedFuture = received.get_future();
+    
+    auto cpuStart = std::chrono::steady_clock::now();
+    
+    if (clock) {
+        
+        // Schedule everything, then let the clock run the scenario
+        
+        for (size_t index = 0; index < count; index++) {
+            clock->schedule(start + index * interval_us, [&, index](const boost::system::error_code&) { sendPayload(index); });
+        }
+        
+        for (uint32_t index = 0; index < commands; index++) {
+            clock->schedule(start + (index + 1) * commandInterval_ms * 1000, [&, index](const boost::system::error_code&) { sendCommand(index); });
+        }
+        
+        clock->run();
+        
+    } else {
+        
+        context.start();
+        
+        // Send payloads, then commands while payloads are transfered
+        
+        for (size_t index = 0; index < count; index++) {
+            
+            if (index != 0 && interval_us != 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(interval_us));
+            }
+            
+            sendPayload(index);
+        }
+        
+        for (uint32_t index = 0; index < commands; index++) {
+            
+            std::this_thread::sleep_for(std::chrono::milliseconds(commandInterval_ms));
+            
+            sendCommand(index);
+        }
+    }
+    
+    int result = EXIT_SUCCESS;
+    
+    try {
+        
+        // Note : On a virtual clock, everything is over once the clock stopped
+        
+        if (clock && (acknowledgedFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready ||
+                      (commands != 0 && commandsFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready))) {
+            throw std::runtime_error("Scenario ended before all acknowledgments");
+        }
+        
+        acknowledgedFuture.get();
+        
+        if (commands != 0) {
+            commandsFuture.get();
+        }
+        
+        auto cpuTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - cpuStart).count();
+        
+        // Skipped messages are never delivered, give the reorder buffer a chance to drain
+        auto drainTime = (clock ? std::chrono::microseconds(0) : std::chrono::microseconds(holeTimeout_us) + std::chrono::seconds(1));
+        if (receivedFuture.wait_for(drainTime) == std::future_status::timeout && reorderBufferSize == 0) {
+            throw std::runtime_error("Some payloads were never delivered");
+        }
+        
+        auto elapsed = end - start;
+        
+        std::cout << "Profile  : " << profile << " up / " << downlinkProfile << " down" << (tracePath.empty() ? "" : " (Trace " + tracePath + ")") << "\n"
+        << "Payload  : " << count << " x " << payloadSize << " Bytes\n"
+        << "MTU      : " << mtu << " Bytes\n"
+        << "Batching : " << batchDelay_us << " us / " << batchSize << " Bytes\n"
+        << "Packets  : " << uplinkPackets << " up / " << downlinkPackets << " down\n"
+        << "Elapsed  : " << elapsed / 1000.0 << " ms\n"
+        << "Goodput  : " << (count * payloadSize * 8.0) / elapsed << " Mbit/s\n"
+        << "Delivery : " << receivedCount << " / " << count << " payloads\n"
+        << "Reorders : " << outOfOrder << " seen by the application\n"
+        << "Clock    : " << (clock ? "virtual" : "real") << ", seed " << seed << ", " << cpuTime / 1000.0 << " ms of wall time" << std::endl;
+        
+        {
+            std::sort(payloadLatencies.begin(), payloadLatencies.end());
+            
+            std::cout << "Latency  : " << payloadLatencies[count / 2] / 1000.0 << " ms median, "
+            << payloadLatencies[(count * 99) / 100] / 1000.0 << " ms p99, "
+            << payloadLatencies[count - 1] / 1000.0 << " ms max" << std::endl;
+        }
+        
+        {
+            auto linkStats = link->getStats();
+            auto senderStats = sender->getStats();
+            auto receiverStats = receiver->getStats();
+            
+            std::cout << "Drops    : " << linkStats._outgoing._dropped << " up / " << linkStats._incomming._dropped << " down, "
+            << linkStats._outgoing._queueDropped << " up / " << linkStats._incomming._queueDropped << " down on full queues\n"
+            << "Sender   : " << senderStats._messagesSent << " sent, "
+            << senderStats._retransmissions << " retransmitted, "
+            << senderStats._timeouts << " timeouts, "
+            << senderStats._unmatchedAcks << " unmatched acks\n"
+            << "RTT      : " << senderStats._rtt.quantile(0.5) / 1000.0 << " ms median, "
+            << senderStats._rtt.quantile(0.99) / 1000.0 << " ms p99 (" << senderStats._rtt._count << " samples)\n"
+            << "Receiver : " << receiverStats._delivered << " delivered, "
+            << receiverStats._duplicates << " duplicates" << std::endl;
+        }
+        
+        if (fecGroupSize != 0) {
+            
+            auto senderStats = sender->getFecStats();
+            auto receiverStats = receiver->getFecStats();
+            
+            std::cout << "FEC      : " << senderStats._parities << " parities for " << senderStats._protected << " messages, "
+            << receiverStats._recovered << " recovered (" << receiverStats._bytesRecovered << " bytes)" << std::endl;
+        }
+        
+        if (reorderBufferSize != 0) {
+            
+            auto stats = receiver->getOrderingStats();
+            
+            std::cout << "Ordering : " << stats._reordered << " buffered, "
+            << stats._skipped << " skipped, "
+            << stats._late << " late, "
+            << stats._holeTimeouts << " hole timeouts, "
+            << "max depth " << stats._maxDepth << "\n"
+            << "Blocking : " << (stats._reordered ? stats._blockedTime / stats._reordered : 0) << " us average, "
+            << stats._maxBlockedTime << " us max" << std::endl;
+        }
+        
+        if (commands != 0) {
+            
+            std::sort(latencies.begin(), latencies.end());
+            
+            auto lost = std::count(latencies.begin(), latencies.end(), UINT64_MAX);
+            auto acknowledgedCommands = latencies.size() - lost;
+            
+            std::cout << "Lanes    : " << (lanes ? scheduling : "disabled") << ", window " << window << " / " << bulkWindow << "\n"
+            << "Commands : " << acknowledgedCommands << " / " << commands << " acknowledged";
+            
+            if (acknowledgedCommands != 0) {
+                std::cout << ", latency " << latencies[acknowledgedCommands / 2] / 1000.0 << " ms median, "
+                << latencies[acknowledgedCommands - 1] / 1000.0 << " ms max";
+            }
+            
+            std::cout << std::endl;
+        }
+        
+        if (!latencyTracePath.empty()) {
+            
+            auto events = coreKit::Metrics::Trace::collect();
+            coreKit::Metrics::Trace::save(events, latencyTracePath);
+            
+            std::cout << "Tracing  : " << events.size() << " events saved to " << latencyTracePath << std::endl;
+        }
+        
+    } catch (const std::exception &exception) {
+        std::cerr << "Transfer failed : " << exception.what() << std::endl;
+        result = EXIT_FAILURE;
+    }
+    
+    // Exit
+    
+    sender->cancel();
+    receiver->cancel();
+    link->cancel();
+    
+    if (clock) {
+        clock->run();
+    }
+    
+    context.stop();
+    
+    return result;
+}
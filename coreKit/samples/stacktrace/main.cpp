@@ -10,8 +10,13 @@
 #include <string>
 #include <thread>
 
+#include <coreKit/Log/Log.hpp>
+#include <coreKit/Log/Logger.hpp>
+#include <coreKit/Log/MappedFileSink.hpp>
 #include <coreKit/Utils/StackTrace.hpp>
 
+static coreKit::Logger logger( { "coreKit", "SampleStackTrace" } );
+
 int you_shall_not_pass() {
     
     char* ptr = (char*) 42;
@@ -55,6 +60,8 @@ void stack_overflow() {
 
 void superFunction() {
     
+    logger->warn("About to append to a null string");
+    
     std::string* stringPtr = nullptr;
     stringPtr->append("Hello world !");
 }
@@ -65,6 +72,24 @@ int main() {
     
     coreKit::handleStackTrace();
     
+    // Records of the previous runs (Survive the crash below, as the StackTrace dump)
+    
+    coreKit::MappedFileSink::Config config { "sample_stacktrace.log", 1 << 20, 4, 64 * 1024, 100000 };
+    
+    size_t count = coreKit::MappedFileSink::recover(config._path, config._fileCount, [](const std::string &record) {
+        std::cout << "  " << record;
+    });
+    
+    std::cout << count << " records recovered from the previous runs" << std::endl;
+    
+    // Add mapped log sink
+    
+    coreKit::Log::subscribe(std::make_shared<coreKit::MappedFileSink>(config), coreKit::Logger::Type::Public);
+    
+    for (int step = 0; step < 10; step++) {
+        logger->info("Step {} done", step);
+    }
+    
     // Time to code
     
     // you_shall_not_pass();
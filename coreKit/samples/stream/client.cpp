@@ -115,7 +115,9 @@ int main(int argc, const char*argv[]) {
     };
     
     coreKit::Stream::Client::Callbacks callbacks = {
-        onDataReceived, onDisconnected
+        onDataReceived, onDisconnected,
+        { coreKit::Stream::Session::Codec::None, 0, false },
+        coreKit::Stream::Session::Framing::Length
     };
     
     // Open client
@@ -158,7 +158,9 @@ int main(int argc, const char*argv[]) {
     };
     
     coreKit::Stream::Server::Callbacks callbacks = {
-        onDataReceived, onClosed, onNewSession, onSessionDisconnected
+        onDataReceived, onClosed, onNewSession, onSessionDisconnected,
+        { coreKit::Stream::Session::Codec::None, 0, false },
+        coreKit::Stream::Session::Framing::Length
     };
     
     // Open server
@@ -74,7 +74,11 @@ namespace coreKit {
                            const Parameter::Parents &parents,
                            const std::string &parameterName) {
         
-        if (node.IsMap()) {
+        // Note : A map is a parameter list, unless a parameter has its name (Map values, as coreKit.Log.Levels)
+        
+        Parameter::Ptr mapParam = (node.IsMap() && parameterName.size() > 0 ? findParam({ parents, parameterName }) : nullptr);
+        
+        if (node.IsMap() && !mapParam) {
             
             Parameter::Parents newParents = parents;
             if (parameterName.size() > 0) {
@@ -89,16 +93,16 @@ namespace coreKit {
             
             const std::string paramName = Parameter::toString(std::make_pair(parents, parameterName));
             
-            configLogger->trace("Method [{}] | Handling parameter [{}]",
-                                __FUNCTION__ ,paramName);
+            COREKIT_LOG_TRACE(configLogger, "Method [{}] | Handling parameter [{}]",
+                                            __FUNCTION__ ,paramName);
             
-            Parameter::Ptr param = getParamBase({ parents, parameterName });
+            Parameter::Ptr param = (mapParam ? mapParam : getParamBase({ parents, parameterName }));
             
-            configLogger->debug("Method [{}] | Overriding parameter [{}] | Old value [{}] | New value [{}]",
-                                __FUNCTION__,
-                                paramName,
-                                param->get_generic(),
-                                node.as<std::string>());
+            COREKIT_LOG_DEBUG(configLogger, "Method [{}] | Overriding parameter [{}] | Old value [{}] | New value [{}]",
+                                            __FUNCTION__,
+                                            paramName,
+                                            param->get_generic(),
+                                            Parameter::emit(node));
             
             param->set(node);
         }
@@ -124,11 +128,11 @@ namespace coreKit {
                     
                     const std::string paramName = Parameter::toString(std::make_pair(parameterList.second.getName(), param.first));
                     
-                    configLogger->debug("Method [{}] | Overriding parameter [{}] | Old value [{}] | New value[{}]",
-                                        __FUNCTION__,
-                                        paramName,
-                                        param.second->get_generic(),
-                                        value);
+                    COREKIT_LOG_DEBUG(configLogger, "Method [{}] | Overriding parameter [{}] | Old value [{}] | New value[{}]",
+                                                    __FUNCTION__,
+                                                    paramName,
+                                                    param.second->get_generic(),
+                                                    value);
                     
                     param.second->set_generic(value);
                 }
@@ -207,6 +211,24 @@ namespace coreKit {
         throw std::invalid_argument("Invalid parameter list with name : [" + Parameter::toString(fullName.first) + "]");
     }
     
+    Parameter::Ptr Config::findParam(const Parameter::FullName &fullName) {
+        
+        std::lock_guard<std::mutex> lock(_mutex);
+        
+        std::map<Parameter::Parents, ParameterList>::const_iterator it = _fullParameterList.find(fullName.first);
+        if (it != _fullParameterList.end()) {
+            
+            const auto parameters = it->second.getParmeters();
+            const auto param = parameters.find(fullName.second);
+            
+            if (param != parameters.end()) {
+                return param->second;
+            }
+        }
+        
+        return nullptr;
+    }
+    
     ParameterType::Ptr Config::getParamType_internal(size_t hashCode) {
         
         for (std::vector<ParameterType::Map>::const_iterator it_1 = _parameterTypes.begin(); it_1 != _parameterTypes.end(); it_1++) {
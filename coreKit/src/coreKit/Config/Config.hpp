@@ -105,6 +105,7 @@ namespace coreKit {
         // Get / Set params
         
         Parameter::Ptr getParamBase(const Parameter::FullName &fullName);
+        Parameter::Ptr findParam(const Parameter::FullName &fullName);      // nullptr when not declared
         template <typename Type> std::shared_ptr<ParameterExt<Type> > getParam_internal(const Parameter::FullName &fullName);
         ParameterType::Ptr getParamType_internal(size_t hashCode);
         std::string get_internal(const Parameter::FullName &fullName);
@@ -35,6 +35,37 @@ namespace coreKit {
         return set(YAML::Load(value));
     }
     
+    std::string Parameter::emit(const YAML::Node &node) {
+        
+        if (node.IsScalar()) {
+            return node.as<std::string>();
+        }
+        
+        YAML::Emitter emitter;
+        emitter << YAML::Flow << node;
+        
+        return emitter.c_str();
+    }
+    
+    void Parameter::subscribe(const Listener &listener) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _listeners.push_back(listener);
+    }
+    
+    void Parameter::notify() {
+        
+        std::vector<Listener> listeners;
+        
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            listeners = _listeners;
+        }
+        
+        for (const auto &listener : listeners) {
+            listener(*this);
+        }
+    }
+    
     std::string Parameter::toString() {
         
         std::string result;
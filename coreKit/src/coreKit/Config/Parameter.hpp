@@ -8,8 +8,10 @@
 
 #pragma once
 
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <utility>
 #include <string>
@@ -35,6 +37,7 @@ namespace coreKit {
         using Ptr       = std::shared_ptr<Parameter>;
         using Parents   = std::vector<std::string>;
         using FullName  = std::pair<Parents, std::string>;
+        using Listener  = std::function<void(const Parameter&)>;
         
         static std::string toString(const Parents &parents);
         static std::string toString(const Parents &parents,
@@ -43,6 +46,10 @@ namespace coreKit {
         
         static FullName decodeParameterName(const std::string &fullname);
         
+        // Value as text (Flow style for sequences and maps)
+        
+        static std::string emit(const YAML::Node &node);
+        
     protected:
         
         // Init
@@ -52,6 +59,10 @@ namespace coreKit {
         
         static ParameterType::Ptr getParamType(size_t hashCode);
         
+        // Call the listeners, once the value changed
+        
+        void notify();
+        
     public:
         
         virtual size_t          getHashCode() const = 0;
@@ -67,6 +78,10 @@ namespace coreKit {
         
         std::string             toString();
         
+        // Change notification (Called by the thread which sets the value, as on a config reload)
+        
+        void                    subscribe(const Listener &listener);
+        
     private:
         
         // Attributes
@@ -76,6 +91,9 @@ namespace coreKit {
         const std::string   _name;
         const std::string   _documentation;
         
+        std::mutex              _mutex;
+        std::vector<Listener>   _listeners;
+        
     };
     
     // ParameterExt
@@ -51,6 +51,7 @@ namespace coreKit {
     template <typename Type>
     void ParameterExt<Type>::set(const Type &value) {
         _value = value;
+        notify();
     }
     
     template <typename Type>
@@ -59,7 +60,7 @@ namespace coreKit {
         YAML::Node node;
         node.push_back(_value);
         
-        return node.begin()->as<std::string>();
+        return emit(*node.begin());
     }
     
     template <typename Type>
@@ -68,7 +69,7 @@ namespace coreKit {
         YAML::Node node;
         node.push_back(_defaultValue);
         
-        return node.begin()->as<std::string>();
+        return emit(*node.begin());
     }
     
     template <typename Type>
@@ -0,0 +1,247 @@
+//
+//  AsyncQueue.cpp
+//  coreKit
+//
+//
+
+#include "AsyncQueue.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+#include "Logger.hpp"
+
+namespace coreKit {
+    
+    // Global variables
+    
+    static Logger logger( { "coreKit", "Log" }, Logger::Type::Internal );
+    
+    // Ring
+    
+    AsyncQueue::Ring::Ring(size_t capacity,
+                           uint64_t generation,
+                           Overflow overflow) :
+    
+    RingFlusher::Ring   (capacity - 1, generation),
+    
+    _records    (capacity),
+    _overflow   (overflow)
+    
+    {
+    }
+    
+    // AsyncQueue
+    
+    AsyncQueue::AsyncQueue() :
+    
+    RingFlusher     ("Asynchronous log"),
+    
+    _config         ( { 0, Overflow::Block, 0 } )
+    
+    { }
+    
+    AsyncQueue::~AsyncQueue() {
+        stop();
+    }
+    
+    void AsyncQueue::start(const Config &config) {
+        
+        if (config._capacity == 0) {
+            throw std::invalid_argument("Asynchronous log capacity must not be 0");
+        }
+        
+        if (config._period == 0) {
+            throw std::invalid_argument("Asynchronous log period must not be 0");
+        }
+        
+        startFlusher(config._period, [this, &config]() {
+            
+            _config = config;
+            
+            size_t capacity = 1;
+            while (capacity < config._capacity) {
+                capacity <<= 1;
+            }
+            
+            _config._capacity = capacity;
+        });
+    }
+    
+    void AsyncQueue::stop() {
+        stopFlusher();
+    }
+    
+    RingFlusher::RingPtr AsyncQueue::createRing(uint64_t generation) {
+        return std::make_shared<Ring>(_config._capacity, generation, _config._overflow);
+    }
+    
+    bool AsyncQueue::push(spdlog::sinks::sink &sink,
+                          const spdlog::details::log_msg &msg) {
+        
+        auto acquired = acquire();
+        
+        if (!acquired) {
+            return false;
+        }
+        
+        Ring &ring = static_cast<Ring&>(*acquired);
+        
+        uint64_t head = ring._head.load(std::memory_order_relaxed);
+        uint64_t tail = ring._tail.load(std::memory_order_acquire);
+        
+        if (head - tail > ring._mask) {
+            
+            if (ring._overflow != Overflow::Block) {
+                drop(ring);
+                release(ring);
+                return true;
+            }
+            
+            tail = block(ring, head - ring._mask);
+        }
+        
+        Record &record = ring._records[head & ring._mask];
+        
+        record._loggerName.assign(msg.logger_name ? *msg.logger_name : std::string());
+        record._level       = msg.level;
+        record._time        = msg.time;
+        record._threadId    = msg.thread_id;
+        record._sink        = &sink;
+        
+        record._raw.assign(msg.raw.data(), msg.raw.size());
+        record._formatted.assign(msg.formatted.data(), msg.formatted.size());
+        
+        ring._head.store(head + 1, std::memory_order_release);
+        
+        // Wake the flusher early when the ring fills up
+        
+        if (head + 1 - tail == (ring._mask + 1) / 2) {
+            wakeUp();
+        }
+        
+        release(ring);
+        
+        return true;
+    }
+    
+    bool AsyncQueue::flush(spdlog::sinks::sink &sink) {
+        return requestFlush([this, &sink]() {
+            _flushSinks.push_back(&sink);
+        });
+    }
+    
+    AsyncQueue::Stats AsyncQueue::getStats() const {
+        
+        Stats result;
+        
+        result._written = _stats._written.load();
+        result._dropped = _stats._dropped.load();
+        result._blocked = _stats._blocked.load();
+        result._batches = _stats._batches.load();
+        
+        result._producers = getProducers();
+        
+        return result;
+    }
+    
+    void AsyncQueue::collect() {
+        _flushing.insert(_flushing.end(), _flushSinks.begin(), _flushSinks.end());
+        _flushSinks.clear();
+    }
+    
+    size_t AsyncQueue::drain(const std::vector<RingPtr> &rings) {
+        
+        // Batch (Pending records of every ring, merged by time)
+        
+        std::vector<const Record*> batch;
+        std::vector<uint64_t> heads(rings.size());
+        
+        for (size_t index = 0; index < rings.size(); index++) {
+            
+            Ring &ring = static_cast<Ring&>(*rings[index]);
+            
+            heads[index] = ring._head.load(std::memory_order_acquire);
+            
+            for (uint64_t position = ring._tail.load(std::memory_order_relaxed); position != heads[index]; position++) {
+                batch.push_back(&ring._records[position & ring._mask]);
+            }
+        }
+        
+        std::stable_sort(batch.begin(), batch.end(), [](const Record *first, const Record *second) {
+            return first->_time < second->_time;
+        });
+        
+        for (auto record : batch) {
+            
+            spdlog::details::log_msg msg(&record->_loggerName, record->_level);
+            
+            msg.time        = record->_time;
+            msg.thread_id   = record->_threadId;
+            
+            msg.raw << record->_raw;
+            msg.formatted << record->_formatted;
+            
+            try {
+                record->_sink->log(msg);
+            } catch (const std::exception &e) {
+                fprintf(stderr, "Asynchronous log write failed : %s\n", e.what());
+            }
+        }
+        
+        // Release the slots
+        
+        for (size_t index = 0; index < rings.size(); index++) {
+            
+            auto &ring = *rings[index];
+            
+            uint64_t tail = ring._tail.load(std::memory_order_relaxed);
+            
+            if (tail != heads[index]) {
+                ring._tail.store(heads[index], std::memory_order_release);
+            }
+            
+            report(ring);
+        }
+        
+        return batch.size();
+    }
+    
+    void AsyncQueue::complete(size_t, bool) {
+        
+        // Flush requests (Records queued before them are written)
+        
+        if (_flushing.empty()) {
+            return;
+        }
+        
+        std::sort(_flushing.begin(), _flushing.end());
+        _flushing.erase(std::unique(_flushing.begin(), _flushing.end()), _flushing.end());
+        
+        for (auto sink : _flushing) {
+            try {
+                sink->flush();
+            } catch (const std::exception &e) {
+                fprintf(stderr, "Asynchronous log flush failed : %s\n", e.what());
+            }
+        }
+        
+        _flushing.clear();
+    }
+    
+    void AsyncQueue::reportDropped(RingFlusher::Ring &ring, uint64_t dropped) {
+        
+        // Note : Through a logger, formatted as any other record (Queued by the flusher, written on its next pass).
+        // Once stopping Log may be going away with its queue, the count goes to stderr.
+        
+        if (static_cast<Ring&>(ring)._overflow == Overflow::Count) {
+            if (_running.load(std::memory_order_acquire)) {
+                COREKIT_LOG_WARN(logger, "{} log records dropped (Asynchronous queue full)", dropped);
+            } else {
+                fprintf(stderr, "%llu log records dropped (Asynchronous queue full)\n", static_cast<unsigned long long>(dropped));
+            }
+        }
+    }
+    
+}
@@ -0,0 +1,152 @@
+//
+//  AsyncQueue.hpp
+//  coreKit
+//
+//
+
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <spdlog/sinks/sink.h>
+
+#include "RingFlusher.hpp"
+
+namespace coreKit {
+    
+    // AsyncQueue (Log records written by a flusher thread)
+    
+    // Note : Each producer thread owns a single-producer / single-consumer ring,
+    // a log call only copies the formatted record into it (No lock, no allocation once warm).
+    // The flusher drains every ring in batches, merged by record time, then writes them to their sink.
+    
+    class AsyncQueue :
+    public RingFlusher {
+    
+    public:
+        
+        // Public declarations
+        
+        using Ptr = std::shared_ptr<AsyncQueue>;
+        
+        // Overflow (Full ring policy)
+        
+        enum class Overflow : uint8_t {
+            
+            Block   = 0,    // Wait for the flusher
+            Drop    = 1,    // Discard the record (Counted in the stats)
+            Count   = 2     // Discard the record, the flusher logs how many were lost
+            
+        };
+        
+        // Config
+        
+        struct Config {
+            
+            // Attributes
+            
+            size_t      _capacity;      // Records per producer thread (Rounded up to a power of 2)
+            Overflow    _overflow;
+            uint64_t    _period;        // Maximum time records wait for the flusher in microseconds
+            
+        };
+        
+        // Stats
+        
+        struct Stats {
+            
+            uint64_t    _written;       // Records written to their sink
+            uint64_t    _dropped;       // Records lost to a full ring
+            uint64_t    _blocked;       // Log calls which waited for the flusher
+            uint64_t    _batches;       // Flusher passes which wrote records
+            size_t      _producers;     // Threads owning a ring
+            
+        };
+        
+        // Init
+        
+        AsyncQueue();
+        ~AsyncQueue();
+        
+        // Non-copyable by design
+        
+        AsyncQueue(const AsyncQueue&) = delete;
+        AsyncQueue& operator=(const AsyncQueue&) = delete;
+        
+        // Start / Stop the flusher (Stop writes every pending record first)
+        
+        void start(const Config &config);
+        void stop();
+        
+        // Queue a record for the sink (Thread safe)
+        
+        // Note : Returns false when the flusher is stopped, the caller writes the record itself
+        
+        bool push(spdlog::sinks::sink &sink,
+                  const spdlog::details::log_msg &msg);
+        
+        // Wait for the records queued by this thread, then flush the sink
+        
+        // Note : Returns false when the flusher is stopped
+        
+        bool flush(spdlog::sinks::sink &sink);
+        
+        // Accessors
+        
+        Stats getStats() const;
+    
+    private:
+        
+        // Private declarations
+        
+        struct Record {
+            
+            std::string                             _loggerName;
+            spdlog::level::level_enum               _level;
+            spdlog::log_clock::time_point           _time;
+            size_t                                  _threadId;
+            
+            spdlog::sinks::sink                     *_sink;
+            
+            std::string                             _raw;
+            std::string                             _formatted;
+            
+        };
+        
+        struct Ring :
+        public RingFlusher::Ring {
+            
+            Ring(size_t capacity,
+                 uint64_t generation,
+                 Overflow overflow);
+            
+            std::vector<Record>     _records;
+            const Overflow          _overflow;  // Copied from the config of its run, producers don't read the config
+            
+        };
+        
+        // Note : Call by worker
+        
+        RingPtr createRing(uint64_t generation) override;
+        void collect() override;
+        size_t drain(const std::vector<RingPtr> &rings) override;
+        void complete(size_t written, bool requested) override;
+        void reportDropped(RingFlusher::Ring &ring, uint64_t dropped) override;
+        
+        // Attributes
+        
+        Config _config;
+        
+        std::vector<spdlog::sinks::sink*> _flushSinks;
+        
+        // Note : Call by worker
+        
+        std::vector<spdlog::sinks::sink*> _flushing;
+        
+    };
+    
+}
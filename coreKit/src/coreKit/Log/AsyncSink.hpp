@@ -0,0 +1,60 @@
+//
+//  AsyncSink.hpp
+//  coreKit
+//
+//
+
+#pragma once
+
+#include <memory>
+#include <stdexcept>
+
+#include <spdlog/sinks/sink.h>
+
+#include "AsyncQueue.hpp"
+
+namespace coreKit {
+    
+    // AsyncSink (Sink in front of another one, through the queue while it runs)
+    
+    class AsyncSink :
+    public spdlog::sinks::sink {
+    
+    public:
+        
+        // Declarations
+        
+        using Ptr = std::shared_ptr<AsyncSink>;
+        
+        // Init
+        
+        AsyncSink(const spdlog::sink_ptr &sink,
+                  const AsyncQueue::Ptr &queue) : _sink(sink), _queue(queue) {
+            if (!sink || !queue) {
+                throw std::invalid_argument("Sink and queue must be defined");
+            }
+        }
+        
+        // Sink
+        
+        void log(const spdlog::details::log_msg &msg) override {
+            if (!_queue->push(*_sink, msg)) {
+                _sink->log(msg);
+            }
+        }
+        
+        void flush() override {
+            if (!_queue->flush(*_sink)) {
+                _sink->flush();
+            }
+        }
+    
+    private:
+        
+        // Attributes
+        
+        const spdlog::sink_ptr _sink;
+        const AsyncQueue::Ptr _queue;
+    };
+    
+}
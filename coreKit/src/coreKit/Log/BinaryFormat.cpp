@@ -0,0 +1,378 @@
+//
+//  BinaryFormat.cpp
+//  coreKit
+//
+//
+
+#include "BinaryFormat.hpp"
+
+#include <cinttypes>
+#include <cstdio>
+#include <stdexcept>
+
+namespace coreKit {
+    
+    namespace BinaryFormat {
+        
+        // Internal methods
+        
+        template<typename T>
+        static bool readValue(const uint8_t *&data, const uint8_t *end, T &value) {
+            
+            if (static_cast<size_t>(end - data) < sizeof(T)) {
+                return false;
+            }
+            
+            uint8_t bytes[sizeof(T)];
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+            for (size_t index = 0; index < sizeof(T); index++) {
+                bytes[index] = data[sizeof(T) - 1 - index];
+            }
+#else
+            memcpy(bytes, data, sizeof(T));
+#endif
+            
+            memcpy(&value, bytes, sizeof(T));
+            data += sizeof(T);
+            
+            return true;
+        }
+        
+        template<typename T, typename Stored>
+        static bool readNumber(const uint8_t *&data, const uint8_t *end, std::string &text) {
+            
+            Stored value;
+            
+            if (!readValue(data, end, value)) {
+                return false;
+            }
+            
+            // Note : Widened first, fmt writes 8 bits integers as numbers too
+            
+            fmt::MemoryWriter writer;
+            writer << static_cast<T>(value);
+            text = writer.str();
+            
+            return true;
+        }
+        
+        // Decoding
+        
+        bool readVarint(const uint8_t *&data, const uint8_t *end, uint64_t &value) {
+            
+            value = 0;
+            
+            for (unsigned shift = 0; data != end && shift < 64; shift += 7) {
+                
+                uint8_t byte = *data++;
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                
+                if (!(byte & 0x80)) {
+                    return true;
+                }
+            }
+            
+            if (data != end) {
+                throw std::runtime_error("Binary log varint is too long");
+            }
+            
+            return false;
+        }
+        
+        bool readString(const uint8_t *&data, const uint8_t *end, std::string &value) {
+            
+            uint64_t length;
+            
+            if (!readVarint(data, end, length) || static_cast<uint64_t>(end - data) < length) {
+                return false;
+            }
+            
+            value.assign(reinterpret_cast<const char*>(data), length);
+            data += length;
+            
+            return true;
+        }
+        
+        bool readArguments(const uint8_t *&data, const uint8_t *end, std::vector<std::string> &arguments) {
+            
+            if (data == end) {
+                return false;
+            }
+            
+            size_t count = *data++;
+            
+            arguments.resize(count);
+            
+            for (auto &argument : arguments) {
+                
+                if (data == end) {
+                    return false;
+                }
+                
+                bool complete = false;
+                
+                switch (static_cast<ArgumentType>(*data++)) {
+                    
+                    case ArgumentType::Bool: {
+                        
+                        uint8_t value;
+                        if ((complete = readValue(data, end, value))) {
+                            argument = value ? "true" : "false";
+                        }
+                        break;
+                    }
+                    
+                    case ArgumentType::Char: {
+                        
+                        char value;
+                        if ((complete = readValue(data, end, value))) {
+                            argument.assign(1, value);
+                        }
+                        break;
+                    }
+                    
+                    case ArgumentType::Int8:    complete = readNumber<long long, int8_t>(data, end, argument);                  break;
+                    case ArgumentType::Int16:   complete = readNumber<long long, int16_t>(data, end, argument);                 break;
+                    case ArgumentType::Int32:   complete = readNumber<long long, int32_t>(data, end, argument);                 break;
+                    case ArgumentType::Int64:   complete = readNumber<long long, int64_t>(data, end, argument);                 break;
+                    case ArgumentType::UInt8:   complete = readNumber<unsigned long long, uint8_t>(data, end, argument);        break;
+                    case ArgumentType::UInt16:  complete = readNumber<unsigned long long, uint16_t>(data, end, argument);       break;
+                    case ArgumentType::UInt32:  complete = readNumber<unsigned long long, uint32_t>(data, end, argument);       break;
+                    case ArgumentType::UInt64:  complete = readNumber<unsigned long long, uint64_t>(data, end, argument);       break;
+                    case ArgumentType::Float:   complete = readNumber<double, float>(data, end, argument);                      break;
+                    case ArgumentType::Double:  complete = readNumber<double, double>(data, end, argument);                     break;
+                    case ArgumentType::String:  complete = readString(data, end, argument);                                     break;
+                    
+                    case ArgumentType::Pointer: {
+                        
+                        uint64_t value;
+                        if ((complete = readValue(data, end, value))) {
+                            char buffer[24];
+                            snprintf(buffer, sizeof(buffer), "0x%" PRIx64, value);
+                            argument = buffer;
+                        }
+                        break;
+                    }
+                    
+                    default:
+                        throw std::runtime_error("Binary log argument type " + std::to_string(data[-1]) + " is unknown");
+                }
+                
+                if (!complete) {
+                    return false;
+                }
+            }
+            
+            return true;
+        }
+        
+        std::string format(const char *format, const std::vector<std::string> &arguments) {
+            
+            std::string result;
+            size_t index = 0;
+            
+            for (const char *it = format; *it; it++) {
+                
+                if ((it[0] == '{' && it[1] == '{') || (it[0] == '}' && it[1] == '}')) {
+                    result += *it++;
+                    continue;
+                }
+                
+                if (it[0] == '{') {
+                    
+                    const char *close = strchr(it, '}');
+                    
+                    if (close && index < arguments.size()) {
+                        result += arguments[index++];
+                        it = close;
+                        continue;
+                    }
+                }
+                
+                result += *it;
+            }
+            
+            return result;
+        }
+        
+        // Decoder
+        
+        Decoder::Decoder(std::istream &stream) :
+        
+        _stream     (stream),
+        _position   (0),
+        _startTime  (0),
+        _time       (0),
+        _dropped    (0),
+        _truncated  (false)
+        
+        {
+            uint8_t header[HeaderSize];
+            
+            if (!_stream.read(reinterpret_cast<char*>(header), HeaderSize)) {
+                throw std::runtime_error("Binary log header is truncated");
+            }
+            
+            const uint8_t *data = header;
+            const uint8_t *end = header + HeaderSize;
+            
+            uint32_t magic;
+            uint16_t version;
+            uint16_t reserved;
+            
+            readValue(data, end, magic);
+            readValue(data, end, version);
+            readValue(data, end, reserved);
+            readValue(data, end, _startTime);
+            
+            if (magic != Magic) {
+                throw std::runtime_error("Binary log magic is invalid");
+            }
+            
+            if (version != Version) {
+                throw std::runtime_error("Binary log version " + std::to_string(version) + " is not supported");
+            }
+            
+            _time = _startTime;
+        }
+        
+        bool Decoder::next(Entry &entry) {
+            
+            for (;;) {
+                
+                const uint8_t *begin = _buffer.data() + _position;
+                const uint8_t *data = begin;
+                const uint8_t *end = _buffer.data() + _buffer.size();
+                
+                bool found = false;
+                
+                if (parse(data, end, entry, found)) {
+                    
+                    _position += data - begin;
+                    
+                    if (found) {
+                        return true;
+                    }
+                    
+                    continue;
+                }
+                
+                // Incomplete record, read more
+                
+                if (!fill()) {
+                    _truncated = (_position != _buffer.size());
+                    return false;
+                }
+            }
+        }
+        
+        uint64_t Decoder::getStartTime() const {
+            return _startTime;
+        }
+        
+        uint64_t Decoder::getDropped() const {
+            return _dropped;
+        }
+        
+        bool Decoder::isTruncated() const {
+            return _truncated;
+        }
+        
+        bool Decoder::fill() {
+            
+            static const size_t chunkSize = 64 * 1024;
+            
+            _buffer.erase(_buffer.begin(), _buffer.begin() + _position);
+            _position = 0;
+            
+            size_t size = _buffer.size();
+            _buffer.resize(size + chunkSize);
+            
+            _stream.read(reinterpret_cast<char*>(_buffer.data() + size), chunkSize);
+            _buffer.resize(size + _stream.gcount());
+            
+            return (_buffer.size() != size);
+        }
+        
+        bool Decoder::parse(const uint8_t *&data, const uint8_t *end, Entry &entry, bool &found) {
+            
+            if (data == end) {
+                return false;
+            }
+            
+            switch (static_cast<RecordType>(*data++)) {
+                
+                case RecordType::Site: {
+                    
+                    uint64_t id;
+                    uint8_t level;
+                    Site site;
+                    
+                    if (!readVarint(data, end, id) || !readValue(data, end, level) ||
+                        !readString(data, end, site._logger) || !readString(data, end, site._format)) {
+                        return false;
+                    }
+                    
+                    if (level > spdlog::level::off) {
+                        throw std::runtime_error("Binary log level " + std::to_string(level) + " is unknown");
+                    }
+                    
+                    site._level = static_cast<spdlog::level::level_enum>(level);
+                    _sites[id] = std::move(site);
+                    
+                    return true;
+                }
+                
+                case RecordType::Entry: {
+                    
+                    uint64_t id;
+                    uint64_t delta;
+                    uint64_t threadId;
+                    
+                    if (!readVarint(data, end, id) || !readVarint(data, end, delta) ||
+                        !readVarint(data, end, threadId) || !readArguments(data, end, _arguments)) {
+                        return false;
+                    }
+                    
+                    auto site = _sites.find(id);
+                    
+                    if (site == _sites.end()) {
+                        throw std::runtime_error("Binary log site " + std::to_string(id) + " is not defined");
+                    }
+                    
+                    _time += unzigzag(delta);
+                    
+                    entry._time     = _time;
+                    entry._level    = site->second._level;
+                    entry._logger   = site->second._logger;
+                    entry._threadId = threadId;
+                    entry._text     = format(site->second._format.c_str(), _arguments);
+                    
+                    found = true;
+                    
+                    return true;
+                }
+                
+                case RecordType::Dropped: {
+                    
+                    uint64_t threadId;
+                    uint64_t count;
+                    
+                    if (!readVarint(data, end, threadId) || !readVarint(data, end, count)) {
+                        return false;
+                    }
+                    
+                    _dropped += count;
+                    
+                    return true;
+                }
+                
+                default:
+                    throw std::runtime_error("Binary log record type " + std::to_string(data[-1]) + " is unknown");
+            }
+        }
+        
+    }
+    
+}
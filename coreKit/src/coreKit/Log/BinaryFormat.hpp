@@ -0,0 +1,380 @@
+//
+//  BinaryFormat.hpp
+//  coreKit
+//
+//
+
+#pragma once
+
+#include <stdint.h>
+
+#include <cstddef>
+#include <cstring>
+#include <istream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <spdlog/common.h>
+
+namespace coreKit {
+    
+    // BinaryFormat (Binary log records, in memory and on disk)
+    
+    // File     : Header, then records
+    // Header   : Magic "CKBL" (uint32), version (uint16), reserved (uint16), start time (uint64, ns since epoch)
+    // Record   : Type (uint8), then
+    //   Site     : Site id (varint), level (uint8), logger name (string), format (string)
+    //   Entry    : Site id (varint), time from the previous entry (zigzag varint, ns), thread id (varint), arguments
+    //   Dropped  : Thread id (varint), count (varint)
+    // Arguments : Count (uint8), then for each its type (uint8) and little endian value
+    // String   : Length (varint), then bytes
+    
+    // Note : Integers are little endian, varints are LEB128
+    
+    namespace BinaryFormat {
+        
+        // Declarations
+        
+        static const uint32_t Magic     = 0x4C424B43;   // "CKBL"
+        static const uint16_t Version   = 1;
+        
+        static const size_t HeaderSize  = 16;
+        
+        enum class RecordType : uint8_t {
+            
+            Site    = 1,
+            Entry   = 2,
+            Dropped = 3
+            
+        };
+        
+        enum class ArgumentType : uint8_t {
+            
+            Bool    = 0,
+            Char    = 1,
+            Int8    = 2,
+            Int16   = 3,
+            Int32   = 4,
+            Int64   = 5,
+            UInt8   = 6,
+            UInt16  = 7,
+            UInt32  = 8,
+            UInt64  = 9,
+            Float   = 10,
+            Double  = 11,
+            String  = 12,
+            Pointer = 13
+            
+        };
+        
+        // Varints
+        
+        inline size_t varintSize(uint64_t value) {
+            
+            size_t result = 1;
+            
+            while (value >= 0x80) {
+                value >>= 7;
+                result++;
+            }
+            
+            return result;
+        }
+        
+        inline uint8_t* writeVarint(uint8_t *data, uint64_t value) {
+            
+            while (value >= 0x80) {
+                *data++ = static_cast<uint8_t>(value | 0x80);
+                value >>= 7;
+            }
+            
+            *data++ = static_cast<uint8_t>(value);
+            
+            return data;
+        }
+        
+        inline uint64_t zigzag(int64_t value) {
+            return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+        }
+        
+        inline int64_t unzigzag(uint64_t value) {
+            return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+        }
+        
+        // Little endian values
+        
+        template<typename T>
+        inline uint8_t* writeValue(uint8_t *data, T value) {
+            
+            uint8_t bytes[sizeof(T)];
+            memcpy(bytes, &value, sizeof(T));
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+            for (size_t index = 0; index < sizeof(T); index++) {
+                data[index] = bytes[sizeof(T) - 1 - index];
+            }
+#else
+            memcpy(data, bytes, sizeof(T));
+#endif
+            
+            return data + sizeof(T);
+        }
+        
+        // Argument (Encoder of a log call argument)
+        
+        // Note : Arithmetic values, enums, strings and pointers are copied as is,
+        // any other type is converted to text by operator<< on the calling thread
+        
+        template<typename T, typename Enable = void>
+        struct Argument {
+            
+            Argument(const T &value) {
+                std::ostringstream stream;
+                stream << value;
+                _text = stream.str();
+            }
+            
+            size_t size() const {
+                return 1 + varintSize(_text.size()) + _text.size();
+            }
+            
+            uint8_t* write(uint8_t *data) const {
+                *data++ = static_cast<uint8_t>(ArgumentType::String);
+                data = writeVarint(data, _text.size());
+                memcpy(data, _text.data(), _text.size());
+                return data + _text.size();
+            }
+            
+            std::string _text;
+            
+        };
+        
+        template<typename T>
+        struct ArithmeticType;
+        
+        template<> struct ArithmeticType<bool>      { static const ArgumentType Type = ArgumentType::Bool;   using Stored = uint8_t; };
+        template<> struct ArithmeticType<char>      { static const ArgumentType Type = ArgumentType::Char;   using Stored = char; };
+        template<> struct ArithmeticType<float>     { static const ArgumentType Type = ArgumentType::Float;  using Stored = float; };
+        template<> struct ArithmeticType<double>    { static const ArgumentType Type = ArgumentType::Double; using Stored = double; };
+        template<> struct ArithmeticType<long double> { static const ArgumentType Type = ArgumentType::Double; using Stored = double; };
+        
+        template<size_t Size, bool Signed> struct IntegerType;
+        
+        template<> struct IntegerType<1, true>  { static const ArgumentType Type = ArgumentType::Int8;   using Stored = int8_t; };
+        template<> struct IntegerType<2, true>  { static const ArgumentType Type = ArgumentType::Int16;  using Stored = int16_t; };
+        template<> struct IntegerType<4, true>  { static const ArgumentType Type = ArgumentType::Int32;  using Stored = int32_t; };
+        template<> struct IntegerType<8, true>  { static const ArgumentType Type = ArgumentType::Int64;  using Stored = int64_t; };
+        template<> struct IntegerType<1, false> { static const ArgumentType Type = ArgumentType::UInt8;  using Stored = uint8_t; };
+        template<> struct IntegerType<2, false> { static const ArgumentType Type = ArgumentType::UInt16; using Stored = uint16_t; };
+        template<> struct IntegerType<4, false> { static const ArgumentType Type = ArgumentType::UInt32; using Stored = uint32_t; };
+        template<> struct IntegerType<8, false> { static const ArgumentType Type = ArgumentType::UInt64; using Stored = uint64_t; };
+        
+        template<typename T>
+        struct ValueType : std::conditional<std::is_integral<T>::value && !std::is_same<T, bool>::value && !std::is_same<T, char>::value,
+                                            IntegerType<sizeof(T), std::is_signed<T>::value>,
+                                            ArithmeticType<T> >::type { };
+        
+        template<typename T>
+        struct Argument<T, typename std::enable_if<std::is_arithmetic<T>::value || std::is_enum<T>::value>::type> {
+            
+            using Value = typename std::conditional<std::is_enum<T>::value, std::underlying_type<T>, std::common_type<T> >::type::type;
+            using Type = ValueType<Value>;
+            
+            Argument(const T &value) : _value(static_cast<typename Type::Stored>(static_cast<Value>(value))) { }
+            
+            size_t size() const {
+                return 1 + sizeof(_value);
+            }
+            
+            uint8_t* write(uint8_t *data) const {
+                *data++ = static_cast<uint8_t>(Type::Type);
+                return writeValue(data, _value);
+            }
+            
+            typename Type::Stored _value;
+            
+        };
+        
+        // Strings (Copied, the caller may free them once the call returns)
+        
+        struct StringArgument {
+            
+            StringArgument(const char *data, size_t length) : _data(data), _length(length) { }
+            
+            size_t size() const {
+                return 1 + varintSize(_length) + _length;
+            }
+            
+            uint8_t* write(uint8_t *data) const {
+                *data++ = static_cast<uint8_t>(ArgumentType::String);
+                data = writeVarint(data, _length);
+                memcpy(data, _data, _length);
+                return data + _length;
+            }
+            
+            const char *_data;
+            size_t _length;
+            
+        };
+        
+        template<>
+        struct Argument<std::string> : StringArgument {
+            
+            Argument(const std::string &value) : StringArgument(value.data(), value.size()) { }
+            
+        };
+        
+        template<typename T>
+        struct Argument<T*, typename std::enable_if<std::is_same<typename std::remove_cv<T>::type, char>::value>::type> : StringArgument {
+            
+            Argument(T *value) : StringArgument(value ? value : "(null)", value ? strlen(value) : 6) { }
+            
+        };
+        
+        template<typename T>
+        struct Argument<T*, typename std::enable_if<!std::is_same<typename std::remove_cv<T>::type, char>::value>::type> {
+            
+            Argument(T *value) : _value(reinterpret_cast<uintptr_t>(value)) { }
+            
+            size_t size() const {
+                return 1 + sizeof(_value);
+            }
+            
+            uint8_t* write(uint8_t *data) const {
+                *data++ = static_cast<uint8_t>(ArgumentType::Pointer);
+                return writeValue(data, _value);
+            }
+            
+            uint64_t _value;
+            
+        };
+        
+        // Arguments (Encoder of the arguments of a log call, count first)
+        
+        template<size_t Index, typename Tuple>
+        struct Arguments {
+            
+            static size_t size(const Tuple &arguments) {
+                return Arguments<Index - 1, Tuple>::size(arguments) + std::get<Index - 1>(arguments).size();
+            }
+            
+            static uint8_t* write(uint8_t *data, const Tuple &arguments) {
+                data = Arguments<Index - 1, Tuple>::write(data, arguments);
+                return std::get<Index - 1>(arguments).write(data);
+            }
+            
+        };
+        
+        template<typename Tuple>
+        struct Arguments<0, Tuple> {
+            
+            static size_t size(const Tuple&) {
+                return 1;
+            }
+            
+            static uint8_t* write(uint8_t *data, const Tuple&) {
+                *data++ = static_cast<uint8_t>(std::tuple_size<Tuple>::value);
+                return data;
+            }
+            
+        };
+        
+        // Decoding
+        
+        // Note : Return false on truncated data, throw std::runtime_error on unknown data
+        
+        bool readVarint(const uint8_t *&data, const uint8_t *end, uint64_t &value);
+        bool readString(const uint8_t *&data, const uint8_t *end, std::string &value);
+        
+        // Arguments to text (As written by fmt for the same value)
+        
+        bool readArguments(const uint8_t *&data, const uint8_t *end, std::vector<std::string> &arguments);
+        
+        // Replace the {} fields by the arguments ({{ and }} are escapes)
+        
+        // Note : Format specifications (As in {:x}) are ignored, missing arguments leave the field as is
+        
+        std::string format(const char *format, const std::vector<std::string> &arguments);
+        
+        // Entry (Decoded log record)
+        
+        struct Entry {
+            
+            uint64_t                    _time;          // Nanoseconds since epoch
+            spdlog::level::level_enum   _level;
+            std::string                 _logger;
+            uint64_t                    _threadId;
+            std::string                 _text;
+            
+        };
+        
+        // Decoder (Reads the entries of a binary log file)
+        
+        class Decoder {
+        
+        public:
+            
+            // Init
+            
+            // Note : Throw std::runtime_error when the header is not a binary log one
+            
+            Decoder(std::istream &stream);
+            
+            // Non-copyable by design
+            
+            Decoder(const Decoder&) = delete;
+            Decoder& operator=(const Decoder&) = delete;
+            
+            // Next entry (False at the end of the file)
+            
+            // Note : A record cut by a crash ends the file, corrupted data throws std::runtime_error
+            
+            bool next(Entry &entry);
+            
+            // Accessors
+            
+            uint64_t getStartTime() const;
+            uint64_t getDropped() const;    // Records lost by the writer so far
+            bool isTruncated() const;       // The file ends inside a record
+        
+        private:
+            
+            // Private declarations
+            
+            struct Site {
+                
+                spdlog::level::level_enum   _level;
+                std::string                 _logger;
+                std::string                 _format;
+                
+            };
+            
+            // Private methods
+            
+            bool fill();
+            bool parse(const uint8_t *&data, const uint8_t *end, Entry &entry, bool &found);
+            
+            // Attributes
+            
+            std::istream &_stream;
+            
+            std::vector<uint8_t> _buffer;
+            size_t _position;
+            
+            uint64_t _startTime;
+            uint64_t _time;
+            uint64_t _dropped;
+            bool _truncated;
+            
+            std::unordered_map<uint64_t, Site> _sites;
+            std::vector<std::string> _arguments;
+            
+        };
+        
+    }
+    
+}
@@ -0,0 +1,504 @@
+//
+//  BinaryLog.cpp
+//  coreKit
+//
+//
+
+#include <coreKit/Utils/iziDeclarations.hpp>
+
+#include "BinaryLog.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+
+#include <spdlog/formatter.h>
+
+#include "BinaryFormat.hpp"
+#include "Log.hpp"
+
+namespace coreKit {
+    
+    // Internal methods
+    
+    static uint64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(spdlog::log_clock::now().time_since_epoch()).count();
+    }
+    
+    // Ring
+    
+    BinaryLog::Ring::Ring(size_t capacity,
+                          uint64_t generation,
+                          size_t threadId) :
+    
+    RingFlusher::Ring   (capacity - 1, generation),
+    
+    _data       (capacity / sizeof(uint64_t)),
+    _threadId   (threadId),
+    _source     (nullptr)
+    
+    {
+    }
+    
+    // BinaryLog
+    
+    BinaryLog::BinaryLog() :
+    
+    RingFlusher     ("Binary log"),
+    
+    _config         ( { 0, AsyncQueue::Overflow::Block, 0, std::string(), false } ),
+    _file           (nullptr),
+    _time           (0),
+    _bytes          (0)
+    
+    {
+        
+        // Note : Log is created first, it outlives the flusher
+        
+        _logger = Log::get( { "coreKit", "BinaryLog" }, Logger::Type::Internal);
+        _formatter = std::make_shared<spdlog::pattern_formatter>("%+");
+    }
+    
+    BinaryLog::~BinaryLog() {
+        stop_internal();
+    }
+    
+    uint16_t BinaryLog::declare(const Logger::Name &name,
+                                Logger::Type type) {
+        
+        std::string fullname;
+        for (Logger::Name::const_iterator it = name.begin(); it != name.end(); it++) {
+            fullname += (std::distance(name.begin(), it) != 0 ? "." : "") + *it;
+        }
+        
+        if (!coreKit::validateIziUrl(fullname)) {
+            throw std::runtime_error("Logger name [" + fullname + "] is not izi compliant");
+        }
+        
+        std::lock_guard<std::mutex> lock(_mutex);
+        
+        for (size_t index = 0; index < _sources.size(); index++) {
+            if (_sources[index]->_name == fullname && _sources[index]->_type == type) {
+                return static_cast<uint16_t>(index);
+            }
+        }
+        
+        if (_sources.size() > std::numeric_limits<uint16_t>::max()) {
+            throw std::runtime_error("Too many binary loggers");
+        }
+        
+        _sources.emplace_back(new Source( { fullname, type } ));
+        
+        return static_cast<uint16_t>(_sources.size() - 1);
+    }
+    
+    void BinaryLog::start_internal(const Config &config) {
+        
+        if (config._capacity == 0) {
+            throw std::invalid_argument("Binary log capacity must not be 0");
+        }
+        
+        if (config._period == 0) {
+            throw std::invalid_argument("Binary log period must not be 0");
+        }
+        
+        if (config._path.empty() && !config._text) {
+            throw std::invalid_argument("Binary log needs a path or the text output");
+        }
+        
+        startFlusher(config._period, [this, &config]() {
+            
+            // Binary file (Header first)
+            
+            _time = now();
+            _sites.clear();
+            
+            if (!config._path.empty()) {
+                
+                _file = fopen(config._path.c_str(), "wb");
+                
+                if (!_file) {
+                    throw std::runtime_error("Binary log file [" + config._path + "] can't be opened");
+                }
+                
+                uint8_t header[BinaryFormat::HeaderSize];
+                uint8_t *data = header;
+                
+                data = BinaryFormat::writeValue(data, BinaryFormat::Magic);
+                data = BinaryFormat::writeValue(data, BinaryFormat::Version);
+                data = BinaryFormat::writeValue(data, static_cast<uint16_t>(0));
+                data = BinaryFormat::writeValue(data, _time);
+                
+                writeFile(header, sizeof(header));
+            }
+            
+            _config = config;
+            
+            size_t capacity = 64;
+            while (capacity < config._capacity) {
+                capacity <<= 1;
+            }
+            
+            _config._capacity = capacity;
+        });
+    }
+    
+    void BinaryLog::stop_internal() {
+        stopFlusher();
+    }
+    
+    void BinaryLog::flush_internal() {
+        requestFlush(nullptr);
+    }
+    
+    RingFlusher::RingPtr BinaryLog::createRing(uint64_t generation) {
+        return std::make_shared<Ring>(_config._capacity, generation, spdlog::details::os::thread_id());
+    }
+    
+    bool BinaryLog::reserve(Slot &slot,
+                            uint16_t logger,
+                            spdlog::level::level_enum level,
+                            const char *format,
+                            size_t length) {
+        
+        auto acquired = acquire();
+        
+        if (!acquired) {
+            return false;
+        }
+        
+        Ring &ring = static_cast<Ring&>(*acquired);
+        
+        slot._ring = &ring;
+        slot._data = nullptr;
+        
+        uint64_t capacity = ring._mask + 1;
+        uint64_t size = (sizeof(Header) + length + 7) & ~static_cast<uint64_t>(7);
+        
+        uint64_t head = ring._head.load(std::memory_order_relaxed);
+        uint64_t tail = ring._tail.load(std::memory_order_acquire);
+        
+        // Room for the record, after a padding record when it would wrap
+        
+        uint64_t contiguous = capacity - (head & ring._mask);
+        uint64_t padding = (size > contiguous ? contiguous : 0);
+        
+        if (size > capacity || head + padding + size - tail > capacity) {
+            
+            if (_config._overflow != AsyncQueue::Overflow::Block || size > capacity) {
+                drop(ring);
+                return true;
+            }
+            
+            tail = block(ring, head + padding + size - capacity);
+        }
+        
+        uint8_t *data = reinterpret_cast<uint8_t*>(ring._data.data());
+        
+        if (padding != 0) {
+            
+            // Note : Padding records may be 8 bytes long, only their first fields are written
+            
+            Header *header = reinterpret_cast<Header*>(data + (head & ring._mask));
+            
+            header->_size       = static_cast<uint32_t>(padding);
+            header->_padding    = 1;
+            
+            head += padding;
+        }
+        
+        Header *header = reinterpret_cast<Header*>(data + (head & ring._mask));
+        
+        header->_size       = static_cast<uint32_t>(size);
+        header->_padding    = 0;
+        header->_level      = static_cast<uint8_t>(level);
+        header->_logger     = logger;
+        header->_length     = static_cast<uint32_t>(length);
+        header->_time       = now();
+        header->_format     = format;
+        
+        slot._data = reinterpret_cast<uint8_t*>(header + 1);
+        slot._head = head + size;
+        
+        return true;
+    }
+    
+    void BinaryLog::commit(const Slot &slot) {
+        
+        Ring &ring = *slot._ring;
+        
+        if (slot._data) {
+            
+            uint64_t tail = ring._tail.load(std::memory_order_relaxed);
+            uint64_t head = ring._head.exchange(slot._head, std::memory_order_release);
+            
+            // Wake the flusher early when the ring fills up
+            
+            if (head - tail < (ring._mask + 1) / 2 && slot._head - tail >= (ring._mask + 1) / 2) {
+                wakeUp();
+            }
+        }
+        
+        release(ring);
+    }
+    
+    void BinaryLog::write(uint16_t logger,
+                          spdlog::level::level_enum level,
+                          const char *format,
+                          const uint8_t *arguments,
+                          size_t length) {
+        
+        const Source *source;
+        
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            source = _sources[logger].get();
+        }
+        
+        std::vector<std::string> values;
+        
+        BinaryFormat::readArguments(arguments, arguments + length, values);
+        
+        writeText(*source, level, now(), spdlog::details::os::thread_id(), BinaryFormat::format(format, values));
+    }
+    
+    size_t BinaryLog::drain(const std::vector<RingPtr> &rings) {
+        
+        // Batch (Pending records of every ring, merged by time)
+        
+        std::vector<std::pair<const Header*, Ring*>> batch;
+        std::vector<uint64_t> heads(rings.size());
+        
+        for (size_t index = 0; index < rings.size(); index++) {
+            
+            Ring &ring = static_cast<Ring&>(*rings[index]);
+            const uint8_t *data = reinterpret_cast<const uint8_t*>(ring._data.data());
+            
+            heads[index] = ring._head.load(std::memory_order_acquire);
+            
+            for (uint64_t position = ring._tail.load(std::memory_order_relaxed); position != heads[index]; ) {
+                
+                auto header = reinterpret_cast<const Header*>(data + (position & ring._mask));
+                
+                if (!header->_padding) {
+                    batch.emplace_back(header, &ring);
+                }
+                
+                position += header->_size;
+            }
+        }
+        
+        std::stable_sort(batch.begin(), batch.end(), [](const std::pair<const Header*, Ring*> &first,
+                                                        const std::pair<const Header*, Ring*> &second) {
+            return first.first->_time < second.first->_time;
+        });
+        
+        _buffer.clear();
+        
+        for (const auto &item : batch) {
+            
+            const Header &header = *item.first;
+            const uint8_t *arguments = reinterpret_cast<const uint8_t*>(&header + 1);
+            
+            // Site (Defined on first use)
+            
+            auto key = std::make_tuple(header._format, header._logger, header._level);
+            auto site = _sites.find(key);
+            
+            if (site == _sites.end()) {
+                
+                const Source *source;
+                
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    source = _sources[header._logger].get();
+                }
+                
+                site = _sites.insert(std::make_pair(key, Site( { _sites.size(), source } ))).first;
+                
+                if (_file) {
+                    
+                    size_t formatLength = strlen(header._format);
+                    size_t offset = _buffer.size();
+                    
+                    _buffer.resize(offset + 1 + 10 + 1 + 10 + source->_name.size() + 10 + formatLength);
+                    
+                    uint8_t *data = _buffer.data() + offset;
+                    
+                    *data++ = static_cast<uint8_t>(BinaryFormat::RecordType::Site);
+                    data = BinaryFormat::writeVarint(data, site->second._id);
+                    *data++ = header._level;
+                    data = BinaryFormat::writeVarint(data, source->_name.size());
+                    data = std::copy(source->_name.begin(), source->_name.end(), data);
+                    data = BinaryFormat::writeVarint(data, formatLength);
+                    data = std::copy(header._format, header._format + formatLength, data);
+                    
+                    _buffer.resize(data - _buffer.data());
+                }
+            }
+            
+            item.second->_source = site->second._source;
+            
+            // Entry (Arguments as encoded by the producer)
+            
+            if (_file) {
+                
+                size_t offset = _buffer.size();
+                
+                _buffer.resize(offset + 1 + 10 + 10 + 10 + header._length);
+                
+                uint8_t *data = _buffer.data() + offset;
+                
+                *data++ = static_cast<uint8_t>(BinaryFormat::RecordType::Entry);
+                data = BinaryFormat::writeVarint(data, site->second._id);
+                data = BinaryFormat::writeVarint(data, BinaryFormat::zigzag(static_cast<int64_t>(header._time - _time)));
+                data = BinaryFormat::writeVarint(data, item.second->_threadId);
+                data = std::copy(arguments, arguments + header._length, data);
+                
+                _buffer.resize(data - _buffer.data());
+                
+                _time = header._time;
+            }
+            
+            // Text
+            
+            if (_config._text) {
+                try {
+                    BinaryFormat::readArguments(arguments, arguments + header._length, _arguments);
+                    writeText(*site->second._source, static_cast<spdlog::level::level_enum>(header._level), header._time,
+                              item.second->_threadId, BinaryFormat::format(header._format, _arguments));
+                } catch (const std::exception &e) {
+                    fprintf(stderr, "Binary log write failed : %s\n", e.what());
+                }
+            }
+        }
+        
+        // Release the space
+        
+        for (size_t index = 0; index < rings.size(); index++) {
+            
+            auto &ring = *rings[index];
+            
+            ring._tail.store(heads[index], std::memory_order_release);
+            
+            report(ring);
+        }
+        
+        writeFile(_buffer.data(), _buffer.size());
+        
+        return batch.size();
+    }
+    
+    void BinaryLog::complete(size_t written, bool requested) {
+        
+        // Flush requests (Records queued before them are written)
+        
+        if (_file && (written != 0 || requested)) {
+            fflush(_file);
+        }
+    }
+    
+    void BinaryLog::finish() {
+        if (_file) {
+            fclose(_file);
+            _file = nullptr;
+        }
+    }
+    
+    void BinaryLog::reportDropped(RingFlusher::Ring &base, uint64_t dropped) {
+        
+        Ring &ring = static_cast<Ring&>(base);
+        
+        // Note : The decoder counts the records lost
+        
+        if (_file) {
+            
+            uint8_t record[1 + 10 + 10];
+            uint8_t *data = record;
+            
+            *data++ = static_cast<uint8_t>(BinaryFormat::RecordType::Dropped);
+            data = BinaryFormat::writeVarint(data, ring._threadId);
+            data = BinaryFormat::writeVarint(data, dropped);
+            
+            writeFile(record, data - record);
+        }
+        
+        if (_config._overflow == AsyncQueue::Overflow::Count && _config._text) {
+            try {
+                writeText(ring._source ? *ring._source : Source( { _logger->name(), Logger::Type::Internal } ), spdlog::level::warn, now(),
+                          ring._threadId, std::to_string(dropped) + " log records dropped (Binary log ring full)");
+            } catch (const std::exception &e) {
+                fprintf(stderr, "Binary log write failed : %s\n", e.what());
+            }
+        }
+    }
+    
+    void BinaryLog::writeFile(const void *data,
+                              size_t size) {
+        
+        if (!_file || size == 0) {
+            return;
+        }
+        
+        if (fwrite(data, 1, size, _file) != size) {
+            fprintf(stderr, "Binary log write failed : %s\n", _config._path.c_str());
+        }
+        
+        _bytes += size;
+    }
+    
+    void BinaryLog::writeText(const Source &source,
+                              spdlog::level::level_enum level,
+                              uint64_t time,
+                              size_t threadId,
+                              const std::string &text) {
+        
+        spdlog::details::log_msg msg(&source._name, level);
+        
+        msg.time        = spdlog::log_clock::time_point(std::chrono::duration_cast<spdlog::log_clock::duration>(std::chrono::nanoseconds(time)));
+        msg.thread_id   = threadId;
+        
+        msg.raw << text;
+        
+        _formatter->format(msg);
+        
+        Log::write(msg, source._type);
+    }
+    
+    // Static methods
+    
+    void BinaryLog::start(const Config &config) {
+        getInstance()->start_internal(config);
+    }
+    
+    void BinaryLog::stop() {
+        getInstance()->stop_internal();
+    }
+    
+    bool BinaryLog::isRunning() {
+        return getInstance()->RingFlusher::isRunning();
+    }
+    
+    void BinaryLog::flush() {
+        getInstance()->flush_internal();
+    }
+    
+    BinaryLog::Stats BinaryLog::getStats() {
+        
+        auto instance = getInstance();
+        
+        Stats result;
+        
+        result._written = instance->_stats._written.load();
+        result._dropped = instance->_stats._dropped.load();
+        result._blocked = instance->_stats._blocked.load();
+        result._batches = instance->_stats._batches.load();
+        result._bytes   = instance->_bytes.load();
+        
+        result._producers = instance->getProducers();
+        
+        return result;
+    }
+    
+}
@@ -0,0 +1,221 @@
+//
+//  BinaryLog.hpp
+//  coreKit
+//
+//
+
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "AsyncQueue.hpp"
+#include "Logger.hpp"
+#include "RingFlusher.hpp"
+
+#include <coreKit/Utils/Singleton.hpp>
+
+namespace coreKit {
+    
+    // Opaque declarations
+    
+    class BinaryLogger;
+    
+    // BinaryLog (Binary log records written by a flusher thread)
+    
+    // Note : A log call of a BinaryLogger only copies the format pointer and the raw argument values
+    // into the ring of its thread, formatting is deferred to the flusher or to an offline decoder.
+    // The flusher writes the records to a binary file (See BinaryFormat.hpp) and / or as text to the Log sinks.
+    
+    class BinaryLog :
+    private RingFlusher,
+    private Singleton<BinaryLog> {
+        
+        friend class Singleton<BinaryLog>;
+        friend class BinaryLogger;
+    
+    public:
+        
+        // Note : Destruction stops the flusher, stop it before exit
+        
+        ~BinaryLog();
+        
+        // Config
+        
+        struct Config {
+            
+            // Attributes
+            
+            size_t                  _capacity;      // Ring bytes per producer thread (Rounded up to a power of 2)
+            AsyncQueue::Overflow    _overflow;
+            uint64_t                _period;        // Maximum time records wait for the flusher in microseconds
+            std::string             _path;          // Binary file (Empty for none)
+            bool                    _text;          // Also write the formatted records to the Log sinks
+            
+        };
+        
+        // Stats
+        
+        struct Stats {
+            
+            uint64_t    _written;       // Records written
+            uint64_t    _dropped;       // Records lost to a full ring
+            uint64_t    _blocked;       // Log calls which waited for the flusher
+            uint64_t    _batches;       // Flusher passes which wrote records
+            uint64_t    _bytes;         // Binary bytes written
+            size_t      _producers;     // Threads owning a ring
+            
+        };
+        
+        // Start / Stop the flusher (Stop writes every pending record first)
+        
+        // Note : While stopped, BinaryLogger calls are formatted and written to the Log sinks synchronously
+        
+        static void start(const Config &config);
+        static void stop();
+        
+        static bool isRunning();
+        
+        // Wait for the records queued by this thread to be written
+        
+        static void flush();
+        
+        // Accessors
+        
+        static Stats getStats();
+    
+    private:
+        
+        // Private declarations
+        
+        // Source (Logger declared by a BinaryLogger)
+        
+        struct Source {
+            
+            std::string     _name;
+            Logger::Type    _type;
+            
+        };
+        
+        // Note : Records are 8 bytes aligned, padding records fill the end of the ring before a wrap
+        
+        struct Header {
+            
+            uint32_t        _size;          // Record bytes in the ring
+            uint8_t         _padding;
+            uint8_t         _level;
+            uint16_t        _logger;
+            
+            uint32_t        _length;        // Argument bytes, after the header
+            uint64_t        _time;          // Nanoseconds since epoch
+            const char      *_format;
+            
+        };
+        
+        struct Ring :
+        public RingFlusher::Ring {
+            
+            Ring(size_t capacity,
+                 uint64_t generation,
+                 size_t threadId);
+            
+            std::vector<uint64_t>   _data;
+            const size_t            _threadId;
+            
+            // Note : Call by worker
+            
+            const Source            *_source;   // Last source written
+            
+        };
+        
+        // Slot (Record reserved by a producer)
+        
+        struct Slot {
+            
+            Ring        *_ring;
+            uint8_t     *_data;     // Argument bytes, nullptr when the record is dropped
+            uint64_t    _head;      // Ring head once committed
+            
+        };
+        
+        // Site (Format of a logger and level, defined once in the file)
+        
+        struct Site {
+            
+            uint64_t        _id;
+            const Source    *_source;
+            
+        };
+        
+        BinaryLog();
+        
+        // Note : Call by BinaryLogger
+        
+        uint16_t declare(const Logger::Name &name,
+                         Logger::Type type);
+        
+        bool reserve(Slot &slot,
+                     uint16_t logger,
+                     spdlog::level::level_enum level,
+                     const char *format,
+                     size_t length);
+        void commit(const Slot &slot);
+        
+        void write(uint16_t logger,
+                   spdlog::level::level_enum level,
+                   const char *format,
+                   const uint8_t *arguments,
+                   size_t length);
+        
+        // Private methods
+        
+        void start_internal(const Config &config);
+        void stop_internal();
+        void flush_internal();
+        
+        // Note : Call by worker
+        
+        RingPtr createRing(uint64_t generation) override;
+        size_t drain(const std::vector<RingPtr> &rings) override;
+        void complete(size_t written, bool requested) override;
+        void finish() override;
+        void reportDropped(RingFlusher::Ring &ring, uint64_t dropped) override;
+        
+        void writeFile(const void *data, size_t size);
+        void writeText(const Source &source,
+                       spdlog::level::level_enum level,
+                       uint64_t time,
+                       size_t threadId,
+                       const std::string &text);
+        
+        // Attributes
+        
+        Config _config;
+        
+        // Note : Loggers are never removed, their index is the id of the BinaryLogger
+        
+        std::vector<std::unique_ptr<Source>> _sources;
+        
+        Logger::Ptr _logger;            // Reports of dropped records
+        
+        // Note : Call by worker
+        
+        FILE *_file;
+        uint64_t _time;                 // Time of the last entry written
+        std::map<std::tuple<const char*, uint16_t, uint8_t>, Site> _sites;
+        std::vector<uint8_t> _buffer;
+        std::vector<std::string> _arguments;
+        spdlog::formatter_ptr _formatter;
+        
+        std::atomic<uint64_t> _bytes;   // Stats
+        
+    };
+    
+}
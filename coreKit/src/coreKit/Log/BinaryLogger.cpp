@@ -0,0 +1,55 @@
+//
+//  BinaryLogger.cpp
+//  coreKit
+//
+//
+
+#include "BinaryLogger.hpp"
+
+#include "Log.hpp"
+
+namespace coreKit {
+    
+    // BinaryLogger implementation
+    
+    BinaryLogger::BinaryLogger(const Logger::Name &name,
+                               Logger::Type type,
+                               Level level) :
+    
+    _log            (BinaryLog::getInstance()),
+    _id             (_log->declare(name, type)),
+    _rateLimiter    (Log::getRateLimiter(name)),
+    _level          (Log::getBinaryLevel(name, level))
+    
+    {
+    }
+    
+    BinaryLogger* BinaryLogger::operator->() {
+        return this;
+    }
+    
+    void BinaryLogger::set_level(Level level) {
+        _level->store(level, std::memory_order_relaxed);
+    }
+    
+    BinaryLogger::Level BinaryLogger::level() const {
+        return static_cast<Level>(_level->load(std::memory_order_relaxed));
+    }
+    
+    void BinaryLogger::flush() {
+        _log->flush_internal();
+    }
+    
+    bool BinaryLogger::limit(Level level, RateLimiter::Site &site) {
+        
+        uint64_t summary;
+        bool result = _rateLimiter->admit(site, level, summary);
+        
+        if (summary != 0) {
+            log(level, "{} records suppressed at {}:{}", summary, site._file, site._line);
+        }
+        
+        return result;
+    }
+    
+}
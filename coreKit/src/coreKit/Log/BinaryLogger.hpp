@@ -0,0 +1,97 @@
+//
+//  BinaryLogger.hpp
+//  coreKit
+//
+//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "BinaryFormat.hpp"
+#include "BinaryLog.hpp"
+#include "Logger.hpp"
+
+namespace coreKit {
+    
+    // BinaryLogger (Logger for hot paths, through BinaryLog)
+    
+    // Note : Same calls as a Logger (logger->info("Value {}", value)), but the arguments are only copied,
+    // formatting is deferred to the BinaryLog flusher or to the decoder of its file.
+    // Formats must be string literals, records only keep their address (Pointers and mutable arrays don't compile).
+    
+    class BinaryLogger {
+        
+    public:
+        
+        // Declarations
+        
+        using Level = Logger::Level;
+        
+        // Init
+        
+        BinaryLogger(const Logger::Name &name,
+                     Logger::Type type = Logger::Type::Public,
+                     Level level = spdlog::level::trace);
+        
+        // Non-copyable by design
+        
+        BinaryLogger(const BinaryLogger&) = delete;
+        BinaryLogger& operator=(const BinaryLogger&) = delete;
+        
+        BinaryLogger* operator->();
+        
+        // Level (Until the runtime levels of Log change again)
+        
+        void set_level(Level level);
+        Level level() const;
+        
+        bool should_log(Level level) const;
+        
+        // Rate limit check of a call site, after the level one (As a Logger, by the limits of its name)
+        
+        bool admit(Level level, RateLimiter::Site &site);
+        
+        // Log
+        
+        template<size_t N, typename... Args> void log(Level level, const char (&format)[N], const Args&... args);
+        template<size_t N, typename... Args> void log(Level level, char (&format)[N], const Args&... args) = delete;
+        
+        template<size_t N, typename... Args> void trace(const char (&format)[N], const Args&... args);
+        template<size_t N, typename... Args> void debug(const char (&format)[N], const Args&... args);
+        template<size_t N, typename... Args> void info(const char (&format)[N], const Args&... args);
+        template<size_t N, typename... Args> void warn(const char (&format)[N], const Args&... args);
+        template<size_t N, typename... Args> void error(const char (&format)[N], const Args&... args);
+        template<size_t N, typename... Args> void critical(const char (&format)[N], const Args&... args);
+        
+        // Note : Mutable arrays may change before the flusher reads them
+        
+        template<size_t N, typename... Args> void trace(char (&format)[N], const Args&... args) = delete;
+        template<size_t N, typename... Args> void debug(char (&format)[N], const Args&... args) = delete;
+        template<size_t N, typename... Args> void info(char (&format)[N], const Args&... args) = delete;
+        template<size_t N, typename... Args> void warn(char (&format)[N], const Args&... args) = delete;
+        template<size_t N, typename... Args> void error(char (&format)[N], const Args&... args) = delete;
+        template<size_t N, typename... Args> void critical(char (&format)[N], const Args&... args) = delete;
+        
+        // Wait for the records of this thread to be written
+        
+        void flush();
+        
+    private:
+        
+        bool limit(Level level, RateLimiter::Site &site);
+        
+        // Attributes
+        
+        const std::shared_ptr<BinaryLog> _log;
+        const uint16_t _id;
+        const RateLimiter::Ptr _rateLimiter;
+        
+        const std::shared_ptr<std::atomic<int>> _level;     // Shared by the binary loggers of its name, set by the runtime levels
+        
+    };
+    
+}
+
+#include "BinaryLogger.ipp"
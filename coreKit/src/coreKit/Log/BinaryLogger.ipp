@@ -0,0 +1,88 @@
+//
+//  BinaryLogger.ipp
+//  coreKit
+//
+//
+
+#pragma once
+
+#include "BinaryLogger.hpp"
+
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace coreKit {
+    
+    // BinaryLogger
+    
+    inline bool BinaryLogger::should_log(Level level) const {
+        return (level >= _level->load(std::memory_order_relaxed));
+    }
+    
+    inline bool BinaryLogger::admit(Level level, RateLimiter::Site &site) {
+        return (!_rateLimiter->isEnabled() || limit(level, site));
+    }
+    
+    template<size_t N, typename... Args> void BinaryLogger::log(Level level, const char (&format)[N], const Args&... args) {
+        
+        static_assert(sizeof...(Args) <= 255, "Binary log records hold at most 255 arguments");
+        
+        using Tuple     = std::tuple<BinaryFormat::Argument<typename std::decay<const Args>::type>...>;
+        using Encoder   = BinaryFormat::Arguments<sizeof...(Args), Tuple>;
+        
+        if (!should_log(level)) {
+            return;
+        }
+        
+        Tuple arguments(args...);
+        size_t length = Encoder::size(arguments);
+        
+        // Copy the arguments into the ring of this thread
+        
+        BinaryLog::Slot slot;
+        
+        if (_log->reserve(slot, _id, level, format, length)) {
+            
+            if (slot._data) {
+                Encoder::write(slot._data, arguments);
+            }
+            
+            _log->commit(slot);
+            
+            return;
+        }
+        
+        // Note : Flusher stopped, format now
+        
+        std::vector<uint8_t> buffer(length);
+        Encoder::write(buffer.data(), arguments);
+        
+        _log->write(_id, level, format, buffer.data(), length);
+    }
+    
+    template<size_t N, typename... Args> void BinaryLogger::trace(const char (&format)[N], const Args&... args) {
+        log(spdlog::level::trace, format, args...);
+    }
+    
+    template<size_t N, typename... Args> void BinaryLogger::debug(const char (&format)[N], const Args&... args) {
+        log(spdlog::level::debug, format, args...);
+    }
+    
+    template<size_t N, typename... Args> void BinaryLogger::info(const char (&format)[N], const Args&... args) {
+        log(spdlog::level::info, format, args...);
+    }
+    
+    template<size_t N, typename... Args> void BinaryLogger::warn(const char (&format)[N], const Args&... args) {
+        log(spdlog::level::warn, format, args...);
+    }
+    
+    template<size_t N, typename... Args> void BinaryLogger::error(const char (&format)[N], const Args&... args) {
+        log(spdlog::level::err, format, args...);
+    }
+    
+    template<size_t N, typename... Args> void BinaryLogger::critical(const char (&format)[N], const Args&... args) {
+        log(spdlog::level::critical, format, args...);
+    }
+    
+}
@@ -6,39 +6,444 @@
 //
 //
 
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
 #include <spdlog/sinks/dist_sink.h>
 
 #include "Log.hpp"
 
+#include "AsyncSink.hpp"
+
+#include <coreKit/Config/Config.hpp>
+
 namespace coreKit {
     
+    // Global variables
+    
+    static Logger logger( { "coreKit", "Log" }, Logger::Type::Internal );
+    
+    // Config
+    
+    using LevelMap      = std::map<std::string, std::string>;
+    using RateLimitMap  = std::map<std::string, std::map<std::string, double>>;
+    
+    // Note : Created on first use, Log may be created before the config list
+    
+    static Parameter::Ptr levelsParameter() {
+        static const Parameter::Ptr parameter = makeParam<LevelMap>("Levels", "Logger levels by name (trace, debug, info, warn, err, critical or off)", LevelMap());
+        return parameter;
+    }
+    
+    static Parameter::Ptr rateLimitsParameter() {
+        static const Parameter::Ptr parameter = makeParam<RateLimitMap>("RateLimits", "Logger rate limits by name, per call site (rate in records per second, burst, sampling and period in microseconds)", RateLimitMap());
+        return parameter;
+    }
+    
+    static const ConfigList configList({ "coreKit", "Log" }, {
+        
+        levelsParameter(),
+        rateLimitsParameter()
+        
+    });
+    
+    static std::map<std::string, Logger::Level> convertLevels(const Parameter &parameter) {
+        
+        std::map<std::string, Logger::Level> result;
+        
+        for (const auto &level : static_cast<const ParameterExt<LevelMap>&>(parameter).get()) {
+            result[level.first] = Log::parseLevel(level.second);
+        }
+        
+        return result;
+    }
+    
+    static std::map<std::string, RateLimiter::Config> convertRateLimits(const Parameter &parameter) {
+        
+        std::map<std::string, RateLimiter::Config> result;
+        
+        for (const auto &rateLimit : static_cast<const ParameterExt<RateLimitMap>&>(parameter).get()) {
+            
+            // Note : Burst defaults to one second of records, summaries to one per second
+            
+            RateLimiter::Config config { 0, 0, 0, 1000000 };
+            bool hasBurst = false;
+            
+            for (const auto &field : rateLimit.second) {
+                if (field.first == "rate") {
+                    config._rate = field.second;
+                } else if (field.first == "burst") {
+                    config._burst = field.second;
+                    hasBurst = true;
+                } else if (field.first == "sampling") {
+                    config._sampling = static_cast<uint64_t>(field.second);
+                } else if (field.first == "period") {
+                    config._period = static_cast<uint64_t>(field.second);
+                } else {
+                    throw std::invalid_argument("Invalid log rate limit field [" + field.first + "]");
+                }
+            }
+            
+            if (!hasBurst) {
+                config._burst = std::max(1.0, config._rate);
+            }
+            
+            result[rateLimit.first] = config;
+        }
+        
+        return result;
+    }
+    
     // Internal methods
     
+    // Note : A name matches its logger and the loggers below it
+    
+    static bool matches(const std::string &loggerName,
+                        const std::string &name) {
+        return (loggerName == name ||
+                (loggerName.size() > name.size() && loggerName.compare(0, name.size(), name) == 0 && loggerName[name.size()] == '.'));
+    }
+    
     Log::Log() : _sinks( {
         nullptr, nullptr
-    } ) {
+    } ), _entries( {
+        nullptr, nullptr
+    } ), _summaryStop(false) {
         
         // Create sinks
         
         _sinks._intenal = std::make_shared<spdlog::sinks::dist_sink_mt>();
         _sinks._public  = std::make_shared<spdlog::sinks::dist_sink_mt>();
         
+        // Create entries (Synchronous until the queue starts)
+        
+        _queue = std::make_shared<AsyncQueue>();
+        
+        _entries._intenal   = std::make_shared<AsyncSink>(_sinks._intenal, _queue);
+        _entries._public    = std::make_shared<AsyncSink>(_sinks._public, _queue);
+        
+        // Runtime levels (Applied again on each config change)
+        
+        auto parameter = levelsParameter();
+        
+        // Note : The parameter is already assigned on notification, a bad value keeps the previous levels
+        
+        parameter->subscribe([](const Parameter &parameter) {
+            try {
+                setLevels(convertLevels(parameter));
+            } catch (const std::exception &e) {
+                COREKIT_LOG_ERROR(logger, "Log levels are not changed : {}", e.what());
+            }
+        });
+        
+        // Note : Log is not usable while it is created, a bad initial value goes to stderr
+        
+        try {
+            setLevels_internal(convertLevels(*parameter));
+        } catch (const std::exception &e) {
+            fprintf(stderr, "Log levels are not set : %s\n", e.what());
+        }
+        
+        // Rate limits (Applied again on each config change)
+        
+        auto rateLimits = rateLimitsParameter();
+        
+        rateLimits->subscribe([](const Parameter &parameter) {
+            try {
+                setRateLimits(convertRateLimits(parameter));
+            } catch (const std::exception &e) {
+                COREKIT_LOG_ERROR(logger, "Log rate limits are not changed : {}", e.what());
+            }
+        });
+        
+        try {
+            setRateLimits_internal(convertRateLimits(*rateLimits));
+        } catch (const std::exception &e) {
+            fprintf(stderr, "Log rate limits are not set : %s\n", e.what());
+        }
+    }
+    
+    Log::~Log() {
+        
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _summaryStop = true;
+        }
+        
+        _summaryCondition.notify_all();
+        
+        if (_summaryThread.joinable()) {
+            _summaryThread.join();
+        }
     }
     
     Logger::Ptr Log::get_internal(const Logger::Name &loggerName,
-                                  Logger::Type type) {
+                                  Logger::Type type,
+                                  const Logger::Level *level) {
         
         const std::string fullname = Logger::convertName(loggerName);
+        
+        std::lock_guard<std::mutex> lock(_mutex);
+        
         Logger::Ptr logger = spdlog::get(fullname);
         
         if (!logger) {
-            auto sinkPtr = type == Logger::Type::Public ? _sinks._public : _sinks._intenal;
+            auto sinkPtr = type == Logger::Type::Public ? _entries._public : _entries._intenal;
             logger = spdlog::create(fullname, sinkPtr);
         }
         
+        // Note : Its own level applies when no runtime level matches its name
+        
+        auto it = _loggers.find(fullname);
+        
+        if (it == _loggers.end()) {
+            it = _loggers.insert(std::make_pair(fullname, std::make_pair(logger, logger->level()))).first;
+        }
+        
+        if (level) {
+            it->second.second = *level;
+        }
+        
+        applyLevels();
+        
         return logger;
     }
     
+    void Log::setLevel_internal(const std::string &loggerName,
+                                const Logger::Level *level) {
+        
+        std::lock_guard<std::mutex> lock(_mutex);
+        
+        if (level) {
+            _levels[loggerName] = *level;
+        } else {
+            _levels.erase(loggerName);
+        }
+        
+        applyLevels();
+    }
+    
+    void Log::setLevels_internal(const std::map<std::string, Logger::Level> &levels) {
+        
+        std::lock_guard<std::mutex> lock(_mutex);
+        
+        _levels = levels;
+        
+        applyLevels();
+    }
+    
+    std::shared_ptr<std::atomic<int>> Log::getBinaryLevel_internal(const std::string &loggerName,
+                                                                   Logger::Level level) {
+        
+        std::lock_guard<std::mutex> lock(_mutex);
+        
+        auto it = _binaryLevels.find(loggerName);
+        
+        if (it == _binaryLevels.end()) {
+            it = _binaryLevels.insert(std::make_pair(loggerName, std::make_pair(std::make_shared<std::atomic<int>>(level), level))).first;
+        } else {
+            it->second.second = level;
+        }
+        
+        applyLevels();
+        
+        return it->second.first;
+    }
+    
+    void Log::applyLevels() {
+        
+        for (const auto &logger : _loggers) {
+            logger.second.first->set_level(findLevel(logger.first, logger.second.second));
+        }
+        
+        for (const auto &binaryLevel : _binaryLevels) {
+            binaryLevel.second.first->store(findLevel(binaryLevel.first, binaryLevel.second.second), std::memory_order_relaxed);
+        }
+    }
+    
+    Logger::Level Log::findLevel(const std::string &loggerName,
+                                 Logger::Level level) const {
+        
+        // Most specific runtime level (The longest name matching the logger or one of its parents)
+        
+        size_t length = 0;
+        
+        for (const auto &runtime : _levels) {
+            
+            const std::string &name = runtime.first;
+            
+            if (matches(loggerName, name) && name.size() >= length) {
+                level = runtime.second;
+                length = name.size();
+            }
+        }
+        
+        return level;
+    }
+    
+    RateLimiter::Ptr Log::getRateLimiter_internal(const std::string &loggerName) {
+        
+        std::lock_guard<std::mutex> lock(_mutex);
+        
+        auto it = _rateLimiters.find(loggerName);
+        
+        if (it == _rateLimiters.end()) {
+            
+            it = _rateLimiters.insert(std::make_pair(loggerName, std::make_shared<RateLimiter>())).first;
+            
+            if (auto config = findRateLimit(loggerName)) {
+                it->second->configure(*config);
+            }
+        }
+        
+        return it->second;
+    }
+    
+    void Log::setRateLimit_internal(const std::string &loggerName,
+                                    const RateLimiter::Config *config) {
+        
+        if (config) {
+            RateLimiter::validate(*config);
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            
+            if (config) {
+                _rateLimits[loggerName] = *config;
+            } else {
+                _rateLimits.erase(loggerName);
+            }
+            
+            applyRateLimits();
+        }
+        
+        // Counts suppressed under the previous limits
+        
+        flushSummaries(true);
+    }
+    
+    void Log::setRateLimits_internal(const std::map<std::string, RateLimiter::Config> &rateLimits) {
+        
+        for (const auto &rateLimit : rateLimits) {
+            RateLimiter::validate(rateLimit.second);
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            
+            _rateLimits = rateLimits;
+            
+            applyRateLimits();
+        }
+        
+        flushSummaries(true);
+    }
+    
+    const RateLimiter::Config* Log::findRateLimit(const std::string &loggerName) const {
+        
+        // Most specific rate limit, none when no name matches
+        
+        const RateLimiter::Config *result = nullptr;
+        size_t length = 0;
+        
+        for (const auto &rateLimit : _rateLimits) {
+            
+            const std::string &name = rateLimit.first;
+            
+            if (matches(loggerName, name) && name.size() >= length) {
+                result = &rateLimit.second;
+                length = name.size();
+            }
+        }
+        
+        return result;
+    }
+    
+    void Log::applyRateLimits() {
+        
+        for (const auto &rateLimiter : _rateLimiters) {
+            
+            auto config = findRateLimit(rateLimiter.first);
+            
+            if (config) {
+                rateLimiter.second->configure(*config);
+            } else {
+                rateLimiter.second->disable();
+            }
+        }
+        
+        // Summary thread (Started with the first rate limit, woken to pick up the new periods)
+        
+        bool enabled = std::any_of(_rateLimits.begin(), _rateLimits.end(), [](const std::pair<const std::string, RateLimiter::Config> &rateLimit) {
+            return rateLimit.second._rate > 0;
+        });
+        
+        if (enabled && !_summaryThread.joinable()) {
+            _summaryThread = std::thread(&Log::runSummaries, this);
+        }
+        
+        _summaryCondition.notify_all();
+    }
+    
+    void Log::flushSummaries(bool all) {
+        
+        std::vector<std::pair<RateLimiter::Ptr, Logger::Ptr>> rateLimiters;
+        
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            
+            for (const auto &rateLimiter : _rateLimiters) {
+                auto it = _loggers.find(rateLimiter.first);
+                rateLimiters.emplace_back(rateLimiter.second, it != _loggers.end() ? it->second.first : nullptr);
+            }
+        }
+        
+        for (const auto &rateLimiter : rateLimiters) {
+            rateLimiter.first->flush(all, [&rateLimiter](const RateLimiter::Site &site, Logger::Level level, uint64_t suppressed) {
+                
+                // Note : A name used by binary loggers only has no text logger, its summaries go to the Log one
+                
+                spdlog::logger *target = (rateLimiter.second ? rateLimiter.second.get() : logger.operator->());
+                target->log(level, "{} records suppressed at {}:{}", suppressed, site._file, site._line);
+            });
+        }
+    }
+    
+    void Log::runSummaries() {
+        
+        std::unique_lock<std::mutex> lock(_mutex);
+        
+        while (!_summaryStop) {
+            
+            // Note : Woken at the shortest summary period of the enabled rate limits (1 ms at least)
+            
+            uint64_t period = 0;
+            
+            for (const auto &rateLimit : _rateLimits) {
+                if (rateLimit.second._rate > 0) {
+                    uint64_t value = std::max<uint64_t>(rateLimit.second._period, 1000);
+                    period = (period == 0 ? value : std::min(period, value));
+                }
+            }
+            
+            if (period == 0) {
+                _summaryCondition.wait(lock);
+            } else {
+                _summaryCondition.wait_for(lock, std::chrono::microseconds(period));
+            }
+            
+            if (_summaryStop) {
+                break;
+            }
+            
+            lock.unlock();
+            flushSummaries(false);
+            lock.lock();
+        }
+    }
+    
     void Log::subscribe_internal(const spdlog::sink_ptr &sink,
                                  Logger::Type type) {
         
@@ -74,19 +479,96 @@ namespace coreKit {
         unsubscribe(sink, Logger::Type::Internal);
     }
     
+    void Log::enableAsync(const AsyncQueue::Config &config) {
+        getInstance()->_queue->start(config);
+    }
+    
+    void Log::disableAsync() {
+        getInstance()->_queue->stop();
+    }
+    
+    AsyncQueue::Stats Log::getAsyncStats() {
+        return getInstance()->_queue->getStats();
+    }
+    
+    void Log::write(const spdlog::details::log_msg &msg,
+                    Logger::Type type) {
+        
+        auto instance = getInstance();
+        auto sinkPtr = type == Logger::Type::Public ? instance->_entries._public : instance->_entries._intenal;
+        
+        sinkPtr->log(msg);
+    }
+    
+    void Log::setLevel(const std::string &loggerName,
+                       Logger::Level level) {
+        getInstance()->setLevel_internal(loggerName, &level);
+    }
+    
+    void Log::resetLevel(const std::string &loggerName) {
+        getInstance()->setLevel_internal(loggerName, nullptr);
+    }
+    
+    void Log::setLevels(const std::map<std::string, Logger::Level> &levels) {
+        getInstance()->setLevels_internal(levels);
+    }
+    
+    void Log::setRateLimit(const std::string &loggerName,
+                           const RateLimiter::Config &config) {
+        getInstance()->setRateLimit_internal(loggerName, &config);
+    }
+    
+    void Log::resetRateLimit(const std::string &loggerName) {
+        getInstance()->setRateLimit_internal(loggerName, nullptr);
+    }
+    
+    void Log::setRateLimits(const std::map<std::string, RateLimiter::Config> &rateLimits) {
+        getInstance()->setRateLimits_internal(rateLimits);
+    }
+    
+    std::shared_ptr<std::atomic<int>> Log::getBinaryLevel(const Logger::Name &loggerName,
+                                                          Logger::Level level) {
+        return getInstance()->getBinaryLevel_internal(Logger::convertName(loggerName), level);
+    }
+    
+    RateLimiter::Ptr Log::getRateLimiter(const Logger::Name &loggerName) {
+        return getInstance()->getRateLimiter_internal(Logger::convertName(loggerName));
+    }
+    
+    Logger::Level Log::parseLevel(const std::string &level) {
+        
+        static const std::map<std::string, Logger::Level> levels = {
+            
+            { "trace",      spdlog::level::trace    },
+            { "debug",      spdlog::level::debug    },
+            { "info",       spdlog::level::info     },
+            { "warn",       spdlog::level::warn     },
+            { "warning",    spdlog::level::warn     },
+            { "err",        spdlog::level::err      },
+            { "error",      spdlog::level::err      },
+            { "critical",   spdlog::level::critical },
+            { "off",        spdlog::level::off      }
+            
+        };
+        
+        auto it = levels.find(level);
+        
+        if (it == levels.end()) {
+            throw std::invalid_argument("Invalid log level [" + level + "]");
+        }
+        
+        return it->second;
+    }
+    
     Logger::Ptr Log::get(const Logger::Name &loggerName,
                          Logger::Type type) {
-        return getInstance()->get_internal(loggerName, type);
+        return getInstance()->get_internal(loggerName, type, nullptr);
     }
     
     Logger::Ptr Log::get(const Logger::Name &loggerName,
                          Logger::Type type,
                          Logger::Level level) {
-        
-        Logger::Ptr ptr = get(loggerName, type);
-        ptr->set_level(level);
-        
-        return ptr;
+        return getInstance()->get_internal(loggerName, type, &level);
     }
     
 }
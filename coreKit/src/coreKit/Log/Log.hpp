@@ -8,9 +8,18 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
 #include <spdlog/spdlog.h>
 
+#include "AsyncQueue.hpp"
 #include "Logger.hpp"
+#include "RateLimiter.hpp"
 
 #include <coreKit/Utils/Singleton.hpp>
 
@@ -24,6 +33,8 @@ namespace coreKit {
         
     public:
         
+        ~Log();
+        
         // Create / Get logger
         
         static Logger::Ptr get(const Logger::Name &loggerName,
@@ -43,6 +54,50 @@ namespace coreKit {
         static void subscribe(const spdlog::sink_ptr &sink);
         static void unsubscribe(const spdlog::sink_ptr &sink);
         
+        // Runtime levels by logger name (A name also applies to the loggers below it, as coreKit for coreKit.Stream)
+        
+        // Note : Configured by coreKit.Log.Levels (Reloaded with the config), they override the level of the Logger
+        
+        static void setLevel(const std::string &loggerName,
+                             Logger::Level level);
+        static void resetLevel(const std::string &loggerName);
+        
+        static void setLevels(const std::map<std::string, Logger::Level> &levels);     // Replaces every runtime level
+        
+        static Logger::Level parseLevel(const std::string &level);
+        
+        // Level of the binary loggers of a name (Kept up to date with the runtime levels, as the one of a Logger)
+        
+        static std::shared_ptr<std::atomic<int>> getBinaryLevel(const Logger::Name &loggerName,
+                                                                Logger::Level level);
+        
+        // Rate limits by logger name (Per call site of the COREKIT_LOG macros, names match as for the levels)
+        
+        // Note : Configured by coreKit.Log.RateLimits (Reloaded with the config), as { coreKit.Stream: { rate: 10, burst: 20, sampling: 100 } }
+        // A thread logs the summaries of the call sites gone quiet, the pending ones are logged on each change.
+        
+        static void setRateLimit(const std::string &loggerName,
+                                 const RateLimiter::Config &config);
+        static void resetRateLimit(const std::string &loggerName);
+        
+        static void setRateLimits(const std::map<std::string, RateLimiter::Config> &rateLimits);      // Replaces every rate limit
+        
+        static RateLimiter::Ptr getRateLimiter(const Logger::Name &loggerName);
+        
+        // Asynchronous mode (Log calls only queue records, a flusher thread writes them to the sinks)
+        
+        // Note : Disabling writes every pending record first, do it before exit
+        
+        static void enableAsync(const AsyncQueue::Config &config);
+        static void disableAsync();
+        
+        static AsyncQueue::Stats getAsyncStats();
+        
+        // Write a record formatted elsewhere (Through the queue while it runs)
+        
+        static void write(const spdlog::details::log_msg &msg,
+                          Logger::Type type);
+        
     private:
         
         Log();
@@ -55,7 +110,36 @@ namespace coreKit {
                                   Logger::Type type);
         
         Logger::Ptr get_internal(const Logger::Name &loggerName,
-                                 Logger::Type type);
+                                 Logger::Type type,
+                                 const Logger::Level *level);
+        
+        void setLevel_internal(const std::string &loggerName,
+                               const Logger::Level *level);
+        void setLevels_internal(const std::map<std::string, Logger::Level> &levels);
+        
+        std::shared_ptr<std::atomic<int>> getBinaryLevel_internal(const std::string &loggerName,
+                                                                  Logger::Level level);
+        
+        RateLimiter::Ptr getRateLimiter_internal(const std::string &loggerName);
+        
+        void setRateLimit_internal(const std::string &loggerName,
+                                   const RateLimiter::Config *config);
+        void setRateLimits_internal(const std::map<std::string, RateLimiter::Config> &rateLimits);
+        
+        // Note : Call with the mutex locked
+        
+        void applyLevels();
+        void applyRateLimits();
+        
+        Logger::Level findLevel(const std::string &loggerName,
+                                Logger::Level level) const;
+        
+        const RateLimiter::Config* findRateLimit(const std::string &loggerName) const;
+        
+        // Rate limit summaries (Logged without the mutex, a sink may log in turn)
+        
+        void flushSummaries(bool all);
+        void runSummaries();
         
         // Attributes
         
@@ -66,6 +150,34 @@ namespace coreKit {
             
         } _sinks;
         
+        // Note : Loggers write to the entries, which forward to the sinks directly or through the queue
+        
+        struct {
+            
+            spdlog::sink_ptr _intenal;
+            spdlog::sink_ptr _public;
+            
+        } _entries;
+        
+        AsyncQueue::Ptr _queue;
+        
+        // Levels
+        
+        std::mutex _mutex;
+        
+        std::map<std::string, std::pair<Logger::Ptr, Logger::Level>> _loggers;     // Logger and its own level
+        std::map<std::string, std::pair<std::shared_ptr<std::atomic<int>>, Logger::Level>> _binaryLevels;
+        std::map<std::string, Logger::Level> _levels;
+        
+        // Rate limits
+        
+        std::map<std::string, RateLimiter::Ptr> _rateLimiters;
+        std::map<std::string, RateLimiter::Config> _rateLimits;
+        
+        std::thread _summaryThread;
+        std::condition_variable _summaryCondition;
+        bool _summaryStop;
+        
     };
     
 }
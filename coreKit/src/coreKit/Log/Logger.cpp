@@ -20,7 +20,7 @@ namespace coreKit {
                    Type type,
                    Level level) :
     
-    _created    (0),
+    _logger     (nullptr),
     _ptr        (nullptr)
     
     {
@@ -57,21 +57,33 @@ namespace coreKit {
         return result;
     }
     
-    Logger::Ptr Logger::operator->() {
+    spdlog::logger* Logger::create() {
         
-        if (!_created.load()) {
-            std::lock_guard<std::mutex> lock(_mutex);
-            if (!_created.load()) {
-                if (_name.size() > 0) {
-                    _ptr = Log::get(_name, _type, _level);
-                    _created = 1;
-                } else {
-                    throw std::runtime_error("Logger is not configured");
-                }
+        std::lock_guard<std::mutex> lock(_mutex);
+        
+        if (!_logger.load()) {
+            if (_name.size() > 0) {
+                _ptr = Log::get(_name, _type, _level);
+                _rateLimiter = Log::getRateLimiter(_name);
+                _logger.store(_ptr.get(), std::memory_order_release);
+            } else {
+                throw std::runtime_error("Logger is not configured");
             }
         }
         
-        return _ptr;
+        return _logger.load();
+    }
+    
+    bool Logger::limit(Level level, RateLimiter::Site &site) {
+        
+        uint64_t summary;
+        bool result = _rateLimiter->admit(site, level, summary);
+        
+        if (summary != 0) {
+            _logger.load(std::memory_order_acquire)->log(level, "{} records suppressed at {}:{}", summary, site._file, site._line);
+        }
+        
+        return result;
     }
     
 }
@@ -16,6 +16,8 @@
 
 #include <spdlog/logger.h>
 
+#include "RateLimiter.hpp"
+
 namespace coreKit {
     
     // Opaque declarations
@@ -52,18 +54,41 @@ namespace coreKit {
                        Type type = Type::Public,
                        Level level = spdlog::level::trace);
         
-        Ptr operator->();
+        // Note : Once created, a plain pointer load (No lock, no reference count shared by the threads)
+        
+        spdlog::logger* operator->() {
+            spdlog::logger *logger = _logger.load(std::memory_order_acquire);
+            return (logger ? logger : create());
+        }
+        
+        // Level check, before any argument is built
+        
+        bool should_log(Level level) {
+            return operator->()->should_log(level);
+        }
+        
+        // Rate limit check of a call site, after the level one (Summaries of suppressed records are logged at the same level)
+        
+        bool admit(Level level, RateLimiter::Site &site) {
+            operator->();
+            return (!_rateLimiter->isEnabled() || limit(level, site));
+        }
         
     private:
         
         static std::string convertName(const Name &name);
         
+        spdlog::logger* create();
+        
+        bool limit(Level level, RateLimiter::Site &site);
+        
         // Attributes
         
-        std::atomic_uchar _created;
+        std::atomic<spdlog::logger*> _logger;
         std::mutex _mutex;
         
-        Ptr _ptr;
+        Ptr _ptr;           // Owner of the logger
+        RateLimiter::Ptr _rateLimiter;
         
         Name    _name;
         Type    _type;
@@ -72,3 +97,53 @@ namespace coreKit {
     };
     
 }
+
+// Compile time level (Log calls below it are removed with their arguments, 0 is trace and 6 is off)
+
+#ifndef COREKIT_LOG_LEVEL
+#define COREKIT_LOG_LEVEL 0
+#endif
+
+// Log through a Logger (Or a BinaryLogger), arguments are only evaluated when the logger level and the rate limit of the call site let the record through
+
+#define COREKIT_LOG(logger, level, ...) \
+    do { \
+        static coreKit::RateLimiter::Site coreKitLogSite { __FILE__, __LINE__ }; \
+        if ((logger).should_log(level) && (logger).admit(level, coreKitLogSite)) { (logger)->log(level, __VA_ARGS__); } \
+    } while (0)
+
+#if COREKIT_LOG_LEVEL <= 0
+#define COREKIT_LOG_TRACE(logger, ...) COREKIT_LOG(logger, spdlog::level::trace, __VA_ARGS__)
+#else
+#define COREKIT_LOG_TRACE(logger, ...) do { } while (0)
+#endif
+
+#if COREKIT_LOG_LEVEL <= 1
+#define COREKIT_LOG_DEBUG(logger, ...) COREKIT_LOG(logger, spdlog::level::debug, __VA_ARGS__)
+#else
+#define COREKIT_LOG_DEBUG(logger, ...) do { } while (0)
+#endif
+
+#if COREKIT_LOG_LEVEL <= 2
+#define COREKIT_LOG_INFO(logger, ...) COREKIT_LOG(logger, spdlog::level::info, __VA_ARGS__)
+#else
+#define COREKIT_LOG_INFO(logger, ...) do { } while (0)
+#endif
+
+#if COREKIT_LOG_LEVEL <= 3
+#define COREKIT_LOG_WARN(logger, ...) COREKIT_LOG(logger, spdlog::level::warn, __VA_ARGS__)
+#else
+#define COREKIT_LOG_WARN(logger, ...) do { } while (0)
+#endif
+
+#if COREKIT_LOG_LEVEL <= 4
+#define COREKIT_LOG_ERROR(logger, ...) COREKIT_LOG(logger, spdlog::level::err, __VA_ARGS__)
+#else
+#define COREKIT_LOG_ERROR(logger, ...) do { } while (0)
+#endif
+
+#if COREKIT_LOG_LEVEL <= 5
+#define COREKIT_LOG_CRITICAL(logger, ...) COREKIT_LOG(logger, spdlog::level::critical, __VA_ARGS__)
+#else
+#define COREKIT_LOG_CRITICAL(logger, ...) do { } while (0)
+#endif
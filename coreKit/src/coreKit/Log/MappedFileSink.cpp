@@ -0,0 +1,365 @@
+//
+//  MappedFileSink.cpp
+//  coreKit
+//
+//
+
+#include "MappedFileSink.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <coreKit/Utils/Crc.hpp>
+
+namespace coreKit {
+    
+    // Global variables
+    
+    static const uint32_t magic         = 0x464D4B43;   // "CKMF"
+    static const uint16_t version       = 1;
+    static const size_t headerSize      = 64;
+    static const size_t recordHeader    = 2 * sizeof(uint32_t);
+    
+    // Internal methods
+    
+    static std::runtime_error systemError(const std::string &message,
+                                          const std::string &path,
+                                          int error = errno) {
+        return std::runtime_error(message + " [" + path + "] : " + strerror(error));
+    }
+    
+    // MappedFileSink
+    
+    MappedFileSink::MappedFileSink(const Config &config) :
+    
+    _config     (config),
+    _fd         (-1),
+    _data       (nullptr),
+    _header     (nullptr),
+    _synced     (0),
+    _sequence   (0),
+    _lost       (0),
+    _dropped    (0)
+    
+    {
+        static_assert(sizeof(Header) <= headerSize, "Mapped file header must fit its reserved space");
+        
+        if (config._path.empty()) {
+            throw std::invalid_argument("Mapped file path must be defined");
+        }
+        
+        if (config._fileSize < headerSize + recordHeader + 1) {
+            throw std::invalid_argument("Mapped file size must be over " + std::to_string(headerSize + recordHeader));
+        }
+        
+        if (config._fileCount < 2) {
+            throw std::invalid_argument("Mapped file count must be 2 at least");
+        }
+        
+        // Continue the sequence of the previous run, then keep its file
+        
+        uint64_t sequence = 0;
+        Header previous;
+        
+        std::ifstream stream(config._path, std::ios::binary);
+        
+        if (stream.read(reinterpret_cast<char*>(&previous), sizeof(previous)) && previous._magic == magic) {
+            sequence = previous._sequence + 1;
+        }
+        
+        stream.close();
+        
+        rotate();
+        open(sequence);
+    }
+    
+    MappedFileSink::~MappedFileSink() {
+        close();
+    }
+    
+    size_t MappedFileSink::recover(const std::string &path,
+                                   size_t fileCount,
+                                   const std::function<void(const std::string &record)> &callback) {
+        
+        // Files ordered by sequence (Names shift on each rotation)
+        
+        std::vector<std::pair<uint64_t, std::vector<uint8_t>>> files;
+        
+        for (size_t index = 0; index < fileCount; index++) {
+            
+            std::ifstream stream(index == 0 ? path : path + "." + std::to_string(index), std::ios::binary);
+            
+            if (!stream) {
+                continue;
+            }
+            
+            std::vector<uint8_t> data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+            
+            if (data.size() < headerSize) {
+                continue;
+            }
+            
+            Header header;
+            memcpy(&header, data.data(), sizeof(header));
+            
+            if (header._magic != magic || header._version != version || header._headerSize != headerSize || header._capacity != data.size()) {
+                continue;
+            }
+            
+            files.emplace_back(header._sequence, std::move(data));
+        }
+        
+        std::sort(files.begin(), files.end(), [](const std::pair<uint64_t, std::vector<uint8_t>> &first,
+                                                 const std::pair<uint64_t, std::vector<uint8_t>> &second) {
+            return first.first < second.first;
+        });
+        
+        // Records (Up to the used size or the first damaged one)
+        
+        size_t result = 0;
+        
+        for (const auto &file : files) {
+            
+            Header header;
+            memcpy(&header, file.second.data(), sizeof(header));
+            
+            const uint8_t *data = file.second.data() + headerSize;
+            const uint8_t *end = data + std::min<uint64_t>(header._used, file.second.size() - headerSize);
+            
+            while (static_cast<size_t>(end - data) >= recordHeader) {
+                
+                uint32_t length;
+                uint32_t crc;
+                
+                memcpy(&length, data, sizeof(length));
+                memcpy(&crc, data + sizeof(length), sizeof(crc));
+                
+                if (length > static_cast<size_t>(end - data) - recordHeader || crc32c(0, data + recordHeader, length) != crc) {
+                    break;
+                }
+                
+                callback(std::string(reinterpret_cast<const char*>(data + recordHeader), length));
+                
+                data += recordHeader + length;
+                result++;
+            }
+        }
+        
+        return result;
+    }
+    
+    uint64_t MappedFileSink::getDropped() const {
+        return _dropped.load();
+    }
+    
+    void MappedFileSink::_sink_it(const spdlog::details::log_msg &msg) {
+        
+        size_t length = msg.formatted.size();
+        
+        if (_data && headerSize + _header->_used + recordHeader + length > _header->_capacity && _header->_used != 0) {
+            _sequence = _header->_sequence + 1;
+            close();
+        }
+        
+        // Note : Unmapped once a rotation failed, records are dropped (And counted) until a file is opened again
+        
+        if (!_data && !reopen()) {
+            _lost++;
+            _dropped++;
+            return;
+        }
+        
+        // Note : A record larger than a file is cut
+        
+        length = std::min<size_t>(length, _header->_capacity - headerSize - _header->_used - recordHeader);
+        
+        uint8_t *data = _data + headerSize + _header->_used;
+        
+        uint32_t recordLength = static_cast<uint32_t>(length);
+        uint32_t crc = crc32c(0, msg.formatted.data(), length);
+        
+        memcpy(data, &recordLength, sizeof(recordLength));
+        memcpy(data + sizeof(recordLength), &crc, sizeof(crc));
+        memcpy(data + recordHeader, msg.formatted.data(), length);
+        
+        // Note : Used grows once the record is complete
+        
+        _header->_used += recordHeader + length;
+        
+        // Batched write back
+        
+        uint64_t pending = headerSize + _header->_used - _synced;
+        
+        if ((_config._syncBytes != 0 && pending >= _config._syncBytes) ||
+            (_config._syncPeriod != 0 && std::chrono::steady_clock::now() - _syncTime >= std::chrono::microseconds(_config._syncPeriod))) {
+            sync(false);
+        }
+    }
+    
+    void MappedFileSink::_flush() {
+        sync(true);
+    }
+    
+    void MappedFileSink::open(uint64_t sequence) {
+        
+        const std::string path = getPath(0);
+        
+        // Note : Exclusive, the rotation moved the previous file away (It is never truncated)
+        
+        _fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        
+        if (_fd < 0) {
+            throw systemError("Mapped file can't be opened", path);
+        }
+        
+        // Note : Blocks are allocated up front, some file systems only support the size.
+        // posix_fallocate returns its error rather than setting errno, a full disk is not worked around (Writes would fault).
+        
+        int result = posix_fallocate(_fd, 0, _config._fileSize);
+        
+        if (result == EINVAL || result == EOPNOTSUPP) {
+            result = (ftruncate(_fd, _config._fileSize) == 0 ? 0 : errno);
+        }
+        
+        if (result != 0) {
+            auto error = systemError("Mapped file can't be allocated", path, result);
+            ::close(_fd);
+            unlink(path.c_str());
+            _fd = -1;
+            throw error;
+        }
+        
+        void *data = mmap(nullptr, _config._fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+        
+        if (data == MAP_FAILED) {
+            auto error = systemError("Mapped file can't be mapped", path);
+            ::close(_fd);
+            unlink(path.c_str());
+            _fd = -1;
+            throw error;
+        }
+        
+        _data = static_cast<uint8_t*>(data);
+        _header = reinterpret_cast<Header*>(_data);
+        
+        _header->_magic         = magic;
+        _header->_version       = version;
+        _header->_headerSize    = headerSize;
+        _header->_capacity      = _config._fileSize;
+        _header->_sequence      = sequence;
+        _header->_created       = std::chrono::duration_cast<std::chrono::nanoseconds>(spdlog::log_clock::now().time_since_epoch()).count();
+        _header->_used          = 0;
+        
+        _synced = 0;
+        _syncTime = std::chrono::steady_clock::now();
+    }
+    
+    void MappedFileSink::close() {
+        
+        if (!_data) {
+            return;
+        }
+        
+        sync(false);
+        
+        munmap(_data, _config._fileSize);
+        ::close(_fd);
+        
+        _data = nullptr;
+        _header = nullptr;
+        _fd = -1;
+    }
+    
+    void MappedFileSink::rotate() {
+        
+        close();
+        
+        // Note : The oldest file is replaced by the rename
+        
+        for (size_t index = _config._fileCount - 1; index > 0; index--) {
+            if (rename(getPath(index - 1).c_str(), getPath(index).c_str()) != 0 && errno != ENOENT) {
+                throw systemError("Mapped file can't be rotated", getPath(index - 1));
+            }
+        }
+    }
+    
+    bool MappedFileSink::reopen() {
+        
+        auto now = std::chrono::steady_clock::now();
+        
+        if (now < _retryTime) {
+            return false;
+        }
+        
+        // Note : The current file is left in place when its rotation failed, it is rotated on retry
+        
+        try {
+            
+            if (access(getPath(0).c_str(), F_OK) == 0) {
+                rotate();
+            }
+            
+            open(_sequence);
+            
+        } catch (const std::exception &e) {
+            
+            // Note : Log may be what this sink writes, the error goes to stderr once per outage
+            
+            if (_retryTime == std::chrono::steady_clock::time_point()) {
+                fprintf(stderr, "Mapped log file unavailable : %s\n", e.what());
+            }
+            
+            _retryTime = now + std::chrono::seconds(1);
+            
+            return false;
+        }
+        
+        if (_lost != 0) {
+            fprintf(stderr, "%llu log records dropped (Mapped file unavailable)\n", static_cast<unsigned long long>(_lost));
+        }
+        
+        _retryTime = std::chrono::steady_clock::time_point();
+        _lost = 0;
+        
+        return true;
+    }
+    
+    void MappedFileSink::sync(bool wait) {
+        
+        if (!_data) {
+            return;
+        }
+        
+        // Pages written since the last sync, the header one included
+        
+        static const uint64_t pageSize = sysconf(_SC_PAGESIZE);
+        
+        uint64_t begin = _synced & ~(pageSize - 1);
+        uint64_t end = std::min<uint64_t>(headerSize + _header->_used, _config._fileSize);
+        
+        if (begin >= pageSize) {
+            msync(_data, pageSize, wait ? MS_SYNC : MS_ASYNC);
+        }
+        
+        msync(_data + begin, end - begin, wait ? MS_SYNC : MS_ASYNC);
+        
+        _synced = end;
+        _syncTime = std::chrono::steady_clock::now();
+    }
+    
+    std::string MappedFileSink::getPath(size_t index) const {
+        return (index == 0 ? _config._path : _config._path + "." + std::to_string(index));
+    }
+    
+}
@@ -0,0 +1,124 @@
+//
+//  MappedFileSink.hpp
+//  coreKit
+//
+//
+
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <spdlog/sinks/base_sink.h>
+
+namespace coreKit {
+    
+    // MappedFileSink (Log records copied into pre-allocated memory-mapped files)
+    
+    // Note : A record is a memory copy, the kernel writes the pages back (msync in batches, or on flush).
+    // Files are rotated once full (path, path.1 .. path.N-1, the oldest is dropped), the previous run is rotated at start.
+    // The records written before a crash are in the page cache, recover() reads them back after a restart.
+    
+    class MappedFileSink :
+    public spdlog::sinks::base_sink<std::mutex> {
+    
+    public:
+        
+        // Declarations
+        
+        using Ptr = std::shared_ptr<MappedFileSink>;
+        
+        // Config
+        
+        struct Config {
+            
+            // Attributes
+            
+            std::string     _path;
+            size_t          _fileSize;      // Bytes per file, allocated up front
+            size_t          _fileCount;     // Files kept, the current one included (2 at least, the previous run is never truncated)
+            size_t          _syncBytes;     // Asynchronous msync once this many bytes are written (0 for flush only)
+            uint64_t        _syncPeriod;    // ... or once this time elapsed since the last one in microseconds (0 for none)
+            
+        };
+        
+        // Init
+        
+        MappedFileSink(const Config &config);
+        ~MappedFileSink();
+        
+        // Non-copyable by design
+        
+        MappedFileSink(const MappedFileSink&) = delete;
+        MappedFileSink& operator=(const MappedFileSink&) = delete;
+        
+        // Records dropped while no file could be opened (After a failed rotation)
+        
+        uint64_t getDropped() const;
+        
+        // Read the records of the files of a sink, oldest first (Returns how many were read)
+        
+        // Note : Reading stops at the first damaged record of a file (As one cut by a power loss)
+        
+        static size_t recover(const std::string &path,
+                              size_t fileCount,
+                              const std::function<void(const std::string &record)> &callback);
+    
+    private:
+        
+        // Private declarations
+        
+        // Note : Native byte order, files are read back on the board which wrote them
+        
+        struct Header {
+            
+            uint32_t    _magic;
+            uint16_t    _version;
+            uint16_t    _headerSize;
+            uint64_t    _capacity;      // File size
+            uint64_t    _sequence;      // Increases on each rotation
+            uint64_t    _created;       // Nanoseconds since epoch
+            uint64_t    _used;          // Record bytes after the header (Record : length, CRC-32C, text)
+            
+        };
+        
+        // Sink
+        
+        void _sink_it(const spdlog::details::log_msg &msg) override;
+        void _flush() override;
+        
+        // Private methods
+        
+        void open(uint64_t sequence);
+        void close();
+        void rotate();
+        bool reopen();
+        void sync(bool wait);
+        
+        std::string getPath(size_t index) const;
+        
+        // Attributes
+        
+        Config _config;
+        
+        int _fd;
+        uint8_t *_data;
+        Header *_header;
+        
+        uint64_t _synced;               // Offset of the first byte not synced yet
+        std::chrono::steady_clock::time_point _syncTime;
+        
+        uint64_t _sequence;             // Sequence of the next file
+        uint64_t _lost;                 // Records dropped since the last file was closed
+        std::chrono::steady_clock::time_point _retryTime;
+        std::atomic<uint64_t> _dropped;
+        
+    };
+    
+}
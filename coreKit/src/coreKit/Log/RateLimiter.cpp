@@ -0,0 +1,199 @@
+//
+//  RateLimiter.cpp
+//  coreKit
+//
+//
+
+#include "RateLimiter.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace coreKit {
+    
+    // Global variables
+    
+    // Note : Generations are unique across limiters, a call site is reset when it meets another config
+    
+    static std::atomic<uint64_t> generations(0);
+    
+    // Internal methods
+    
+    static int64_t nanoseconds(std::chrono::steady_clock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    }
+    
+    // RateLimiter implementation
+    
+    RateLimiter::RateLimiter() :
+    
+    _enabled    (false),
+    _generation (0),
+    _interval   (0),
+    _tolerance  (0),
+    _sampling   (0),
+    _period     (0),
+    _pending    (nullptr)
+    
+    {
+        _stats._admitted    = 0;
+        _stats._suppressed  = 0;
+        _stats._sampled     = 0;
+    }
+    
+    void RateLimiter::validate(const Config &config) {
+        if (config._rate < 0 || (config._rate > 0 && config._burst < 1)) {
+            throw std::invalid_argument("Rate limit needs a positive rate and a burst of one record at least");
+        }
+    }
+    
+    void RateLimiter::configure(const Config &config) {
+        
+        validate(config);
+        
+        int64_t interval = (config._rate > 0 ? static_cast<int64_t>(1e9 / config._rate) : 0);
+        
+        _interval.store(interval, std::memory_order_relaxed);
+        _tolerance.store(static_cast<int64_t>((config._burst - 1) * interval), std::memory_order_relaxed);
+        _sampling.store(config._sampling, std::memory_order_relaxed);
+        _period.store(static_cast<int64_t>(config._period) * 1000, std::memory_order_relaxed);
+        
+        _generation.store(++generations, std::memory_order_release);
+        _enabled.store(config._rate > 0, std::memory_order_relaxed);
+    }
+    
+    void RateLimiter::disable() {
+        configure( { 0, 0, 0, 0 } );
+    }
+    
+    bool RateLimiter::admit(Site &site,
+                            Level level,
+                            uint64_t &summary) {
+        
+        const int64_t now = nanoseconds(Clock::now());
+        
+        summary = 0;
+        
+        uint64_t generation = _generation.load(std::memory_order_acquire);
+        
+        if (!_enabled.load(std::memory_order_relaxed)) {
+            _stats._admitted++;
+            return true;
+        }
+        
+        // Note : A single caller resets the site, a concurrent one may still use the previous state
+        
+        uint64_t siteGeneration = site._generation.load(std::memory_order_acquire);
+        
+        if (siteGeneration != generation && site._generation.compare_exchange_strong(siteGeneration, generation)) {
+            site._arrival.store(0, std::memory_order_relaxed);
+            site._limited.store(0, std::memory_order_relaxed);
+            site._summary.store(now, std::memory_order_relaxed);
+        }
+        
+        // Bucket (The arrival time leads the clock by a record interval per token used)
+        
+        const int64_t interval = _interval.load(std::memory_order_relaxed);
+        const int64_t tolerance = _tolerance.load(std::memory_order_relaxed);
+        const uint64_t sampling = _sampling.load(std::memory_order_relaxed);
+        
+        bool result = false;
+        
+        int64_t arrival = site._arrival.load(std::memory_order_relaxed);
+        
+        while (std::max(arrival, now) - now <= tolerance) {
+            if (site._arrival.compare_exchange_weak(arrival, std::max(arrival, now) + interval, std::memory_order_relaxed)) {
+                result = true;
+                break;
+            }
+        }
+        
+        if (result) {
+            site._limited.store(0, std::memory_order_relaxed);
+        } else if (sampling != 0 && (site._limited.fetch_add(1, std::memory_order_relaxed) + 1) % sampling == 0) {
+            _stats._sampled++;
+            result = true;
+        } else {
+            
+            _stats._suppressed++;
+            
+            site._level.store(level, std::memory_order_relaxed);
+            
+            if (site._suppressed.fetch_add(1) == 0 && !site._pending.exchange(true)) {
+                push(site);
+            }
+        }
+        
+        if (result) {
+            _stats._admitted++;
+        }
+        
+        // Summary
+        
+        int64_t last = site._summary.load(std::memory_order_relaxed);
+        
+        if (site._suppressed.load(std::memory_order_relaxed) != 0 && now - last >= _period.load(std::memory_order_relaxed) &&
+            site._summary.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+            summary = site._suppressed.exchange(0);
+        }
+        
+        return result;
+    }
+    
+    void RateLimiter::flush(bool all,
+                            const Summary &callback) {
+        
+        const int64_t now = nanoseconds(Clock::now());
+        const int64_t period = _period.load(std::memory_order_relaxed);
+        
+        Site *site = _pending.exchange(nullptr, std::memory_order_acquire);
+        
+        while (site) {
+            
+            Site *next = site->_next.load(std::memory_order_relaxed);
+            
+            if (!all && site->_suppressed.load() != 0 && now - site->_summary.load(std::memory_order_relaxed) < period) {
+                
+                // Not due yet, still listed
+                
+                push(*site);
+                
+            } else {
+                
+                // Note : Unlisted first, a record suppressed from now on lists the site again
+                
+                site->_pending.store(false);
+                
+                uint64_t suppressed = site->_suppressed.exchange(0);
+                
+                if (suppressed != 0) {
+                    site->_summary.store(now, std::memory_order_relaxed);
+                    callback(*site, static_cast<Level>(site->_level.load(std::memory_order_relaxed)), suppressed);
+                }
+            }
+            
+            site = next;
+        }
+    }
+    
+    void RateLimiter::push(Site &site) {
+        
+        Site *head = _pending.load(std::memory_order_relaxed);
+        
+        do {
+            site._next.store(head, std::memory_order_relaxed);
+        } while (!_pending.compare_exchange_weak(head, &site, std::memory_order_release, std::memory_order_relaxed));
+    }
+    
+    RateLimiter::Stats RateLimiter::getStats() const {
+        
+        Stats result;
+        
+        result._admitted    = _stats._admitted.load();
+        result._suppressed  = _stats._suppressed.load();
+        result._sampled     = _stats._sampled.load();
+        
+        return result;
+    }
+    
+}
@@ -0,0 +1,169 @@
+//
+//  RateLimiter.hpp
+//  coreKit
+//
+//
+
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+
+#include <spdlog/common.h>
+
+namespace coreKit {
+    
+    // RateLimiter (Token bucket per log call site, shared by the loggers of a name)
+    
+    // Note : Once the bucket of a call site is empty its records are suppressed, but for one every sampling calls.
+    // The count of suppressed records is returned at most once per period (On a call of the site), for the caller to log a summary.
+    // The counts of the sites gone quiet are left to flush, called periodically and on each change by the owner of the limiter.
+    
+    class RateLimiter {
+    
+    public:
+        
+        // Declarations
+        
+        using Ptr   = std::shared_ptr<RateLimiter>;
+        using Level = spdlog::level::level_enum;
+        
+        // Call site (One static per COREKIT_LOG macro expansion, its state is lock free)
+        
+        // Note : The state belongs to the limiter which configured it last, a call site logs through a single logger
+        
+        struct Site {
+            
+            constexpr Site(const char *file, int line) :
+            
+            _file       (file),
+            _line       (line),
+            _generation (0),
+            _arrival    (0),
+            _limited    (0),
+            _suppressed (0),
+            _summary    (0),
+            _level      (0),
+            _pending    (false),
+            _next       (nullptr)
+            
+            { }
+            
+            const char  *_file;
+            int         _line;
+            
+            std::atomic<uint64_t>   _generation;    // Of the config the state was reset for
+            std::atomic<int64_t>    _arrival;       // Theoretical arrival time of the next record in nanoseconds (Token bucket as a GCRA)
+            std::atomic<uint64_t>   _limited;       // Calls since the bucket is empty, for sampling
+            std::atomic<uint64_t>   _suppressed;    // Since the last summary
+            std::atomic<int64_t>    _summary;
+            std::atomic<int>        _level;         // Of the last suppressed record
+            
+            std::atomic<bool>       _pending;       // Listed for a summary by a limiter
+            std::atomic<Site*>      _next;
+            
+        };
+        
+        using Summary = std::function<void(const Site &site, Level level, uint64_t suppressed)>;
+        
+        // Config
+        
+        struct Config {
+            
+            // Attributes
+            
+            double      _rate;          // Records per second and call site (0 for no limit)
+            double      _burst;         // Records let through at once
+            uint64_t    _sampling;      // Once limited, one call in this many still goes through (0 for none)
+            uint64_t    _period;        // Suppressed records summary period in microseconds
+            
+        };
+        
+        // Stats
+        
+        struct Stats {
+            
+            // Attributes
+            
+            uint64_t    _admitted;      // Records let through (Sampled ones included)
+            uint64_t    _suppressed;
+            uint64_t    _sampled;
+            
+        };
+        
+        // Init
+        
+        RateLimiter();
+        
+        // Non-copyable by design
+        
+        RateLimiter(const RateLimiter&) = delete;
+        RateLimiter& operator=(const RateLimiter&) = delete;
+        
+        // Throws std::invalid_argument for an unusable config
+        
+        static void validate(const Config &config);
+        
+        // Note : Call sites start again with a full bucket, their suppressed counts are kept for flush
+        
+        void configure(const Config &config);
+        void disable();
+        
+        bool isEnabled() const {
+            return _enabled.load(std::memory_order_relaxed);
+        }
+        
+        // Whether a record of the call site goes through (Summary is set to the suppressed count when one is due)
+        
+        bool admit(Site &site,
+                   Level level,
+                   uint64_t &summary);
+        
+        // Summaries not returned by admit yet, once their period elapsed (Or all of them)
+        
+        void flush(bool all,
+                   const Summary &callback);
+        
+        Stats getStats() const;
+    
+    private:
+        
+        // Private declarations
+        
+        using Clock = std::chrono::steady_clock;
+        
+        // Private methods
+        
+        void push(Site &site);
+        
+        // Attributes
+        
+        std::atomic<bool> _enabled;
+        std::atomic<uint64_t> _generation;
+        
+        // Note : In nanoseconds, a config change may be seen partly until the generation
+        
+        std::atomic<int64_t> _interval;         // Between two records
+        std::atomic<int64_t> _tolerance;        // Lead of the arrival time allowed by the burst
+        std::atomic<uint64_t> _sampling;
+        std::atomic<int64_t> _period;
+        
+        std::atomic<Site*> _pending;            // Sites with suppressed records (Lock free stack, emptied at once)
+        
+        // Stats
+        
+        struct {
+            
+            std::atomic<uint64_t> _admitted;
+            std::atomic<uint64_t> _suppressed;
+            std::atomic<uint64_t> _sampled;
+            
+        } _stats;
+        
+    };
+    
+}
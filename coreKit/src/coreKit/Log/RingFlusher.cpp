@@ -0,0 +1,307 @@
+//
+//  RingFlusher.cpp
+//  coreKit
+//
+//
+
+#include "RingFlusher.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace coreKit {
+    
+    // Global variables
+    
+    // Note : Generations are unique across flushers, a thread may feed several of them
+    
+    static std::atomic<uint64_t> nextGeneration(1);
+    
+    static thread_local std::vector<RingFlusher::RingPtr> localRings;
+    
+    // Ring
+    
+    RingFlusher::Ring::Ring(uint64_t mask,
+                            uint64_t generation) :
+    
+    _mask       (mask),
+    _generation (generation),
+    _head       (0),
+    _tail       (0),
+    _busy       (false),
+    _dropped    (0),
+    _blocked    (0),
+    _reported   (0),
+    _counted    (0)
+    
+    {
+    }
+    
+    // RingFlusher
+    
+    RingFlusher::RingFlusher(const std::string &name) :
+    
+    _running        (false),
+    _name           (name),
+    _period         (0),
+    _generation     (0),
+    _flushRequested (0),
+    _flushDone      (0)
+    
+    {
+        _stats._written = 0;
+        _stats._dropped = 0;
+        _stats._blocked = 0;
+        _stats._batches = 0;
+    }
+    
+    RingFlusher::~RingFlusher() {
+    }
+    
+    bool RingFlusher::isRunning() const {
+        return _running.load();
+    }
+    
+    void RingFlusher::startFlusher(uint64_t period,
+                                   const std::function<void()> &prepare) {
+        
+        std::lock_guard<std::mutex> control(_control);
+        std::lock_guard<std::mutex> lock(_mutex);
+        
+        if (_running.load()) {
+            throw std::runtime_error(_name + " is already running");
+        }
+        
+        prepare();
+        
+        _period = period;
+        
+        // Rings of the previous run are forgotten by their threads
+        
+        _rings.clear();
+        _generation.store(nextGeneration++);
+        _running.store(true);
+        
+        _thread = std::thread(&RingFlusher::run, this);
+    }
+    
+    void RingFlusher::stopFlusher() {
+        
+        std::lock_guard<std::mutex> control(_control);
+        
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            
+            if (!_running.load()) {
+                return;
+            }
+            
+            _running.store(false);
+        }
+        
+        _wakeUp.notify_all();
+        
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+    
+    bool RingFlusher::requestFlush(const std::function<void()> &request) {
+        
+        std::unique_lock<std::mutex> lock(_mutex);
+        
+        if (!_running.load()) {
+            return false;
+        }
+        
+        if (request) {
+            request();
+        }
+        
+        auto flushRequest = ++_flushRequested;
+        
+        _wakeUp.notify_one();
+        _flushed.wait(lock, [this, flushRequest]() {
+            return _flushDone >= flushRequest;
+        });
+        
+        return true;
+    }
+    
+    RingFlusher::Ring* RingFlusher::acquire() {
+        
+        if (!_running.load(std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        
+        Ring &ring = getRing();
+        
+        // Note : Busy is set before running is checked again, the flusher only stops once no ring is busy
+        
+        ring._busy.store(true);
+        
+        if (!_running.load() || ring._generation != _generation.load()) {
+            ring._busy.store(false);
+            return nullptr;
+        }
+        
+        return &ring;
+    }
+    
+    uint64_t RingFlusher::block(Ring &ring,
+                                uint64_t tail) {
+        
+        ring._blocked.store(ring._blocked.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        
+        uint64_t result = ring._tail.load(std::memory_order_acquire);
+        
+        while (result < tail) {
+            _wakeUp.notify_one();
+            std::this_thread::yield();
+            result = ring._tail.load(std::memory_order_acquire);
+        }
+        
+        return result;
+    }
+    
+    size_t RingFlusher::getProducers() const {
+        
+        std::lock_guard<std::mutex> lock(_mutex);
+        
+        return _rings.size();
+    }
+    
+    RingFlusher::Ring& RingFlusher::getRing() {
+        
+        auto generation = _generation.load();
+        
+        for (const auto &local : localRings) {
+            if (local->_generation == generation) {
+                return *local;
+            }
+        }
+        
+        // New producer
+        
+        RingPtr ring;
+        
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            
+            ring = createRing(generation);
+            _rings.push_back(ring);
+        }
+        
+        // Forget the rings dropped by their flusher
+        
+        localRings.erase(std::remove_if(localRings.begin(), localRings.end(), [](const RingPtr &local) {
+            return local.use_count() == 1;
+        }), localRings.end());
+        
+        localRings.push_back(ring);
+        
+        return *ring;
+    }
+    
+    void RingFlusher::report(Ring &ring) {
+        
+        auto blocked = ring._blocked.load(std::memory_order_relaxed);
+        
+        _stats._blocked += blocked - ring._counted;
+        ring._counted = blocked;
+        
+        auto dropped = ring._dropped.load(std::memory_order_relaxed);
+        
+        if (dropped == ring._reported) {
+            return;
+        }
+        
+        _stats._dropped += dropped - ring._reported;
+        
+        reportDropped(ring, dropped - ring._reported);
+        
+        ring._reported = dropped;
+    }
+    
+    void RingFlusher::run() {
+        
+        std::vector<RingPtr> rings;
+        
+        size_t written = 0;
+        
+        for (;;) {
+            
+            bool running;
+            uint64_t flushRequest;
+            
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                
+                if (written == 0 && _running.load() && _flushRequested == _flushDone) {
+                    _wakeUp.wait_for(lock, std::chrono::microseconds(_period));
+                }
+                
+                running = _running.load();
+                flushRequest = _flushRequested;
+                
+                collect();
+                
+                // Forget the rings of exited threads
+                
+                _rings.erase(std::remove_if(_rings.begin(), _rings.end(), [](const RingPtr &ring) {
+                    return (ring.use_count() == 1 && ring->_head.load() == ring->_tail.load());
+                }), _rings.end());
+                
+                rings = _rings;
+            }
+            
+            written = drain(rings);
+            
+            _stats._written += written;
+            
+            if (written != 0) {
+                _stats._batches++;
+            }
+            
+            // Flush requests (Records queued before them are written)
+            
+            complete(written, flushRequest != _flushDone);
+            
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _flushDone = flushRequest;
+            }
+            
+            _flushed.notify_all();
+            
+            // Stop once no producer is inside a record anymore
+            
+            if (!running && written == 0) {
+                
+                bool idle = std::none_of(rings.begin(), rings.end(), [](const RingPtr &ring) {
+                    return ring->_busy.load();
+                });
+                
+                if (idle) {
+                    
+                    written = drain(rings);
+                    
+                    _stats._written += written;
+                    
+                    if (written != 0) {
+                        _stats._batches++;
+                    }
+                    
+                    finish();
+                    
+                    break;
+                }
+                
+                std::this_thread::yield();
+            }
+            
+            rings.clear();
+        }
+    }
+    
+}
@@ -0,0 +1,176 @@
+//
+//  RingFlusher.hpp
+//  coreKit
+//
+//
+
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace coreKit {
+    
+    // RingFlusher (Per-thread rings drained by a flusher thread, base of AsyncQueue and BinaryLog)
+    
+    // Note : Each producer thread owns a single-producer / single-consumer ring for each run of the flusher,
+    // the owner adds the record storage and writes the records. A producer marks its ring busy while it writes
+    // a record, stopping drains the rings until none is busy.
+    
+    class RingFlusher {
+    
+    public:
+        
+        // Ring (Indexes and counters, the storage is in the ring of the owner)
+        
+        // Note : Indexes only grow, head is written by the producer, tail by the flusher
+        
+        struct Ring {
+            
+            Ring(uint64_t mask,
+                 uint64_t generation);
+            
+            const uint64_t          _mask;
+            const uint64_t          _generation;
+            
+            std::atomic<uint64_t>   _head;
+            char                    _headPadding[64 - sizeof(std::atomic<uint64_t>)];
+            
+            std::atomic<uint64_t>   _tail;
+            char                    _tailPadding[64 - sizeof(std::atomic<uint64_t>)];
+            
+            std::atomic<bool>       _busy;      // Producer inside a record
+            std::atomic<uint64_t>   _dropped;
+            std::atomic<uint64_t>   _blocked;
+            
+            // Note : Call by worker
+            
+            uint64_t                _reported;  // Dropped records already reported
+            uint64_t                _counted;   // Blocked calls already in the stats
+            
+        };
+        
+        using RingPtr = std::shared_ptr<Ring>;
+        
+        // Non-copyable by design
+        
+        RingFlusher(const RingFlusher&) = delete;
+        RingFlusher& operator=(const RingFlusher&) = delete;
+        
+        bool isRunning() const;
+    
+    protected:
+        
+        // Init
+        
+        // Note : Owners stop the flusher in their destructor, it calls their methods
+        
+        RingFlusher(const std::string &name);
+        ~RingFlusher();
+        
+        // Start / Stop the flusher (Stop writes every pending record first)
+        
+        // Note : Prepare runs with the mutex locked, once the flusher is known to be stopped (It may throw)
+        
+        void startFlusher(uint64_t period,
+                          const std::function<void()> &prepare);
+        void stopFlusher();
+        
+        // Wait for a flusher pass started after the call (Request runs with the mutex locked)
+        
+        // Note : Returns false when the flusher is stopped
+        
+        bool requestFlush(const std::function<void()> &request);
+        
+        // Ring of the calling thread, marked busy (nullptr when the flusher is stopped, the caller writes the record itself)
+        
+        Ring* acquire();
+        
+        void release(Ring &ring) {
+            ring._busy.store(false, std::memory_order_release);
+        }
+        
+        // Full ring (Drop counts the record, block waits for the flusher to move the tail up to the given index)
+        
+        void drop(Ring &ring) {
+            ring._dropped.store(ring._dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        
+        uint64_t block(Ring &ring,
+                       uint64_t tail);
+        
+        // Wake the flusher early
+        
+        void wakeUp() {
+            _wakeUp.notify_one();
+        }
+        
+        size_t getProducers() const;
+        
+        // Note : Call by worker
+        
+        virtual RingPtr createRing(uint64_t generation) = 0;            // With the mutex locked
+        virtual void collect() { }                                      // Pass start, with the mutex locked
+        virtual size_t drain(const std::vector<RingPtr> &rings) = 0;   // Records written
+        virtual void complete(size_t written, bool requested) = 0;     // Pass end, before its flush requests are released
+        virtual void finish() { }                                      // After the last pass
+        
+        // Counts the blocked calls and the dropped records of a ring, once its tail is released
+        
+        void report(Ring &ring);
+        
+        virtual void reportDropped(Ring &ring, uint64_t dropped) = 0;
+        
+        // Attributes
+        
+        std::atomic<bool> _running;
+        
+        std::mutex _control;            // Serializes start and stop
+        mutable std::mutex _mutex;
+        
+        // Stats
+        
+        struct {
+            
+            std::atomic<uint64_t> _written;
+            std::atomic<uint64_t> _dropped;
+            std::atomic<uint64_t> _blocked;
+            std::atomic<uint64_t> _batches;
+            
+        } _stats;
+    
+    private:
+        
+        // Private methods
+        
+        Ring& getRing();
+        
+        void run();
+        
+        // Attributes
+        
+        const std::string _name;
+        
+        uint64_t _period;
+        std::atomic<uint64_t> _generation;     // Identifies the rings of a run
+        
+        std::condition_variable _wakeUp;
+        std::condition_variable _flushed;
+        
+        std::vector<RingPtr> _rings;
+        uint64_t _flushRequested;
+        uint64_t _flushDone;
+        
+        std::thread _thread;
+        
+    };
+    
+}
@@ -0,0 +1,18 @@
+//
+//  Declarations.cpp
+//  coreKit
+//
+//
+
+#include "Declarations.hpp"
+
+namespace coreKit {
+    
+    namespace Metrics {
+        
+        // Log
+        
+        Logger _metricsLogger( { "coreKit", "Metrics" } );
+        
+    }
+}
@@ -0,0 +1,20 @@
+//
+//  Declarations.hpp
+//  coreKit
+//
+//
+
+#pragma once
+
+#include <coreKit/Log/Logger.hpp>
+
+namespace coreKit {
+    
+    namespace Metrics {
+        
+        // Log
+        
+        extern Logger _metricsLogger;
+        
+    }
+}
@@ -0,0 +1,92 @@
+//
+//  Dump.cpp
+//  coreKit
+//
+//
+
+#include "Dump.hpp"
+
+#include <stdexcept>
+
+#include "Declarations.hpp"
+#include "Registry.hpp"
+
+namespace coreKit {
+    
+    namespace Metrics {
+        
+        // Dump
+        
+        Dump::Dump(boost::asio::io_service &ioService,
+                   uint64_t interval,
+                   const Handler &handler) :
+        
+        _strand     (ioService),
+        _timer      (ioService),
+        _interval   (interval),
+        _handler    (handler),
+        _started    (false)
+        
+        {
+            if (interval == 0) {
+                throw std::invalid_argument("Invalid metrics dump interval");
+            }
+        }
+        
+        void Dump::start() {
+            
+            auto ptr = shared_from_this();
+            _strand.dispatch([ptr]() {
+                
+                // Note : Call by worker
+                
+                if (ptr->_started) {
+                    return;
+                }
+                
+                ptr->_started = true;
+                ptr->arm();
+            });
+        }
+        
+        void Dump::stop() {
+            
+            auto ptr = shared_from_this();
+            _strand.dispatch([ptr]() {
+                
+                // Note : Call by worker
+                
+                ptr->_started = false;
+                ptr->_timer.cancel();
+            });
+        }
+        
+        void Dump::arm() {
+            
+            // Note : (Must be) call by worker
+            
+            _timer.expires_from_now(boost::posix_time::microseconds(_interval));
+            
+            auto ptr = shared_from_this();
+            _timer.async_wait(_strand.wrap([ptr](const boost::system::error_code &error) {
+                
+                // Note : Call by worker
+                
+                if (error || !ptr->_started) {
+                    return;
+                }
+                
+                auto snapshot = Registry::snapshot();
+                
+                if (ptr->_handler) {
+                    ptr->_handler(snapshot);
+                } else {
+                    _metricsLogger->info("Metrics : {}", snapshot.toString());
+                }
+                
+                ptr->arm();
+            }));
+        }
+        
+    }
+}
@@ -0,0 +1,72 @@
+//
+//  Dump.hpp
+//  coreKit
+//
+//
+
+#pragma once
+
+#include <stdint.h>
+
+#include <functional>
+#include <memory>
+
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/strand.hpp>
+
+#include "Snapshot.hpp"
+
+namespace coreKit {
+    
+    namespace Metrics {
+        
+        // Dump (Periodic sink of registry snapshots)
+        
+        class Dump :
+        public std::enable_shared_from_this<Dump> {
+        
+        public:
+            
+            // Declarations
+            
+            using Ptr       = std::shared_ptr<Dump>;
+            using Handler   = std::function<void(const Snapshot&)>;
+            
+            // Init (Snapshots are logged if handler is null)
+            
+            Dump(boost::asio::io_service &ioService,
+                 uint64_t interval,
+                 const Handler &handler = nullptr);
+            
+            /* Non-copyable.*/
+            Dump(const Dump&) = delete;
+            Dump & operator=(const Dump&) = delete;
+            
+            // Start / Stop dumping every interval microseconds
+            
+            void start();
+            void stop();
+        
+        private:
+            
+            // Private methods
+            
+            void arm();
+            
+            // Attributes
+            
+            // Time handling
+            
+            boost::asio::strand _strand;
+            boost::asio::deadline_timer _timer;
+            
+            const uint64_t _interval;
+            const Handler _handler;
+            
+            bool _started;
+            
+        };
+        
+    }
+}
@@ -0,0 +1,164 @@
+//
+//  Metric.cpp
+//  coreKit
+//
+//
+
+#include "Metric.hpp"
+
+#include <stdexcept>
+
+#include <coreKit/Utils/iziDeclarations.hpp>
+
+namespace coreKit {
+    
+    namespace Metrics {
+        
+        // Helpers
+        
+        size_t shardIndex() {
+            
+            // Note : Threads are spread over shards in creation order
+            
+            static std::atomic<size_t> nextIndex(0);
+            static thread_local size_t index = nextIndex.fetch_add(1, std::memory_order_relaxed) % ShardCount;
+            
+            return index;
+        }
+        
+        std::string convertName(const Name &name) {
+            
+            std::string result;
+            for (Name::const_iterator it = name.begin(); it != name.end(); it++) {
+                result += (std::distance(name.begin(), it) != 0 ? "." : "") + *it;
+            }
+            
+            if (!coreKit::validateIziUrl(result)) {
+                throw std::runtime_error("Metric name [" + result + "] is not izi compliant");
+            }
+            
+            return result;
+        }
+        
+        // Counter
+        
+        Counter::Counter(const std::string &name) :
+        
+        _name(name)
+        
+        {
+            for (auto &shard : _shards) {
+                shard._value = 0;
+            }
+        }
+        
+        uint64_t Counter::value() const {
+            
+            uint64_t result = 0;
+            for (const auto &shard : _shards) {
+                result += shard._value.load(std::memory_order_relaxed);
+            }
+            
+            return result;
+        }
+        
+        const std::string& Counter::name() const {
+            return _name;
+        }
+        
+        // Gauge
+        
+        Gauge::Gauge(const std::string &name) :
+        
+        _name(name)
+        
+        {
+            for (auto &shard : _shards) {
+                shard._value = 0;
+            }
+        }
+        
+        void Gauge::set(int64_t value) {
+            
+            auto index = shardIndex();
+            
+            for (size_t shard = 0; shard < ShardCount; shard++) {
+                _shards[shard]._value.store(shard == index ? value : 0, std::memory_order_relaxed);
+            }
+        }
+        
+        int64_t Gauge::value() const {
+            
+            int64_t result = 0;
+            for (const auto &shard : _shards) {
+                result += shard._value.load(std::memory_order_relaxed);
+            }
+            
+            return result;
+        }
+        
+        const std::string& Gauge::name() const {
+            return _name;
+        }
+        
+        // Histogram
+        
+        Histogram::Histogram(const std::string &name) :
+        
+        _name(name)
+        
+        {
+            for (auto &shard : _shards) {
+                shard = nullptr;
+            }
+        }
+        
+        Histogram::~Histogram() {
+            for (auto &shard : _shards) {
+                delete shard.load();
+            }
+        }
+        
+        Histogram::Snapshot Histogram::snapshot() const {
+            
+            Snapshot result;
+            snapshot(result);
+            
+            return result;
+        }
+        
+        void Histogram::snapshot(Snapshot &result) const {
+            
+            result.reset();
+            
+            for (const auto &shard : _shards) {
+                
+                auto histogram = shard.load(std::memory_order_acquire);
+                if (histogram) {
+                    histogram->mergeInto(result);
+                }
+            }
+        }
+        
+        const std::string& Histogram::name() const {
+            return _name;
+        }
+        
+        ::coreKit::Histogram* Histogram::allocate() {
+            
+            // Note : Two threads sharing a shard may race, the loser frees its copy
+            
+            auto &shard = _shards[shardIndex()];
+            
+            std::unique_ptr<::coreKit::Histogram> histogram(new ::coreKit::Histogram());
+            
+            ::coreKit::Histogram *expected = nullptr;
+            if (shard.compare_exchange_strong(expected, histogram.get(), std::memory_order_acq_rel)) {
+                return histogram.release();
+            }
+            
+            return expected;
+        }
+        
+    }
+}
@@ -0,0 +1,212 @@
+//
+//  Metric.hpp
+//  coreKit
+//
+//
+
+#pragma once
+
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <coreKit/Utils/Histogram.hpp>
+
+namespace coreKit {
+    
+    namespace Metrics {
+        
+        // Declarations
+        
+        // Name (Joined with dots, must be izi compliant)
+        
+        using Name = std::vector<std::string>;
+        
+        // Number of shards per metric
+        
+        // Note : Each thread sticks to a shard, threads only share a shard
+        // (and its cache line) once there are more threads than shards
+        
+        static const size_t ShardCount = 16;
+        
+        // Shard of the calling thread
+        
+        size_t shardIndex();
+        
+        // Join and validate a name (Throws if not izi compliant)
+        
+        std::string convertName(const Name &name);
+        
+        // Counter (Monotonic, sharded)
+        
+        class Counter {
+        
+        public:
+            
+            // Declarations
+            
+            using Ptr = std::shared_ptr<Counter>;
+            
+            // Init
+            
+            Counter(const std::string &name);
+            
+            /* Non-copyable.*/
+            Counter(const Counter&) = delete;
+            Counter & operator=(const Counter&) = delete;
+            
+            // Update (Thread safe)
+            
+            void add(uint64_t value = 1) {
+                _shards[shardIndex()]._value.fetch_add(value, std::memory_order_relaxed);
+            }
+            
+            // Sum of all shards (Thread safe)
+            
+            uint64_t value() const;
+            
+            const std::string& name() const;
+        
+        private:
+            
+            // Shard (Padded to a cache line)
+            
+            struct Shard {
+                
+                std::atomic<uint64_t>   _value;
+                char                    _padding[64 - sizeof(std::atomic<uint64_t>)];
+                
+            };
+            
+            // Attributes
+            
+            const std::string _name;
+            
+            std::array<Shard, ShardCount> _shards;
+            
+        };
+        
+        // Gauge (Current level, sharded)
+        
+        class Gauge {
+        
+        public:
+            
+            // Declarations
+            
+            using Ptr = std::shared_ptr<Gauge>;
+            
+            // Init
+            
+            Gauge(const std::string &name);
+            
+            /* Non-copyable.*/
+            Gauge(const Gauge&) = delete;
+            Gauge & operator=(const Gauge&) = delete;
+            
+            // Update (Thread safe)
+            
+            void add(int64_t value) {
+                _shards[shardIndex()]._value.fetch_add(value, std::memory_order_relaxed);
+            }
+            
+            void sub(int64_t value) {
+                add(-value);
+            }
+            
+            // Override the level
+            
+            // Note : Meant for gauges with a single writer, concurrent updates may be lost
+            
+            void set(int64_t value);
+            
+            // Sum of all shards (Thread safe)
+            
+            int64_t value() const;
+            
+            const std::string& name() const;
+        
+        private:
+            
+            // Shard (Padded to a cache line)
+            
+            struct Shard {
+                
+                std::atomic<int64_t>    _value;
+                char                    _padding[64 - sizeof(std::atomic<int64_t>)];
+                
+            };
+            
+            // Attributes
+            
+            const std::string _name;
+            
+            std::array<Shard, ShardCount> _shards;
+            
+        };
+        
+        // Histogram (Log-linear buckets, sharded)
+        
+        // Note : Shards are allocated by the first thread recording into them,
+        // so memory grows with the number of recording threads only
+        
+        class Histogram {
+        
+        public:
+            
+            // Declarations
+            
+            using Ptr = std::shared_ptr<Histogram>;
+            using Snapshot = ::coreKit::Histogram::Snapshot;
+            
+            // Init
+            
+            Histogram(const std::string &name);
+            ~Histogram();
+            
+            /* Non-copyable.*/
+            Histogram(const Histogram&) = delete;
+            Histogram & operator=(const Histogram&) = delete;
+            
+            // Record a value (Thread safe)
+            
+            void record(uint64_t value) {
+                
+                auto shard = _shards[shardIndex()].load(std::memory_order_acquire);
+                if (!shard) {
+                    shard = allocate();
+                }
+                
+                shard->record(value);
+            }
+            
+            // Merge of all shards (Thread safe)
+            
+            Snapshot snapshot() const;
+            
+            // Same into a reused snapshot (Reset first, no allocation)
+            
+            void snapshot(Snapshot &result) const;
+            
+            const std::string& name() const;
+        
+        private:
+            
+            // Allocate the shard of the calling thread
+            
+            ::coreKit::Histogram* allocate();
+            
+            // Attributes
+            
+            const std::string _name;
+            
+            std::array<std::atomic<::coreKit::Histogram*>, ShardCount> _shards;
+            
+        };
+        
+    }
+}
@@ -0,0 +1,258 @@
+//
+//  MetricsService.cpp
+//  coreKit
+//
+//
+
+#include "MetricsService.hpp"
+
+#include <future>
+
+#include <coreKit/Config/Config.hpp>
+
+#include "Declarations.hpp"
+#include "Registry.hpp"
+
+// HTTP
+
+#define METRICS_MAX_REQUEST_SIZE    8192
+#define METRICS_PATH                "/metrics"
+#define METRICS_CONTENT_TYPE        "text/plain; version=0.0.4; charset=utf-8"
+
+static const coreKit::ConfigList configList({ "coreKit", "Metrics" }, {
+    
+    //                              | Name          | Description                                   | Default value
+    
+    coreKit::makeParam<std::string>("ServiceUri",   "Local URI of the metrics service (HTTP)",      std::string("tcp://127.0.0.1:9100"))
+    
+});
+
+namespace coreKit {
+    
+    namespace Metrics {
+        
+        // MetricsService
+        
+        MetricsService::MetricsService() :
+        
+        MetricsService(Config::get<std::string>("coreKit.Metrics.ServiceUri"))
+        
+        { }
+        
+        MetricsService::MetricsService(const std::string &localUri) :
+        
+        _localUri   (localUri),
+        _serverPtr  (nullptr),
+        _lastSize   (0)
+        
+        { }
+        
+        MetricsService::~MetricsService() { }
+        
+        Service::Info MetricsService::getInfo() {
+            return { "coreKit metrics", "1.0.0", { /* No dependency */ }, 0 /* No options */ };
+        }
+        
+        std::string MetricsService::getLocalUri() {
+            
+            std::lock_guard<std::mutex> lock(_mutex);
+            
+            if (!_serverPtr) {
+                return std::string();
+            }
+            
+            return _serverPtr->getLocalUri();
+        }
+        
+        void MetricsService::startService() {
+            
+            // Note : The server runs its own worker thread
+            
+            auto serverPtr = Stream::makeServer(_localUri);
+            
+            Stream::Server::Callbacks callbacks = {
+                
+                // OnDataReceived
+                [this](Stream::Server::SessionId sessionId, const void *data, size_t dataLength) {
+                    onData(sessionId, data, dataLength);
+                },
+                
+                // OnClosed
+                nullptr,
+                
+                // OnNewSession
+                nullptr,
+                
+                // OnSessionDisconnected (Forget its pending request)
+                [this](Stream::Server::SessionId sessionId, const std::exception_ptr) {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _requests.erase(sessionId);
+                },
+                
+                // Compression (Not available on raw sessions)
+                { Stream::Session::Codec::None, 0, false },
+                
+                // Framing (HTTP as is)
+                Stream::Session::Framing::Raw
+                
+            };
+            
+            std::promise<void> accepted;
+            
+            serverPtr->accept(callbacks, [&accepted](const std::exception_ptr error) {
+                if (error) {
+                    accepted.set_exception(error);
+                } else {
+                    accepted.set_value();
+                }
+            });
+            
+            // Note : Throws on failure (Invalid URI, address in use ...)
+            
+            accepted.get_future().get();
+            
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _serverPtr = serverPtr;
+            }
+            
+            _metricsLogger->info("Metrics service is listening on [{}]", serverPtr->getLocalUri());
+        }
+        
+        void MetricsService::stopService() noexcept(true) {
+            
+            std::shared_ptr<Stream::Server_Interface> serverPtr;
+            
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                std::swap(serverPtr, _serverPtr);
+                _requests.clear();
+            }
+            
+            if (!serverPtr) {
+                return;
+            }
+            
+            // Note : The lock is released, pending replies may still be rendered meanwhile
+            
+            std::promise<void> closed;
+            
+            serverPtr->close([&closed]() {
+                closed.set_value();
+            });
+            
+            closed.get_future().wait();
+        }
+        
+        void MetricsService::onData(Stream::Server::SessionId sessionId,
+                                    const void *data,
+                                    size_t dataLength) {
+            
+            // Note : Call by the server worker
+            
+            std::string requestLine;
+            bool tooLarge = false;
+            
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                
+                auto &request = _requests[sessionId];
+                request.append(static_cast<const char*>(data), dataLength);
+                
+                // Note : Only the request line matters, headers are skipped
+                
+                auto end = request.find("\r\n\r\n");
+                
+                if (end == std::string::npos) {
+                    
+                    if (request.size() <= METRICS_MAX_REQUEST_SIZE) {
+                        return;
+                    }
+                    
+                    tooLarge = true;
+                    
+                } else {
+                    requestLine = request.substr(0, request.find("\r\n"));
+                }
+                
+                _requests.erase(sessionId);
+            }
+            
+            reply(sessionId, requestLine, tooLarge);
+        }
+        
+        void MetricsService::reply(Stream::Server::SessionId sessionId,
+                                   const std::string &requestLine,
+                                   bool tooLarge) {
+            
+            // Note : Call by the server worker
+            
+            std::shared_ptr<Stream::Server_Interface> serverPtr;
+            size_t lastSize;
+            
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                
+                serverPtr = _serverPtr;
+                lastSize = _lastSize;
+            }
+            
+            if (!serverPtr) {
+                return;
+            }
+            
+            // Request line (Method, target and version)
+            
+            auto methodEnd = requestLine.find(' ');
+            auto targetEnd = (methodEnd != std::string::npos ? requestLine.find(' ', methodEnd + 1) : std::string::npos);
+            
+            std::string method = requestLine.substr(0, methodEnd);
+            std::string target = (targetEnd != std::string::npos ? requestLine.substr(methodEnd + 1, targetEnd - methodEnd - 1) : std::string());
+            
+            target = target.substr(0, target.find('?'));
+            
+            // Render in a single buffer, sized after the previous rendering
+            
+            auto body = std::make_shared<std::string>();
+            const char *status = "200 OK";
+            
+            if (tooLarge) {
+                status = "431 Request Header Fields Too Large";
+            } else if (targetEnd == std::string::npos) {
+                status = "400 Bad Request";
+            } else if (method != "GET") {
+                status = "405 Method Not Allowed";
+            } else if (target != METRICS_PATH) {
+                status = "404 Not Found";
+            } else {
+                
+                body->reserve(lastSize + lastSize / 4);
+                
+                Registry::toPrometheus(*body);
+                
+                std::lock_guard<std::mutex> lock(_mutex);
+                _lastSize = body->size();
+            }
+            
+            auto header = std::make_shared<std::string>();
+            
+            *header += "HTTP/1.1 ";
+            *header += status;
+            *header += "\r\nContent-Type: " METRICS_CONTENT_TYPE "\r\nContent-Length: ";
+            *header += std::to_string(body->size());
+            *header += "\r\nConnection: close\r\n\r\n";
+            
+            // Note : The connection is closed once the response is written
+            
+            Stream::Session::Buffers buffers(Stream::Session::ContainerType<Stream::Session::Buffer>( {
+                Stream::Session::Buffer(header->data(), header->size()),
+                Stream::Session::Buffer(body->data(), body->size())
+            }));
+            
+            serverPtr->send(sessionId, buffers, [serverPtr, sessionId, header, body](const std::exception_ptr) {
+                serverPtr->close(sessionId, nullptr);
+            });
+        }
+        
+    }
+}
@@ -0,0 +1,87 @@
+//
+//  MetricsService.hpp
+//  coreKit
+//
+//
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <coreKit/Service/Dependency.hpp>
+#include <coreKit/Service/Service.hpp>
+#include <coreKit/Stream/Server.hpp>
+
+namespace coreKit {
+    
+    namespace Metrics {
+        
+        // MetricsService (Serves the registry in Prometheus text format over HTTP)
+        
+        // Note : Answers "GET /metrics" on raw Stream sessions, each response closes its connection.
+        // The exposition is rendered by the service own worker thread, never by the instrumented strands.
+        
+        class MetricsService : public ServiceBase {
+        
+        public:
+            
+            // Init (URI from config, "coreKit.Metrics.ServiceUri")
+            
+            MetricsService();
+            
+            // Init (tcp:// or unix: URI)
+            
+            MetricsService(const std::string &localUri);
+            
+            virtual ~MetricsService();
+            
+            // Service info
+            
+            static Service::Info getInfo();
+            
+            // Get the local URI (Empty if not started)
+            
+            std::string getLocalUri();
+        
+        private:
+            
+            // Service handling
+            
+            void startService() override;
+            void stopService() noexcept(true) override;
+            
+            // Gather a request, answer it once complete
+            
+            void onData(Stream::Server::SessionId sessionId,
+                        const void *data,
+                        size_t dataLength);
+            
+            // Render the exposition if requested and send the response
+            
+            void reply(Stream::Server::SessionId sessionId,
+                       const std::string &requestLine,
+                       bool tooLarge);
+            
+            // Attributes
+            
+            const std::string _localUri;
+            
+            std::mutex _mutex;
+            
+            std::shared_ptr<Stream::Server_Interface> _serverPtr;
+            
+            // Request bytes received so far, per session
+            
+            std::map<Stream::Server::SessionId, std::string> _requests;
+            
+            // Size of the last rendering (Next buffer is reserved accordingly)
+            
+            size_t _lastSize;
+            
+        };
+        
+    }
+}
@@ -0,0 +1,148 @@
+//
+//  Registry.cpp
+//  coreKit
+//
+//
+
+#include "Registry.hpp"
+
+#include <chrono>
+#include <stdexcept>
+
+namespace coreKit {
+    
+    namespace Metrics {
+        
+        // Internal methods
+        
+        Registry::Registry() { }
+        
+        Counter::Ptr Registry::counter_internal(const std::string &name) {
+            
+            std::lock_guard<std::mutex> lock(_mutex);
+            
+            auto iterator = _counters.find(name);
+            if (iterator != _counters.end()) {
+                return iterator->second;
+            }
+            
+            checkName(name);
+            
+            auto counter = std::make_shared<Counter>(name);
+            _counters.insert(std::make_pair(name, counter));
+            
+            return counter;
+        }
+        
+        Gauge::Ptr Registry::gauge_internal(const std::string &name) {
+            
+            std::lock_guard<std::mutex> lock(_mutex);
+            
+            auto iterator = _gauges.find(name);
+            if (iterator != _gauges.end()) {
+                return iterator->second;
+            }
+            
+            checkName(name);
+            
+            auto gauge = std::make_shared<Gauge>(name);
+            _gauges.insert(std::make_pair(name, gauge));
+            
+            return gauge;
+        }
+        
+        Histogram::Ptr Registry::histogram_internal(const std::string &name) {
+            
+            std::lock_guard<std::mutex> lock(_mutex);
+            
+            auto iterator = _histograms.find(name);
+            if (iterator != _histograms.end()) {
+                return iterator->second;
+            }
+            
+            checkName(name);
+            
+            auto histogram = std::make_shared<Histogram>(name);
+            _histograms.insert(std::make_pair(name, histogram));
+            
+            return histogram;
+        }
+        
+        Snapshot Registry::snapshot_internal() {
+            
+            Snapshot result;
+            
+            result._time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+            
+            // Note : The lock only guards the maps, metrics are read without blocking writers
+            
+            std::lock_guard<std::mutex> lock(_mutex);
+            
+            for (const auto &counter : _counters) {
+                result._counters.insert(std::make_pair(counter.first, counter.second->value()));
+            }
+            
+            for (const auto &gauge : _gauges) {
+                result._gauges.insert(std::make_pair(gauge.first, gauge.second->value()));
+            }
+            
+            for (const auto &histogram : _histograms) {
+                result._histograms.insert(std::make_pair(histogram.first, histogram.second->snapshot()));
+            }
+            
+            return result;
+        }
+        
+        void Registry::toPrometheus_internal(std::string &result) {
+            
+            std::lock_guard<std::mutex> lock(_mutex);
+            
+            for (const auto &counter : _counters) {
+                Snapshot::appendCounter(result, counter.first, counter.second->value());
+            }
+            
+            for (const auto &gauge : _gauges) {
+                Snapshot::appendGauge(result, gauge.first, gauge.second->value());
+            }
+            
+            for (const auto &histogram : _histograms) {
+                histogram.second->snapshot(_histogramBuffer);
+                Snapshot::appendSummary(result, histogram.first, _histogramBuffer);
+            }
+        }
+        
+        void Registry::checkName(const std::string &name) const {
+            
+            // Note : (Must be) called with the lock held
+            
+            if (_counters.count(name) != 0 ||
+                _gauges.count(name) != 0 ||
+                _histograms.count(name) != 0) {
+                throw std::runtime_error("Metric name [" + name + "] is already used by another kind of metric");
+            }
+        }
+        
+        // Static methods
+        
+        Counter::Ptr Registry::counter(const Name &name) {
+            return getInstance()->counter_internal(convertName(name));
+        }
+        
+        Gauge::Ptr Registry::gauge(const Name &name) {
+            return getInstance()->gauge_internal(convertName(name));
+        }
+        
+        Histogram::Ptr Registry::histogram(const Name &name) {
+            return getInstance()->histogram_internal(convertName(name));
+        }
+        
+        Snapshot Registry::snapshot() {
+            return getInstance()->snapshot_internal();
+        }
+        
+        void Registry::toPrometheus(std::string &result) {
+            getInstance()->toPrometheus_internal(result);
+        }
+        
+    }
+}
@@ -0,0 +1,81 @@
+//
+//  Registry.hpp
+//  coreKit
+//
+//
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+
+#include <coreKit/Utils/Singleton.hpp>
+
+#include "Metric.hpp"
+#include "Snapshot.hpp"
+
+namespace coreKit {
+    
+    namespace Metrics {
+        
+        // Registry (Process wide metrics)
+        
+        // Note : Metrics are created on first request and live as long as the process,
+        // modules are expected to keep the returned pointers instead of looking them up on the hot path
+        
+        class Registry : private Singleton<Registry> {
+            
+            friend class Singleton<Registry>;
+        
+        public:
+            
+            // Create / Get metrics (Throws if the name is not izi compliant or already used by another kind)
+            
+            static Counter::Ptr counter(const Name &name);
+            static Gauge::Ptr gauge(const Name &name);
+            static Histogram::Ptr histogram(const Name &name);
+            
+            // Pull API (Thread safe, never blocks writers)
+            
+            static Snapshot snapshot();
+            
+            // Prometheus text exposition of the current values (Appended to result)
+            
+            // Note : Values are written while the metrics are read, no snapshot is copied.
+            // Histograms are merged into a single reused buffer, creating metrics waits meanwhile.
+            
+            static void toPrometheus(std::string &result);
+        
+        private:
+            
+            Registry();
+            
+            // Note : Non-copyable by design
+            
+            Counter::Ptr counter_internal(const std::string &name);
+            Gauge::Ptr gauge_internal(const std::string &name);
+            Histogram::Ptr histogram_internal(const std::string &name);
+            
+            Snapshot snapshot_internal();
+            
+            void toPrometheus_internal(std::string &result);
+            
+            void checkName(const std::string &name) const;
+            
+            // Attributes
+            
+            std::mutex _mutex;
+            
+            std::map<std::string, Counter::Ptr>     _counters;
+            std::map<std::string, Gauge::Ptr>       _gauges;
+            std::map<std::string, Histogram::Ptr>   _histograms;
+            
+            // Histogram merge buffer of the Prometheus exposition (Guarded by the lock)
+            
+            Histogram::Snapshot _histogramBuffer;
+            
+        };
+        
+    }
+}
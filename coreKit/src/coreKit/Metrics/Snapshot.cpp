@@ -0,0 +1,175 @@
+//
+//  Snapshot.cpp
+//  coreKit
+//
+//
+
+#include "Snapshot.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace coreKit {
+    
+    namespace Metrics {
+        
+        // Helpers
+        
+        static void appendName(std::string &result, const std::string &name) {
+            
+            // Note : Prometheus names are [a-zA-Z_:][a-zA-Z0-9_:]*
+            
+            for (size_t index = 0; index < name.size(); index++) {
+                
+                char c = name[index];
+                bool valid = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == ':' || (index != 0 && c >= '0' && c <= '9');
+                
+                result += (valid ? c : '_');
+            }
+        }
+        
+        static void appendValue(std::string &result, uint64_t value) {
+            
+            char buffer[24];
+            int length = snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(value));
+            result.append(buffer, length);
+        }
+        
+        static void appendValue(std::string &result, int64_t value) {
+            
+            char buffer[24];
+            int length = snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(value));
+            result.append(buffer, length);
+        }
+        
+        static void appendHeader(std::string &result, const std::string &name, const char *type) {
+            result += "# TYPE ";
+            appendName(result, name);
+            result += ' ';
+            result += type;
+            result += '\n';
+        }
+        
+        // Snapshot
+        
+        Snapshot::Snapshot() : _time(0) { }
+        
+        void Snapshot::merge(const Snapshot &other) {
+            
+            _time = std::max(_time, other._time);
+            
+            for (const auto &counter : other._counters) {
+                _counters[counter.first] += counter.second;
+            }
+            
+            for (const auto &gauge : other._gauges) {
+                _gauges[gauge.first] += gauge.second;
+            }
+            
+            for (const auto &histogram : other._histograms) {
+                _histograms[histogram.first].merge(histogram.second);
+            }
+        }
+        
+        std::string Snapshot::toString() const {
+            
+            std::string result;
+            
+            for (const auto &counter : _counters) {
+                result += "\n\t" + counter.first + " = " + std::to_string(counter.second);
+            }
+            
+            for (const auto &gauge : _gauges) {
+                result += "\n\t" + gauge.first + " = " + std::to_string(gauge.second);
+            }
+            
+            for (const auto &histogram : _histograms) {
+                
+                const auto &snapshot = histogram.second;
+                
+                result += "\n\t" + histogram.first + " = " + std::to_string(snapshot._count) + " samples";
+                
+                if (snapshot._count != 0) {
+                    result += ", " + std::to_string(snapshot.quantile(0.5)) + " median, "
+                    + std::to_string(snapshot.quantile(0.99)) + " p99, "
+                    + std::to_string(snapshot._max) + " max";
+                }
+            }
+            
+            if (result.empty()) {
+                result = "\n\t--- No metric ---";
+            }
+            
+            return result;
+        }
+        
+        
+        void Snapshot::toPrometheus(std::string &result) const {
+            
+            for (const auto &counter : _counters) {
+                appendCounter(result, counter.first, counter.second);
+            }
+            
+            for (const auto &gauge : _gauges) {
+                appendGauge(result, gauge.first, gauge.second);
+            }
+            
+            for (const auto &histogram : _histograms) {
+                appendSummary(result, histogram.first, histogram.second);
+            }
+        }
+        
+        void Snapshot::appendCounter(std::string &result, const std::string &name, uint64_t value) {
+            appendHeader(result, name, "counter");
+            appendName(result, name);
+            result += ' ';
+            appendValue(result, value);
+            result += '\n';
+        }
+        
+        void Snapshot::appendGauge(std::string &result, const std::string &name, int64_t value) {
+            appendHeader(result, name, "gauge");
+            appendName(result, name);
+            result += ' ';
+            appendValue(result, value);
+            result += '\n';
+        }
+        
+        void Snapshot::appendSummary(std::string &result, const std::string &name, const ::coreKit::Histogram::Snapshot &snapshot) {
+            
+            static const struct {
+                
+                double      _quantile;
+                const char *_label;
+                
+            } quantiles[] = {
+                { 0.5,  "0.5"  },
+                { 0.9,  "0.9"  },
+                { 0.99, "0.99" },
+                { 1,    "1"    }
+            };
+            
+            appendHeader(result, name, "summary");
+            
+            for (const auto &quantile : quantiles) {
+                appendName(result, name);
+                result += "{quantile=\"";
+                result += quantile._label;
+                result += "\"} ";
+                appendValue(result, snapshot.quantile(quantile._quantile));
+                result += '\n';
+            }
+            
+            appendName(result, name);
+            result += "_sum ";
+            appendValue(result, snapshot._sum);
+            result += '\n';
+            
+            appendName(result, name);
+            result += "_count ";
+            appendValue(result, snapshot._count);
+            result += '\n';
+        }
+        
+    }
+}
@@ -0,0 +1,63 @@
+//
+//  Snapshot.hpp
+//  coreKit
+//
+//
+
+#pragma once
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+
+#include <coreKit/Utils/Histogram.hpp>
+
+namespace coreKit {
+    
+    namespace Metrics {
+        
+        // Snapshot (Plain copy of metrics, indexed by name)
+        
+        struct Snapshot {
+            
+            // Methods
+            
+            Snapshot();
+            
+            // Add metrics of another snapshot
+            
+            // Note : Counters, gauges and histograms are summed,
+            // the latest time is kept
+            
+            void merge(const Snapshot &other);
+            
+            // To String (One metric per line)
+            
+            std::string toString() const;
+            
+            // Prometheus text exposition (Appended to result)
+            
+            // Note : Names get their dots replaced by underscores, histograms are exposed as summaries.
+            // Appending to a reused buffer avoids allocations once it is large enough.
+            
+            void toPrometheus(std::string &result) const;
+            
+            // Prometheus text of a single metric (Appended to result)
+            
+            static void appendCounter(std::string &result, const std::string &name, uint64_t value);
+            static void appendGauge(std::string &result, const std::string &name, int64_t value);
+            static void appendSummary(std::string &result, const std::string &name, const ::coreKit::Histogram::Snapshot &snapshot);
+            
+            // Attributes
+            
+            uint64_t _time;     // Capture time in microseconds since epoch
+            
+            std::map<std::string, uint64_t>                             _counters;
+            std::map<std::string, int64_t>                              _gauges;
+            std::map<std::string, ::coreKit::Histogram::Snapshot>       _histograms;
+            
+        };
+        
+    }
+}
@@ -0,0 +1,256 @@
+//
+//  Trace.cpp
+//  coreKit
+//
+//
+
+#include "Trace.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+
+static uint64_t steadyTime() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static size_t roundCapacity(size_t capacity) {
+    
+    size_t result = 2;
+    while (result < capacity) {
+        result <<= 1;
+    }
+    
+    return result;
+}
+
+static void writeTime(std::ostream &stream, uint64_t time) {
+    
+    // Note : Chrome expects microseconds, keep the nanoseconds as decimals
+    
+    char buffer[32];
+    int length = snprintf(buffer, sizeof(buffer), "%llu.%03u", static_cast<unsigned long long>(time / 1000), static_cast<unsigned>(time % 1000));
+    stream.write(buffer, length);
+}
+
+namespace coreKit {
+    
+    namespace Metrics {
+        
+        std::atomic<bool> Trace::_enabled(false);
+        
+        // Trace::Ring
+        
+        Trace::Ring::Ring(size_t capacity, uint32_t index) :
+        
+        _events (roundCapacity(capacity)),
+        _mask   (_events.size() - 1),
+        _index  (index),
+        _head   (0),
+        _tail   (0)
+        
+        { }
+        
+        void Trace::Ring::push(const Event &event) {
+            
+            // Note : Call by the owner thread
+            
+            auto head = _head.load(std::memory_order_relaxed);
+            
+            _events[head & _mask] = event;
+            _events[head & _mask]._thread = _index;
+            
+            _head.store(head + 1, std::memory_order_release);
+        }
+        
+        void Trace::Ring::drain(std::vector<Event> &events) {
+            
+            // Note : Call by the collector (With the lock held)
+            
+            auto capacity = _mask + 1;
+            auto head = _head.load(std::memory_order_acquire);
+            auto begin = std::max(_tail, head > capacity ? head - capacity : 0);
+            auto offset = events.size();
+            
+            for (auto index = begin; index < head; index++) {
+                events.push_back(_events[index & _mask]);
+            }
+            
+            // Drop the events the writer may have overwritten meanwhile
+            
+            std::atomic_thread_fence(std::memory_order_acquire);
+            auto after = _head.load(std::memory_order_relaxed);
+            
+            if (after >= begin + capacity) {
+                
+                auto overwritten = std::min<uint64_t>(after - capacity + 1 - begin, head - begin);
+                events.erase(events.begin() + offset, events.begin() + offset + overwritten);
+            }
+            
+            _tail = head;
+        }
+        
+        // Internal methods
+        
+        Trace::Trace() : _nextId(1), _capacity(16384) { }
+        
+        Trace::Ring* Trace::getRing() {
+            
+            static thread_local Ring *ring = nullptr;
+            
+            if (!ring) {
+                
+                std::lock_guard<std::mutex> lock(_mutex);
+                
+                auto ringPtr = std::make_shared<Ring>(_capacity.load(), static_cast<uint32_t>(_rings.size() + 1));
+                _rings.push_back(ringPtr);
+                
+                ring = ringPtr.get();
+            }
+            
+            return ring;
+        }
+        
+        std::vector<Trace::Event> Trace::collect_internal() {
+            
+            std::vector<Event> result;
+            
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                
+                for (const auto &ringPtr : _rings) {
+                    ringPtr->drain(result);
+                }
+            }
+            
+            std::stable_sort(result.begin(), result.end(), [](const Event &a, const Event &b) {
+                return a._time < b._time;
+            });
+            
+            return result;
+        }
+        
+        // Static methods
+        
+        void Trace::enable(size_t capacity) {
+            
+            if (capacity == 0) {
+                throw std::invalid_argument("Trace capacity must not be 0");
+            }
+            
+            getInstance()->_capacity = capacity;
+            _enabled = true;
+        }
+        
+        void Trace::disable() {
+            _enabled = false;
+        }
+        
+        uint64_t Trace::nextId() {
+            
+            if (!isEnabled()) {
+                return 0;
+            }
+            
+            return getInstance()->_nextId.fetch_add(1, std::memory_order_relaxed);
+        }
+        
+        void Trace::record_internal(const char *category, Stage stage, uint64_t id, uint32_t value) {
+            getInstance()->getRing()->push( { steadyTime(), id, category, value, 0, stage } );
+        }
+        
+        std::vector<Trace::Event> Trace::collect() {
+            return getInstance()->collect_internal();
+        }
+        
+        void Trace::toChromeTrace(const std::vector<Event> &events, std::ostream &stream) {
+            
+            // Note : Categories are static identifiers, they are not escaped
+            
+            auto pid = getpid();
+            bool first = true;
+            
+            auto separator = [&stream, &first]() {
+                stream << (first ? "\n" : ",\n");
+                first = false;
+            };
+            
+            stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+            
+            // Stages (Instant events, on the recording thread)
+            
+            for (const auto &event : events) {
+                
+                separator();
+                
+                stream << "{\"name\":\"" << getStageName(event._stage) << "\",\"cat\":\"" << event._category << "\",\"ph\":\"i\",\"s\":\"t\",\"ts\":";
+                writeTime(stream, event._time);
+                stream << ",\"pid\":" << pid << ",\"tid\":" << event._thread << ",\"args\":{\"id\":" << event._id << ",\"value\":" << event._value << "}}";
+            }
+            
+            // Spans between consecutive stages of a frame (Async events, one track per frame)
+            
+            std::map<std::pair<std::string, uint64_t>, const Event*> lastEvents;
+            
+            for (const auto &event : events) {
+                
+                if (event._id == 0) {
+                    continue;
+                }
+                
+                auto &last = lastEvents[std::make_pair(std::string(event._category), event._id)];
+                
+                if (last) {
+                    
+                    for (const auto *edge : { last, &event }) {
+                        
+                        separator();
+                        
+                        stream << "{\"name\":\"" << getStageName(last->_stage) << " > " << getStageName(event._stage) << "\",\"cat\":\"" << event._category << "\",\"ph\":\"" << (edge == last ? 'b' : 'e') << "\",\"id\":" << event._id << ",\"ts\":";
+                        writeTime(stream, edge->_time);
+                        stream << ",\"pid\":" << pid << ",\"tid\":" << edge->_thread << "}";
+                    }
+                }
+                
+                last = &event;
+            }
+            
+            stream << "\n]}\n";
+        }
+        
+        void Trace::save(const std::vector<Event> &events, const std::string &path) {
+            
+            std::ofstream file(path, std::ios::trunc);
+            if (!file) {
+                throw std::runtime_error("Unable to open trace [" + path + "]");
+            }
+            
+            toChromeTrace(events, file);
+            
+            if (!file.flush()) {
+                throw std::runtime_error("Unable to write trace [" + path + "]");
+            }
+        }
+        
+        const char* Trace::getStageName(Stage stage) {
+            
+            switch (stage) {
+                case Stage::Send:           return "Send";
+                case Stage::Enqueue:        return "Enqueue";
+                case Stage::Dequeue:        return "Dequeue";
+                case Stage::WriteStart:     return "WriteStart";
+                case Stage::WriteComplete:  return "WriteComplete";
+                case Stage::Ack:            return "Ack";
+                case Stage::Receive:        return "Receive";
+            }
+            
+            return "Unknown";
+        }
+        
+    }
+}
@@ -0,0 +1,152 @@
+//
+//  Trace.hpp
+//  coreKit
+//
+//
+
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <coreKit/Utils/Singleton.hpp>
+
+namespace coreKit {
+    
+    namespace Metrics {
+        
+        // Trace (Opt-in per frame latency tracing)
+        
+        // Note : Each thread records into its own ring (Single writer, no lock, oldest events are overwritten).
+        // Events sharing a category and an id describe the stages of a single frame,
+        // the Chrome export turns consecutive stages into spans ("chrome://tracing", Perfetto).
+        
+        class Trace : private Singleton<Trace> {
+            
+            friend class Singleton<Trace>;
+        
+        public:
+            
+            // Stages
+            
+            enum class Stage : uint8_t {
+                
+                Send,           // Send requested by the user (Before any strand hop)
+                Enqueue,        // Queued on the worker, waiting for the previous frame (or a window slot)
+                Dequeue,        // Taken from the queue
+                WriteStart,     // Handed to the socket (Once per transmission)
+                WriteComplete,  // Written by the socket
+                Ack,            // Acknowledged by the peer
+                Receive         // Read completed
+                
+            };
+            
+            // Event
+            
+            struct Event {
+                
+                uint64_t    _time;      // Steady time in nanoseconds
+                uint64_t    _id;        // Frame id (0 if not related to a frame)
+                const char  *_category; // Static string
+                uint32_t    _value;     // Stage dependent (Bytes, transmission count ...)
+                uint32_t    _thread;    // Ring index
+                Stage       _stage;
+                
+            };
+            
+            // Enable / Disable (Capacity in events per thread, rounded up to a power of 2)
+            
+            // Note : Rings are allocated on the first event of a thread and kept once allocated,
+            // a new capacity only applies to threads which did not record yet
+            
+            static void enable(size_t capacity = 16384);
+            static void disable();
+            
+            // Hot path
+            
+            static inline bool isEnabled() {
+                return _enabled.load(std::memory_order_relaxed);
+            }
+            
+            // Get a new frame id (0 if disabled)
+            
+            static uint64_t nextId();
+            
+            // Record an event (Ignored if disabled, events with id 0 are not part of any span)
+            
+            static inline void record(const char *category, Stage stage, uint64_t id, uint32_t value = 0) {
+                if (isEnabled()) {
+                    record_internal(category, stage, id, value);
+                }
+            }
+            
+            // Collect the events recorded since the last collection (Sorted by time)
+            
+            // Note : Events overwritten while collecting are dropped, writers are never blocked
+            
+            static std::vector<Event> collect();
+            
+            // Chrome trace export (JSON object format)
+            
+            static void toChromeTrace(const std::vector<Event> &events, std::ostream &stream);
+            static void save(const std::vector<Event> &events, const std::string &path);
+            
+            // Stage name
+            
+            static const char* getStageName(Stage stage);
+        
+        private:
+            
+            // Ring
+            
+            struct Ring {
+                
+                using Ptr = std::shared_ptr<Ring>;
+                
+                Ring(size_t capacity, uint32_t index);
+                
+                /* Non-copyable.*/
+                Ring(const Ring&) = delete;
+                Ring & operator=(const Ring&) = delete;
+                
+                void push(const Event &event);
+                void drain(std::vector<Event> &events);
+                
+                std::vector<Event>      _events;
+                const uint64_t          _mask;
+                const uint32_t          _index;
+                std::atomic<uint64_t>   _head;  // Written by the owner thread only
+                uint64_t                _tail;  // Written by the collector only (Under lock)
+                
+            };
+            
+            Trace();
+            
+            // Note : Non-copyable by design
+            
+            Ring* getRing();
+            
+            static void record_internal(const char *category, Stage stage, uint64_t id, uint32_t value);
+            
+            std::vector<Event> collect_internal();
+            
+            // Attributes
+            
+            static std::atomic<bool> _enabled;
+            
+            std::atomic<uint64_t> _nextId;
+            std::atomic<size_t> _capacity;
+            
+            std::mutex _mutex;
+            std::vector<Ring::Ptr> _rings;
+            
+        };
+        
+    }
+}
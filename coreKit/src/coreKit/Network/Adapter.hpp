@@ -35,6 +35,10 @@ namespace coreKit { namespace Network {
             
             OnOutgoingData      _onOutgoingData;
             
+            // Function to be called on unrecoverable incomming errors (Optional)
+            
+            OnReadError         _onReadError;
+            
         };
         
         // Initialize / Cancel
@@ -0,0 +1,18 @@
+//
+//  Declarations.cpp
+//  coreKit
+//
+//
+
+#include "Declarations.hpp"
+
+namespace coreKit {
+    
+    namespace Network {
+        
+        // Log
+        
+        Logger _networkLogger( { "coreKit", "Network" } );
+        
+    }
+}
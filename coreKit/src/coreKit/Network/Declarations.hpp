@@ -0,0 +1,20 @@
+//
+//  Declarations.hpp
+//  coreKit
+//
+//
+
+#pragma once
+
+#include <coreKit/Log/Logger.hpp>
+
+namespace coreKit {
+    
+    namespace Network {
+        
+        // Log
+        
+        extern Logger _networkLogger;
+        
+    }
+}
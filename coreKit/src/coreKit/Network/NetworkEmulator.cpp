@@ -7,21 +7,26 @@
 
 #include "NetworkEmulator.hpp"
 
-#include <cmath>
+#include "Declarations.hpp"
 
-#include <boost/asio/deadline_timer.hpp>
+#include <chrono>
+#include <cmath>
 
 namespace coreKit { namespace Network {
     
     // Network configs
     
+    // Note : { Drop, Latency, Bandwidth, Burst losses, Duplication, Reordering, Replay, Seed, Clock }
+    
     static std::map<NetworkType, NetworkEmulator::Config> networkConfigs = {
-        { NetworkType::Perfect  , { 0       , { 0       , 0     } } },
-        { NetworkType::Bad      , { 0.3     , { 100000  , 10000 } } },
-        { NetworkType::HSDPA_3G , { 0.15    , { 250000  , 25000 } } },
-        { NetworkType::Edge     , { 0.15    , { 300000  , 30000 } } },
-        { NetworkType::GPRS     , { 0.2     , { 500000  , 50000 } } },
-        { NetworkType::Wifi     , { 0.2     , { 40000   , 4000  } } }
+        { NetworkType::Perfect  , { 0       , { 0       , 0     }, { 0          , 0     , 0         }, { 0      , 0     , 0     }, 0    , { 0       , 0     }, { nullptr, false, 1 }, 0, nullptr } },
+        { NetworkType::Bad      , { 0.3     , { 100000  , 10000 }, { 0          , 0     , 0         }, { 0      , 0     , 0     }, 0    , { 0       , 0     }, { nullptr, false, 1 }, 0, nullptr } },
+        { NetworkType::HSDPA_3G , { 0.15    , { 250000  , 25000 }, { 0          , 0     , 0         }, { 0      , 0     , 0     }, 0    , { 0       , 0     }, { nullptr, false, 1 }, 0, nullptr } },
+        { NetworkType::Edge     , { 0.15    , { 300000  , 30000 }, { 0          , 0     , 0         }, { 0      , 0     , 0     }, 0    , { 0       , 0     }, { nullptr, false, 1 }, 0, nullptr } },
+        { NetworkType::GPRS     , { 0.2     , { 500000  , 50000 }, { 0          , 0     , 0         }, { 0      , 0     , 0     }, 0    , { 0       , 0     }, { nullptr, false, 1 }, 0, nullptr } },
+        { NetworkType::Wifi     , { 0.2     , { 40000   , 4000  }, { 0          , 0     , 0         }, { 0      , 0     , 0     }, 0    , { 0       , 0     }, { nullptr, false, 1 }, 0, nullptr } },
+        { NetworkType::LTE      , { 0.005   , { 40000   , 8000  }, { 20000000   , 15000 , 250000    }, { 0.005  , 0.3   , 0.5   }, 0.001, { 0.005   , 15000 }, { nullptr, false, 1 }, 0, nullptr } },
+        { NetworkType::Satellite, { 0.01    , { 300000  , 15000 }, { 5000000    , 30000 , 500000    }, { 0.002  , 0.05  , 0.8   }, 0    , { 0       , 0     }, { nullptr, false, 1 }, 0, nullptr } }
     };
     
     // NetworkEmulator
@@ -29,24 +34,55 @@ namespace coreKit { namespace Network {
     NetworkEmulator::NetworkEmulator(boost::asio::io_service &ioService,
                                      const Config &config) :
     
-    _strand     (ioService),
-    _config     (config),
-    _state      (Stopped)
+    NetworkEmulator(ioService, config, [&config]() {
+        
+        auto result = config;
+        if (result._seed != 0) {
+            result._seed++;
+        }
+        
+        return result;
+    }())
+    
+    { }
+    
+    NetworkEmulator::NetworkEmulator(boost::asio::io_service &ioService,
+                                     const Config &outgoingConfig,
+                                     const Config &incommingConfig) :
+    
+    _strand                 (ioService),
+    _clock                  (outgoingConfig._clock),
+    _state                  (Stopped),
+    _replayStart            (0),
+    _statsTimer             (ioService, outgoingConfig._clock),
+    _statsInterval          (0)
     
     {
-        if (config._dropRate < 0 ||
-            config._dropRate > 1) {
-            throw std::invalid_argument("Invalid drop rate");
+        if (outgoingConfig._clock != incommingConfig._clock) {
+            throw std::invalid_argument("Both directions must share the same clock");
         }
+        
+        initLink(Outgoing, outgoingConfig);
+        initLink(Incomming, incommingConfig);
     }
     
     NetworkEmulator::NetworkEmulator(boost::asio::io_service &ioService,
                                      NetworkType networkType) :
     
-    NetworkEmulator(ioService, networkConfigs[networkType])
+    NetworkEmulator(ioService, makeConfig(networkType))
     
     { }
     
+    NetworkEmulator::Config NetworkEmulator::makeConfig(NetworkType networkType) {
+        
+        auto iterator = networkConfigs.find(networkType);
+        if (iterator == networkConfigs.end()) {
+            throw std::invalid_argument("Invalid network type");
+        }
+        
+        return iterator->second;
+    }
+    
     void NetworkEmulator::init(const Adapter::Callbacks &callbacks) {
         
         auto ptr = shared_from_this();
@@ -62,6 +98,9 @@ namespace coreKit { namespace Network {
             // Save user callbacks
             ptr->_callbacks = callbacks;
             
+            // Trace replay starts now
+            ptr->_replayStart = ptr->now();
+            
             // Update state
             ptr->_state = Started;
             
@@ -84,12 +123,26 @@ namespace coreKit { namespace Network {
             return;
         }
         
-        // Cancel tasks
-        _disconnection_Signal();
+        // Flush delay lines
+        for (auto &link : _links) {
+            
+            link._timer->cancel();
+            link._armed = UINT64_MAX;
+            link._generation++;
+            
+            while (!link._pending.empty()) {
+                link._freeSlots.push_back(link._pending.top()._slot);
+                link._pending.pop();
+            }
+        }
         
         // Unereference user callbacks
         _callbacks = Callbacks();
         
+        // Stop statistics log
+        _statsInterval = 0;
+        _statsTimer.cancel();
+        
         // Update state
         _state = Stopped;
     }
@@ -129,118 +182,466 @@ namespace coreKit { namespace Network {
             return;
         }
         
-        // Should we drop the packet ?
+        // Note : Packets are copied before completion, the sender may then reuse its buffer
         
-        if (genDrop()) {
-            if (writeCallback) {
-                writeCallback(nullptr);
+        emulate(direction, buffer);
+        
+        if (writeCallback) {
+            writeCallback(nullptr);
+        }
+    }
+    
+    void NetworkEmulator::emulate(const Direction direction,
+                                  const Buffer &buffer) {
+        
+        // Note : (Must be) call by worker
+        
+        auto &link = _links[direction];
+        auto bufferSize = boost::asio::buffer_size(buffer);
+        
+        link._stats._packets++;
+        link._stats._bytes += bufferSize;
+        
+        // Packets trace records already include every impairment
+        
+        NetworkTrace::Packet packet;
+        if (replayPacket(link, packet)) {
+            if (!packet._drop) {
+                deliver(direction, buffer, std::llround(packet._latency * link._config._replay._timeScale));
+            } else {
+                link._stats._dropped++;
             }
             return;
         }
         
-        // Our task container
+        auto model = currentModel(link);
         
-        struct Task {
-            
-            Task(boost::asio::io_service &ioService) :
-            
-            _finished(false), _timer(ioService) { }
-            
-            void clean() {
-                
-                _timer.cancel();
-                _connections.clear();
-                
-            }
-            
-            // Attributes
+        // Wait for the bandwidth (Tail drop if the queue is full)
+        
+        uint64_t delay = 0;
+        if (!genQueueing(link, bufferSize, model._bandwidth, delay)) {
+            link._stats._queueDropped++;
+            return;
+        }
+        
+        // Should we drop the packet ?
+        
+        if (genDrop(link, model)) {
+            link._stats._dropped++;
+            return;
+        }
+        
+        // Held back packets are overtaken by the next ones
+        
+        uint64_t reorderDelay = 0;
+        if (genEvent(link, link._config._reorder._rate)) {
+            reorderDelay = link._config._reorder._delay;
+            link._stats._reordered++;
+        }
+        
+        deliver(direction, buffer, delay + reorderDelay + genLatency(link, model));
+        
+        // Duplicates take their own path
+        
+        if (genEvent(link, link._config._duplicateRate)) {
+            link._stats._duplicated++;
+            deliver(direction, buffer, delay + genLatency(link, model));
+        }
+    }
+    
+    void NetworkEmulator::deliver(const Direction direction,
+                                  const Buffer &buffer,
+                                  uint64_t delay) {
+        
+        // Note : (Must be) call by worker
+        
+        auto &link = _links[direction];
+        
+        link._stats._delay.recordExclusive(delay);
+        
+        // Copy buffer in a pooled slot
+        
+        uint32_t slot;
+        if (!link._freeSlots.empty()) {
+            slot = link._freeSlots.back();
+            link._freeSlots.pop_back();
+        } else {
+            slot = static_cast<uint32_t>(link._slots.size());
+            link._slots.emplace_back();
+        }
+        
+        auto bufferSize = boost::asio::buffer_size(buffer);
+        auto &data = link._slots[slot];
+        data.resize(bufferSize);
+        boost::asio::buffer_copy(boost::asio::buffer(data), buffer);
+        
+        if (delay == 0) {
             
-            bool _finished;
-            boost::asio::deadline_timer _timer;
-            std::vector<boost::signals2::scoped_connection> _connections;
+            // Process the packet immediately
             
-        };
+            release(direction, slot);
+            return;
+        }
+        
+        // Queue the packet, the timer only follows the earliest release
+        
+        auto releaseTime = now() + delay;
+        link._pending.push({ releaseTime, link._sequence++, slot });
+        
+        if (releaseTime < link._armed) {
+            arm(direction, releaseTime);
+        }
+    }
+    
+    void NetworkEmulator::arm(const Direction direction,
+                              uint64_t releaseTime) {
+        
+        // Note : (Must be) call by worker
+        
+        auto &link = _links[direction];
         
-        auto taskPtr = std::make_shared<Task>(_strand.get_io_service());
+        // Note : Rearming aborts the previous wait, the generation guards against late handlers
         
-        // Disconnection callback
+        link._armed = releaseTime;
+        auto generation = ++link._generation;
         
-        auto onDisconnection = [taskPtr]() {
+        auto time = now();
+        link._timer->expires_from_now(boost::posix_time::microseconds(releaseTime > time ? releaseTime - time : 0));
+        
+        auto ptr = shared_from_this();
+        link._timer->async_wait(_strand.wrap([ptr, direction, generation](const boost::system::error_code &error) {
             
             // Note : Call by worker
             
-            if (!taskPtr->_finished) {
+            auto &link = ptr->_links[direction];
+            
+            if (error || generation != link._generation || ptr->_state != Started) {
+                return;
+            }
+            
+            link._armed = UINT64_MAX;
+            
+            // Release every due packet
+            
+            auto time = ptr->now();
+            while (!link._pending.empty() && link._pending.top()._release <= time) {
                 
-                taskPtr->_finished = true;
-                taskPtr->clean();
+                auto slot = link._pending.top()._slot;
+                link._pending.pop();
+                
+                ptr->release(direction, slot);
+                
+                // Note : Forwarding may cancel us
+                
+                if (ptr->_state != Started) {
+                    return;
+                }
             }
+            
+            if (!link._pending.empty()) {
+                ptr->arm(direction, link._pending.top()._release);
+            }
+        }));
+    }
+    
+    void NetworkEmulator::release(const Direction direction,
+                                  uint32_t slot) {
+        
+        // Note : (Must be) call by worker
+        
+        auto &link = _links[direction];
+        
+        link._stats._delivered++;
+        
+        const auto &data = link._slots[slot];
+        auto buffer = Buffer(data.data(), data.size());
+        
+        // Note : The slot returns to the pool once written
+        
+        auto ptr = shared_from_this();
+        auto writeCallback = [ptr, direction, slot](const std::exception_ptr) {
+            ptr->_strand.dispatch([ptr, direction, slot]() {
+                ptr->_links[direction]._freeSlots.push_back(slot);
+            });
         };
         
-        // Subscribe disconnection callbacks
+        if (direction == Outgoing) {
+            _callbacks._onOutgoingData(buffer, writeCallback);
+        } else {
+            _callbacks._onIncommingMessage(buffer, writeCallback);
+        }
+    }
+    
+    void NetworkEmulator::initLink(const Direction direction,
+                                   const Config &config) {
         
-        taskPtr->_connections.push_back(_disconnection_Signal.connect(onDisconnection));
+        if (config._dropRate < 0 ||
+            config._dropRate > 1) {
+            throw std::invalid_argument("Invalid drop rate");
+        }
         
-        // Copy buffer
+        if (config._burstLoss._enterRate < 0 || config._burstLoss._enterRate > 1 ||
+            config._burstLoss._leaveRate < 0 || config._burstLoss._leaveRate > 1 ||
+            config._burstLoss._dropRate < 0 || config._burstLoss._dropRate > 1) {
+            throw std::invalid_argument("Invalid burst loss rates");
+        }
         
-        auto bufferSize = boost::asio::buffer_size(buffer);
-        const auto bufferCpy = std::shared_ptr<uint8_t>(new uint8_t[bufferSize], std::default_delete<uint8_t[]>());
-        boost::asio::buffer_copy(boost::asio::mutable_buffer(bufferCpy.get(), bufferSize), buffer);
+        if (config._duplicateRate < 0 ||
+            config._duplicateRate > 1) {
+            throw std::invalid_argument("Invalid duplicate rate");
+        }
         
-        if (writeCallback) {
-            writeCallback(nullptr);
+        if (config._reorder._rate < 0 ||
+            config._reorder._rate > 1) {
+            throw std::invalid_argument("Invalid reorder rate");
         }
         
-        // Timer callback
+        if (config._bandwidth._rate != 0 && config._bandwidth._burst == 0) {
+            throw std::invalid_argument("Invalid bandwidth burst");
+        }
+        
+        if (config._replay._trace && !(config._replay._timeScale > 0)) {
+            throw std::invalid_argument("Invalid replay time scale");
+        }
+        
+        auto &link = _links[direction];
+        
+        link._config = config;
+        
+        // Seed random generators
+        
+        if (config._seed != 0) {
+            link._randEngine.seed(config._seed);
+        } else {
+            std::random_device rd;
+            link._randEngine.seed((static_cast<uint64_t>(rd()) << 32) | rd());
+        }
+        
+        link._latencyDistribution = Distribution(static_cast<double>(config._latency._mean), static_cast<double>(std::max<uint64_t>(config._latency._stddev, 1)));
+        link._dropDistribution = std::bernoulli_distribution(config._dropRate);
+        link._eventDistribution = std::uniform_real_distribution<double>(0, 1);
+        
+        // Start with a full bucket, in the good state
+        
+        link._tokens = static_cast<double>(config._bandwidth._burst);
+        link._lastUpdate = 0;
+        link._bad = false;
+        link._traceIndex = 0;
+        
+        link._timer.reset(new Timer(_strand.get_io_service(), config._clock));
+        link._armed = UINT64_MAX;
+        link._generation = 0;
+        link._sequence = 0;
+    }
+    
+    NetworkEmulator::Stats NetworkEmulator::getStats() const {
+        return { getLinkStats(_links[Outgoing]), getLinkStats(_links[Incomming]) };
+    }
+    
+    NetworkEmulator::LinkStats NetworkEmulator::getLinkStats(const Link &link) const {
+        
+        const auto &stats = link._stats;
+        
+        return {
+            stats._packets,
+            stats._bytes,
+            stats._dropped,
+            stats._queueDropped,
+            stats._duplicated,
+            stats._reordered,
+            stats._delivered,
+            stats._delay.snapshot()
+        };
+    }
+    
+    void NetworkEmulator::logStats(uint64_t interval) {
+        
+        auto ptr = shared_from_this();
+        _strand.dispatch([ptr, interval]() {
+            
+            // Note : Call by worker
+            
+            ptr->_statsInterval = interval;
+            ptr->_statsTimer.cancel();
+            
+            if (interval != 0) {
+                ptr->armStatsTimer();
+            }
+        });
+    }
+    
+    void NetworkEmulator::armStatsTimer() {
+        
+        // Note : (Must be) call by worker
+        
+        _statsTimer.expires_from_now(boost::posix_time::microseconds(_statsInterval));
         
         auto ptr = shared_from_this();
-        auto timerCallback = [ptr, taskPtr, direction, bufferCpy, bufferSize](const boost::system::error_code &error) {
+        _statsTimer.async_wait(_strand.wrap([ptr](const boost::system::error_code &error) {
             
             // Note : Call by worker
             
-            if (!error && !taskPtr->_finished) {
-                
-                auto buffer = Buffer(bufferCpy.get(), bufferSize);
-                auto writeCallback = [bufferCpy](const std::exception_ptr) { };
+            if (error || ptr->_statsInterval == 0) {
+                return;
+            }
+            
+            auto stats = ptr->getStats();
+            
+            for (const auto &entry : { std::make_pair("outgoing", &stats._outgoing), std::make_pair("incomming", &stats._incomming) }) {
                 
-                if (direction == Outgoing) {
-                    ptr->_callbacks._onOutgoingData(buffer, writeCallback);
-                } else {
-                    ptr->_callbacks._onIncommingMessage(buffer, writeCallback);
-                }
+                const auto &linkStats = *entry.second;
                 
-                taskPtr->_finished = true;
-                taskPtr->clean();
+                _networkLogger->info("NetworkEmulator {} : {} packets ({} bytes), {} dropped, {} queue drops, {} duplicated, {} reordered, {} delivered, "
+                                     "delay {} us median / {} us p99 / {} us max",
+                                     entry.first,
+                                     linkStats._packets, linkStats._bytes,
+                                     linkStats._dropped, linkStats._queueDropped,
+                                     linkStats._duplicated, linkStats._reordered,
+                                     linkStats._delivered,
+                                     linkStats._delay.quantile(0.5), linkStats._delay.quantile(0.99), linkStats._delay._max);
             }
+            
+            ptr->armStatsTimer();
+        }));
+    }
+    
+    uint64_t NetworkEmulator::now() const {
+        
+        if (_clock) {
+            return _clock->now();
+        }
+        
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    
+    bool NetworkEmulator::replayPacket(Link &link,
+                                       NetworkTrace::Packet &packet) {
+        
+        // Note : (Must be) call by worker
+        
+        const auto &trace = link._config._replay._trace;
+        
+        if (!trace || trace->kind() != NetworkTrace::Kind::Packets) {
+            return false;
+        }
+        
+        const auto &packets = trace->packets();
+        
+        if (link._traceIndex == packets.size()) {
+            if (!link._config._replay._loop) {
+                return false;
+            }
+            link._traceIndex = 0;
+        }
+        
+        packet = packets[link._traceIndex++];
+        
+        return true;
+    }
+    
+    NetworkEmulator::Model NetworkEmulator::currentModel(const Link &link) const {
+        
+        // Note : (Must be) call by worker
+        
+        Model result = {
+            link._config._dropRate,
+            link._config._latency._mean,
+            link._config._latency._stddev,
+            link._config._bandwidth._rate
         };
         
-        if (_config._latency._mean == 0) {
-            
-            // Process the packet immediately
-            
-            timerCallback(boost::system::error_code());
+        const auto &replay = link._config._replay;
+        
+        if (!replay._trace || replay._trace->kind() != NetworkTrace::Kind::Parameters) {
+            return result;
+        }
+        
+        // Position in the trace timeline
+        
+        auto elapsed = now() - _replayStart;
+        auto time = static_cast<uint64_t>(elapsed / replay._timeScale);
+        auto duration = replay._trace->duration();
+        
+        if (time > duration) {
             
-        } else {
+            if (!replay._loop) {
+                return result;
+            }
             
-            // Start timer
+            // Note : When looping, the last record marks the end of the trace
             
-            taskPtr->_timer.expires_from_now(boost::posix_time::microseconds(genLatency()));
-            taskPtr->_timer.async_wait(_strand.wrap(timerCallback));
+            if (duration != 0) {
+                time %= duration;
+            }
         }
         
+        const auto &parameters = replay._trace->parametersAt(time);
+        
+        result._dropRate = parameters._dropRate;
+        result._latencyMean = std::llround(parameters._latency._mean * replay._timeScale);
+        result._latencyStddev = std::llround(parameters._latency._stddev * replay._timeScale);
+        result._bandwidth = parameters._bandwidth;
+        
+        return result;
+    }
+    
+    bool NetworkEmulator::genQueueing(Link &link,
+                                      size_t size,
+                                      uint64_t rate,
+                                      uint64_t &delay) {
+        
+        // Note : (Must be) call by worker
+        
+        const auto &bandwidth = link._config._bandwidth;
+        
+        if (rate == 0) {
+            delay = 0;
+            return true;
+        }
+        
+        // Refill the bucket
+        
+        auto time = now();
+        auto bytesPerMicrosecond = static_cast<double>(rate) / 8000000.0;
+        
+        if (time > link._lastUpdate) {
+            link._tokens = std::min<double>(link._tokens + (time - link._lastUpdate) * bytesPerMicrosecond, bandwidth._burst);
+            link._lastUpdate = time;
+        }
+        
+        // Tail drop
+        
+        auto queued = std::max<double>(-link._tokens, 0);
+        if (bandwidth._queue != 0 && queued + size > bandwidth._queue) {
+            return false;
+        }
+        
+        // The packet leaves once its bytes are paid for
+        
+        link._tokens -= size;
+        delay = (link._tokens < 0 ? static_cast<uint64_t>(std::ceil(-link._tokens / bytesPerMicrosecond)) : 0);
+        
+        return true;
     }
     
     // Random number generator
     
-    uint64_t NetworkEmulator::genLatency(const Distribution::param_type &params) {
+    uint64_t NetworkEmulator::genLatency(Link &link,
+                                         const Model &model) {
+        
+        // Note : (Must be) call by worker
+        
+        if (model._latencyStddev == 0) {
+            return model._latencyMean;
+        }
         
-        static std::random_device   rd;
-        static std::mt19937         gen(rd());
-        static Distribution         distribution(params);
+        auto parameters = Distribution::param_type(static_cast<double>(model._latencyMean),
+                                                   static_cast<double>(model._latencyStddev));
         
         int64_t result;
         while (true) {
-            result = std::round(distribution(gen));
-            if (result >= 0 && result <= 2 * params.mean()) {
+            result = std::round(link._latencyDistribution(link._randEngine, parameters));
+            if (result >= 0 && result <= 2 * parameters.mean()) {
                 break;
             }
         }
@@ -248,20 +649,37 @@ namespace coreKit { namespace Network {
         return result;
     }
     
-    uint64_t NetworkEmulator::genLatency() {
-        return genLatency(Distribution::param_type(_config._latency._mean, _config._latency._stddev));
-    }
-    
-    bool NetworkEmulator::genDrop(double dropRate) {
+    bool NetworkEmulator::genDrop(Link &link,
+                                  const Model &model) {
+        
+        // Note : (Must be) call by worker
         
-        static std::knuth_b randEngine;
+        const auto &burstLoss = link._config._burstLoss;
+        
+        if (burstLoss._enterRate != 0) {
+            
+            // Gilbert-Elliott transition, then drop according to the new state
+            
+            link._bad = (link._bad ? !genEvent(link, burstLoss._leaveRate) : genEvent(link, burstLoss._enterRate));
+            
+            if (link._bad) {
+                return genEvent(link, burstLoss._dropRate);
+            }
+        }
         
-        std::bernoulli_distribution distribution(dropRate);
-        return distribution(randEngine);
+        return link._dropDistribution(link._randEngine, std::bernoulli_distribution::param_type(model._dropRate));
     }
     
-    bool NetworkEmulator::genDrop() {
-        return genDrop(_config._dropRate);
+    bool NetworkEmulator::genEvent(Link &link,
+                                   double rate) {
+        
+        // Note : (Must be) call by worker
+        
+        if (rate <= 0) {
+            return false;
+        }
+        
+        return link._eventDistribution(link._randEngine) < rate;
     }
     
 } }
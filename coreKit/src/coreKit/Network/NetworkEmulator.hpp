@@ -9,14 +9,23 @@
 
 #include <stdint.h>
 
+#include <atomic>
+#include <deque>
 #include <memory>
+#include <queue>
 #include <random>
+#include <vector>
 
 #include <boost/asio/io_service.hpp>
 #include <boost/asio/strand.hpp>
-#include <boost/signals2/signal.hpp>
+
+#include <coreKit/Utils/Counter.hpp>
+#include <coreKit/Utils/Histogram.hpp>
 
 #include "Adapter.hpp"
+#include "NetworkTrace.hpp"
+#include "Timer.hpp"
+#include "VirtualClock.hpp"
 
 namespace coreKit { namespace Network {
     
@@ -31,7 +40,9 @@ namespace coreKit { namespace Network {
         HSDPA_3G    = 2,
         Edge        = 3,
         GPRS        = 4,
-        Wifi        = 5
+        Wifi        = 5,
+        LTE         = 6,
+        Satellite   = 7
     };
     
     // NetworkEmulator
@@ -59,13 +70,101 @@ namespace coreKit { namespace Network {
                 
             } _latency;
             
+            // Bandwidth (Token bucket, packets wait in a finite queue)
+            
+            struct {
+                
+                uint64_t    _rate;      // Bandwidth in bits per second (0 means unlimited)
+                size_t      _burst;     // Bucket depth in bytes
+                size_t      _queue;     // Queue size in bytes, tail drop when full (0 means unlimited)
+                
+            } _bandwidth;
+            
+            // Burst losses (Gilbert-Elliott, _dropRate applies to the good state)
+            
+            struct {
+                
+                double      _enterRate; // Good to bad transition rate in %1 (0 disables burst losses)
+                double      _leaveRate; // Bad to good transition rate in %1
+                double      _dropRate;  // Drop rate in the bad state in %1
+                
+            } _burstLoss;
+            
+            double          _duplicateRate; // Duplication rate in %1
+            
+            // Reordering (Some packets are held back and overtaken)
+            
+            struct {
+                
+                double      _rate;      // Reordering rate in %1
+                uint64_t    _delay;     // Extra latency in microseconds
+                
+            } _reorder;
+            
+            // Trace replay (Null disables it)
+            
+            // Note : A packets trace replaces every model above,
+            // a parameters trace overrides the drop rate, latency and bandwidth over time.
+            // Once the trace is over, the models above apply unless it loops.
+            
+            struct {
+                
+                NetworkTrace::Ptr _trace;
+                bool        _loop;      // Restart the trace once over
+                double      _timeScale; // Trace times and latencies multiplier (0.5 replays twice as fast)
+                
+            } _replay;
+            
+            // Random generators seed (0 picks a random one)
+            
+            uint64_t        _seed;
+            
+            // Virtual time source (Real time if null)
+            
+            VirtualClock::Ptr _clock;
+            
+        };
+        
+        // LinkStats (Statistics of a direction)
+        
+        struct LinkStats {
+            
+            uint64_t _packets;          // Packets handed to the emulator
+            uint64_t _bytes;            // Bytes handed to the emulator
+            uint64_t _dropped;          // Packets lost (Random, burst or trace losses)
+            uint64_t _queueDropped;     // Packets tail dropped by a full queue
+            uint64_t _duplicated;       // Packets sent twice
+            uint64_t _reordered;        // Packets held back
+            uint64_t _delivered;        // Packets forwarded (Duplicates included)
+            
+            Histogram::Snapshot _delay; // Time spent in the emulator in microseconds
+            
+        };
+        
+        // Stats
+        
+        struct Stats {
+            
+            LinkStats _outgoing;
+            LinkStats _incomming;
+            
         };
         
-        // Init
+        // Preset config for a network type
+        
+        static Config makeConfig(NetworkType networkType);
+        
+        // Init (Same config both ways, the incomming seed is derived from the outgoing one)
         
         NetworkEmulator(boost::asio::io_service &ioService,
                         const Config &config);
         
+        // Init (Asymmetric, both configs must share the same clock)
+        
+        NetworkEmulator(boost::asio::io_service &ioService,
+                        const Config &outgoingConfig,
+                        const Config &incommingConfig);
+        
         NetworkEmulator(boost::asio::io_service &ioService,
                         NetworkType networkType);
         
@@ -82,6 +181,16 @@ namespace coreKit { namespace Network {
         void handleOutgoingData(const Buffer &buffer,
                                 const WriteCallback &writeCallback) override;
         
+        // Statistics (Thread safe)
+        
+        Stats getStats() const;
+        
+        // Log statistics every interval microseconds (0 stops it)
+        
+        // Note : On a virtual clock, the periodic log keeps the clock running until stopped
+        
+        void logStats(uint64_t interval);
+        
     private:
         
         // Private declations
@@ -102,6 +211,24 @@ namespace coreKit { namespace Network {
             
         };
         
+        // Pending (Packet waiting in a delay line)
+        
+        struct Pending {
+            
+            // Attributes
+            
+            uint64_t    _release;   // Release time in microseconds
+            uint64_t    _sequence;  // Insertion order (Ties keep FIFO order)
+            uint32_t    _slot;      // Buffer slot
+            
+            // Min heap ordering
+            
+            bool operator<(const Pending &other) const {
+                return (_release != other._release ? _release > other._release : _sequence > other._sequence);
+            }
+            
+        };
+        
         // State
         
         enum State {
@@ -120,8 +247,97 @@ namespace coreKit { namespace Network {
             
         };
         
+        // Link (State of a direction)
+        
+        struct Link {
+            
+            // Attributes
+            
+            // Our config
+            
+            Config      _config;
+            
+            // Random generators (Seeded from config)
+            
+            std::mt19937_64                         _randEngine;
+            Distribution                            _latencyDistribution;
+            std::bernoulli_distribution             _dropDistribution;
+            std::uniform_real_distribution<double>  _eventDistribution;
+            
+            // Token bucket (Negative tokens are queued bytes)
+            
+            double      _tokens;
+            uint64_t    _lastUpdate;
+            
+            // Gilbert-Elliott state
+            
+            bool        _bad;
+            
+            // Next record of a packets trace
+            
+            size_t      _traceIndex;
+            
+            // Delay line (One timer armed for the earliest release)
+            
+            std::priority_queue<Pending>    _pending;
+            std::unique_ptr<Timer>          _timer;
+            uint64_t                        _armed;         // Armed release time (UINT64_MAX when idle)
+            uint64_t                        _generation;    // Guards against stale timer handlers
+            uint64_t                        _sequence;
+            
+            // Buffers pool (Stable addresses, slots are reused once written)
+            
+            std::deque<std::vector<uint8_t>>    _slots;
+            std::vector<uint32_t>               _freeSlots;
+            
+            // Statistics (Written by worker only)
+            
+            struct {
+                
+                Counter _packets;
+                Counter _bytes;
+                Counter _dropped;
+                Counter _queueDropped;
+                Counter _duplicated;
+                Counter _reordered;
+                Counter _delivered;
+                
+                Histogram _delay;
+                
+            } _stats;
+            
+        };
+        
+        // Model (Link parameters applied to a packet)
+        
+        struct Model {
+            
+            // Attributes
+            
+            double      _dropRate;
+            uint64_t    _latencyMean;
+            uint64_t    _latencyStddev;
+            uint64_t    _bandwidth;
+            
+        };
+        
         // Private methods
         
+        // Setup a direction
+        
+        void initLink(Direction direction,
+                      const Config &config);
+        
+        // Statistics helpers
+        
+        LinkStats getLinkStats(const Link &link) const;
+        
+        void armStatsTimer();
+        
+        // Current time in microseconds (Virtual if a clock is set)
+        
+        uint64_t now() const;
+        
         // Disconnection handling
         
         void disconnect();
@@ -132,19 +348,63 @@ namespace coreKit { namespace Network {
                         const Buffer &buffer,
                         const WriteCallback &writeCallback);
         
+        // Apply impairments to a packet
+        
+        void emulate(Direction direction,
+                     const Buffer &buffer);
+        
+        // Delay line
+        
+        // Copy the packet, then forward it after delay
+        
+        void deliver(Direction direction,
+                     const Buffer &buffer,
+                     uint64_t delay);
+        
+        // Arm the delay line timer
+        
+        void arm(Direction direction,
+                 uint64_t releaseTime);
+        
+        // Forward a packet
+        
+        void release(Direction direction,
+                     uint32_t slot);
+        
+        // Trace replay
+        
+        // Next record of a packets trace (Returns false once over)
+        
+        bool replayPacket(Link &link,
+                          NetworkTrace::Packet &packet);
+        
+        // Current model (From config or from a parameters trace)
+        
+        Model currentModel(const Link &link) const;
+        
+        // Queueing delay in microseconds (Returns false on tail drop)
+        
+        bool genQueueing(Link &link,
+                         size_t size,
+                         uint64_t bandwidth,
+                         uint64_t &delay);
+        
         // Random number generator
         
         // Latency generator
         
-        static uint64_t genLatency(const Distribution::param_type &params);
-        
-        uint64_t genLatency();
+        uint64_t genLatency(Link &link,
+                            const Model &model);
         
         // Drop generator
         
-        static bool genDrop(double dropRate);
+        bool genDrop(Link &link,
+                     const Model &model);
+        
+        // Event generator
         
-        bool genDrop();
+        bool genEvent(Link &link,
+                      double rate);
         
         // Attributes
         
@@ -152,9 +412,9 @@ namespace coreKit { namespace Network {
         
         boost::asio::strand _strand;
         
-        // Our config
+        // Time source (Real time if null)
         
-        const Config _config;
+        const VirtualClock::Ptr _clock;
         
         // Active state
         
@@ -164,10 +424,18 @@ namespace coreKit { namespace Network {
         
         Adapter::Callbacks _callbacks;
         
-        // Disconnection handling
+        // Links (Indexed by direction)
+        
+        Link _links[2];
+        
+        // Trace replay start time
+        
+        uint64_t _replayStart;
+        
+        // Periodic statistics log
         
-        boost::signals2::signal<void()>     _disconnection_Signal;
-        boost::signals2::scoped_connection  _onDisonnection_Connection;
+        Timer _statsTimer;
+        uint64_t _statsInterval;
         
     };
     
@@ -0,0 +1,375 @@
+//
+//  NetworkTrace.cpp
+//  coreKit
+//
+//
+
+#include "NetworkTrace.hpp"
+
+#include <arpa/inet.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+// Binary format (Big endian)
+//
+// Header     : "NTRC" | u8 version | u8 kind | u16 reserved | u32 count
+// Packet     : u32 (Drop flag in the high bit, latency in the 31 low bits)
+// Parameters : u64 time | u32 drop rate (Parts per billion) | u32 latency mean | u32 latency stddev | u64 bandwidth
+
+#define NTRC_MAGIC              "NTRC"
+#define NTRC_MAGIC_SIZE         4
+#define NTRC_VERSION            1
+#define NTRC_DROP_FLAG          0x80000000u
+#define NTRC_RATE_SCALE         1000000000.0
+
+namespace coreKit { namespace Network {
+    
+    namespace {
+        
+        // Binary helpers
+        
+        void write32(std::ostream &stream, uint32_t value) {
+            value = htonl(value);
+            stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+        
+        void write64(std::ostream &stream, uint64_t value) {
+            write32(stream, static_cast<uint32_t>(value >> 32));
+            write32(stream, static_cast<uint32_t>(value));
+        }
+        
+        uint32_t read32(std::istream &stream) {
+            uint32_t value;
+            if (!stream.read(reinterpret_cast<char*>(&value), sizeof(value))) {
+                throw std::runtime_error("Truncated network trace");
+            }
+            return ntohl(value);
+        }
+        
+        uint64_t read64(std::istream &stream) {
+            uint64_t high = read32(stream);
+            return (high << 32) | read32(stream);
+        }
+        
+        // CSV helpers
+        
+        std::vector<std::string> splitLine(const std::string &line) {
+            
+            std::vector<std::string> result;
+            std::stringstream stream(line);
+            std::string field;
+            
+            while (std::getline(stream, field, ',')) {
+                
+                // Trim spaces
+                field.erase(0, field.find_first_not_of(" \t\r"));
+                field.erase(field.find_last_not_of(" \t\r") + 1);
+                
+                result.push_back(field);
+            }
+            
+            return result;
+        }
+        
+        uint64_t toUnsigned(const std::string &field, size_t line) {
+            try {
+                size_t end;
+                auto value = std::stoull(field, &end);
+                if (end == field.size() && field.find('-') == std::string::npos) {
+                    return value;
+                }
+            } catch (const std::exception&) { }
+            
+            throw std::runtime_error("Invalid network trace value [" + field + "] at line " + std::to_string(line));
+        }
+        
+        double toRate(const std::string &field, size_t line) {
+            try {
+                size_t end;
+                auto value = std::stod(field, &end);
+                if (end == field.size() && value >= 0 && value <= 1) {
+                    return value;
+                }
+            } catch (const std::exception&) { }
+            
+            throw std::runtime_error("Invalid network trace rate [" + field + "] at line " + std::to_string(line));
+        }
+        
+    }
+    
+    // NetworkTrace
+    
+    NetworkTrace::NetworkTrace(const std::vector<Packet> &packets) :
+    
+    _kind       (Kind::Packets),
+    _packets    (packets)
+    
+    {
+        if (_packets.empty()) {
+            throw std::invalid_argument("Empty network trace");
+        }
+        
+        for (const auto &packet : _packets) {
+            if (packet._latency & NTRC_DROP_FLAG) {
+                throw std::invalid_argument("Invalid network trace latency");
+            }
+        }
+    }
+    
+    NetworkTrace::NetworkTrace(const std::vector<Parameters> &parameters) :
+    
+    _kind       (Kind::Parameters),
+    _parameters (parameters)
+    
+    {
+        if (_parameters.empty()) {
+            throw std::invalid_argument("Empty network trace");
+        }
+        
+        for (size_t index = 0; index < _parameters.size(); index++) {
+            
+            const auto &record = _parameters[index];
+            
+            if (index != 0 && record._time <= _parameters[index - 1]._time) {
+                throw std::invalid_argument("Network trace times must be increasing");
+            }
+            
+            if (record._dropRate < 0 || record._dropRate > 1) {
+                throw std::invalid_argument("Invalid network trace drop rate");
+            }
+            
+            if (record._latency._mean > UINT32_MAX || record._latency._stddev > UINT32_MAX) {
+                throw std::invalid_argument("Invalid network trace latency");
+            }
+        }
+    }
+    
+    NetworkTrace::Ptr NetworkTrace::load(const std::string &path) {
+        
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("Unable to open network trace [" + path + "]");
+        }
+        
+        // Binary traces start with a magic
+        
+        char magic[NTRC_MAGIC_SIZE] = { 0 };
+        file.read(magic, sizeof(magic));
+        
+        file.clear();
+        file.seekg(0);
+        
+        if (memcmp(magic, NTRC_MAGIC, NTRC_MAGIC_SIZE) == 0) {
+            return loadBinary(file);
+        }
+        
+        return loadCsv(file);
+    }
+    
+    NetworkTrace::Ptr NetworkTrace::loadCsv(std::istream &stream) {
+        
+        std::vector<Packet> packets;
+        std::vector<Parameters> parameters;
+        
+        bool hasHeader = false;
+        Kind kind = Kind::Packets;
+        
+        std::string line;
+        size_t lineNumber = 0;
+        
+        while (std::getline(stream, line)) {
+            
+            lineNumber++;
+            
+            auto fields = splitLine(line);
+            
+            // Skip empty lines and comments
+            if (fields.empty() || fields[0].empty() || fields[0][0] == '#') {
+                continue;
+            }
+            
+            // The header tells the trace kind
+            if (!hasHeader) {
+                
+                if (fields == std::vector<std::string>({ "latency", "drop" })) {
+                    kind = Kind::Packets;
+                } else if (fields == std::vector<std::string>({ "time", "drop", "latency", "stddev", "bandwidth" })) {
+                    kind = Kind::Parameters;
+                } else {
+                    throw std::runtime_error("Invalid network trace header at line " + std::to_string(lineNumber));
+                }
+                
+                hasHeader = true;
+                continue;
+            }
+            
+            if (kind == Kind::Packets) {
+                
+                if (fields.size() != 2) {
+                    throw std::runtime_error("Invalid network trace record at line " + std::to_string(lineNumber));
+                }
+                
+                auto latency = toUnsigned(fields[0], lineNumber);
+                auto drop = toUnsigned(fields[1], lineNumber);
+                
+                if (latency >= NTRC_DROP_FLAG || drop > 1) {
+                    throw std::runtime_error("Invalid network trace record at line " + std::to_string(lineNumber));
+                }
+                
+                packets.push_back({ static_cast<uint32_t>(latency), drop != 0 });
+                
+            } else {
+                
+                if (fields.size() != 5) {
+                    throw std::runtime_error("Invalid network trace record at line " + std::to_string(lineNumber));
+                }
+                
+                parameters.push_back({
+                    toUnsigned(fields[0], lineNumber),
+                    toRate(fields[1], lineNumber),
+                    { toUnsigned(fields[2], lineNumber), toUnsigned(fields[3], lineNumber) },
+                    toUnsigned(fields[4], lineNumber)
+                });
+            }
+        }
+        
+        if (kind == Kind::Packets) {
+            return std::make_shared<NetworkTrace>(packets);
+        }
+        
+        return std::make_shared<NetworkTrace>(parameters);
+    }
+    
+    NetworkTrace::Ptr NetworkTrace::loadBinary(std::istream &stream) {
+        
+        char magic[NTRC_MAGIC_SIZE];
+        if (!stream.read(magic, sizeof(magic)) || memcmp(magic, NTRC_MAGIC, NTRC_MAGIC_SIZE) != 0) {
+            throw std::runtime_error("Invalid network trace magic");
+        }
+        
+        auto header = read32(stream);
+        auto version = header >> 24;
+        auto kind = (header >> 16) & 0xFF;
+        auto count = read32(stream);
+        
+        if (version != NTRC_VERSION) {
+            throw std::runtime_error("Unsupported network trace version (" + std::to_string(version) + ")");
+        }
+        
+        if (kind == static_cast<uint32_t>(Kind::Packets)) {
+            
+            // Note : Count is not trusted until records are read
+            
+            std::vector<Packet> packets;
+            packets.reserve(std::min<uint32_t>(count, 1 << 20));
+            
+            for (uint32_t index = 0; index < count; index++) {
+                auto record = read32(stream);
+                packets.push_back({ record & ~NTRC_DROP_FLAG, (record & NTRC_DROP_FLAG) != 0 });
+            }
+            
+            return std::make_shared<NetworkTrace>(packets);
+        }
+        
+        if (kind == static_cast<uint32_t>(Kind::Parameters)) {
+            
+            std::vector<Parameters> parameters;
+            parameters.reserve(std::min<uint32_t>(count, 1 << 20));
+            
+            for (uint32_t index = 0; index < count; index++) {
+                
+                Parameters record;
+                record._time = read64(stream);
+                record._dropRate = read32(stream) / NTRC_RATE_SCALE;
+                record._latency._mean = read32(stream);
+                record._latency._stddev = read32(stream);
+                record._bandwidth = read64(stream);
+                
+                parameters.push_back(record);
+            }
+            
+            return std::make_shared<NetworkTrace>(parameters);
+        }
+        
+        throw std::runtime_error("Invalid network trace kind (" + std::to_string(kind) + ")");
+    }
+    
+    void NetworkTrace::save(const std::string &path) const {
+        
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            throw std::runtime_error("Unable to open network trace [" + path + "]");
+        }
+        
+        saveBinary(file);
+        
+        if (!file.flush()) {
+            throw std::runtime_error("Unable to write network trace [" + path + "]");
+        }
+    }
+    
+    void NetworkTrace::saveBinary(std::ostream &stream) const {
+        
+        auto count = (_kind == Kind::Packets ? _packets.size() : _parameters.size());
+        if (count > UINT32_MAX) {
+            throw std::runtime_error("Network trace is too large");
+        }
+        
+        stream.write(NTRC_MAGIC, NTRC_MAGIC_SIZE);
+        write32(stream, (NTRC_VERSION << 24) | (static_cast<uint32_t>(_kind) << 16));
+        write32(stream, static_cast<uint32_t>(count));
+        
+        for (const auto &packet : _packets) {
+            write32(stream, packet._latency | (packet._drop ? NTRC_DROP_FLAG : 0));
+        }
+        
+        for (const auto &record : _parameters) {
+            write64(stream, record._time);
+            write32(stream, static_cast<uint32_t>(std::round(record._dropRate * NTRC_RATE_SCALE)));
+            write32(stream, static_cast<uint32_t>(record._latency._mean));
+            write32(stream, static_cast<uint32_t>(record._latency._stddev));
+            write64(stream, record._bandwidth);
+        }
+    }
+    
+    NetworkTrace::Kind NetworkTrace::kind() const {
+        return _kind;
+    }
+    
+    const std::vector<NetworkTrace::Packet>& NetworkTrace::packets() const {
+        return _packets;
+    }
+    
+    const std::vector<NetworkTrace::Parameters>& NetworkTrace::parameters() const {
+        return _parameters;
+    }
+    
+    uint64_t NetworkTrace::duration() const {
+        return (_parameters.empty() ? 0 : _parameters.back()._time);
+    }
+    
+    const NetworkTrace::Parameters& NetworkTrace::parametersAt(uint64_t time) const {
+        
+        if (_parameters.empty()) {
+            throw std::runtime_error("Not a parameters trace");
+        }
+        
+        // Last record starting at or before time (The first one applies before it starts)
+        
+        auto iterator = std::upper_bound(_parameters.begin(), _parameters.end(), time, [](uint64_t time, const Parameters &record) {
+            return time < record._time;
+        });
+        
+        if (iterator == _parameters.begin()) {
+            return *iterator;
+        }
+        
+        return *(iterator - 1);
+    }
+    
+} }
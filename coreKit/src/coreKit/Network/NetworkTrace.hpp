@@ -0,0 +1,121 @@
+//
+//  NetworkTrace.hpp
+//  coreKit
+//
+//
+
+#pragma once
+
+#include <stdint.h>
+
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace coreKit { namespace Network {
+    
+    // NetworkTrace (Recorded link conditions, replayed by NetworkEmulator)
+    
+    // Note : A trace holds either one record per packet (Latency and drop decision),
+    // or link parameters changing over time. Both load from CSV or from a compact binary file.
+    //
+    // CSV packets trace :              CSV parameters trace :
+    //   latency,drop                     time,drop,latency,stddev,bandwidth
+    //   42000,0                          0,0.01,40000,5000,20000000
+    //   0,1                              5000000,0.2,250000,25000,1000000
+    //
+    // Times and latencies are in microseconds, bandwidth in bits per second (0 means unlimited)
+    
+    class NetworkTrace {
+    
+    public:
+        
+        // Declarations
+        
+        using Ptr = std::shared_ptr<NetworkTrace>;
+        
+        // Kind
+        
+        enum class Kind {
+            
+            Packets     = 0,
+            Parameters  = 1
+            
+        };
+        
+        // Packet (Record for a single packet)
+        
+        struct Packet {
+            
+            // Attributes
+            
+            uint32_t    _latency;   // Latency in microseconds
+            bool        _drop;      // Should the packet be dropped
+            
+        };
+        
+        // Parameters (Link parameters from _time until the next record)
+        
+        struct Parameters {
+            
+            // Attributes
+            
+            uint64_t    _time;      // Start time in microseconds
+            double      _dropRate;  // Drop rate in %1
+            
+            struct {
+                
+                uint64_t    _mean;      // Average latency in microseconds
+                uint64_t    _stddev;    // Standard deviation in microseconds
+                
+            } _latency;
+            
+            uint64_t    _bandwidth; // Bandwidth in bits per second (0 means unlimited)
+            
+        };
+        
+        // Init
+        
+        NetworkTrace(const std::vector<Packet> &packets);
+        NetworkTrace(const std::vector<Parameters> &parameters);
+        
+        // Loading (Format is detected from the file content)
+        
+        static Ptr load(const std::string &path);
+        
+        static Ptr loadCsv(std::istream &stream);
+        static Ptr loadBinary(std::istream &stream);
+        
+        // Saving (Binary format)
+        
+        void save(const std::string &path) const;
+        void saveBinary(std::ostream &stream) const;
+        
+        // Accessors
+        
+        Kind kind() const;
+        
+        const std::vector<Packet>& packets() const;
+        const std::vector<Parameters>& parameters() const;
+        
+        // Time of the last parameters record
+        
+        uint64_t duration() const;
+        
+        // Parameters in use at the given time
+        
+        const Parameters& parametersAt(uint64_t time) const;
+    
+    private:
+        
+        // Attributes
+        
+        Kind _kind;
+        
+        std::vector<Packet> _packets;
+        std::vector<Parameters> _parameters;
+        
+    };
+    
+} }
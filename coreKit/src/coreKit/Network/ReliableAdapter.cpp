@@ -7,7 +7,10 @@
 
 #include "ReliableAdapter.hpp"
 
-#include <boost/asio/deadline_timer.hpp>
+#include "Declarations.hpp"
+
+#include <coreKit/Metrics/Registry.hpp>
+#include <coreKit/Metrics/Trace.hpp>
 
 // iTC Protocol defines
 
@@ -16,6 +19,12 @@
 #define ITC_HEADER_PAYLOAD_TYPE_OFFSET      0
 #define ITC_HEADER_PAYLOAD_TYPE_SIZE        sizeof(uint8_t)
 
+// Note : The lane is carried by the upper bits of the payload type
+
+#define ITC_HEADER_PAYLOAD_TYPE_MASK        0x0F
+#define ITC_HEADER_LANE_SHIFT               4
+#define ITC_HEADER_LANE_COUNT               (1 << (8 * ITC_HEADER_PAYLOAD_TYPE_SIZE - ITC_HEADER_LANE_SHIFT))
+
 #define ITC_HEADER_MESSAGE_ID_OFFSET        ITC_HEADER_PAYLOAD_TYPE_SIZE
 #define ITC_HEADER_MESSAGE_ID_SIZE          sizeof(uint32_t)
 
@@ -43,10 +52,72 @@
 #define ITC_PAYLOAD_MESSAGE_BODY_OFFSET     ITC_PAYLOAD_MESSAGE_COUNT_SIZE
 #define ITC_PAYLOAD_MESSAGE_MINIMAL_SIZE    ITC_PAYLOAD_MESSAGE_COUNT_SIZE
 
+// Fragment
+
+#define ITC_PAYLOAD_FRAGMENT_COUNT_OFFSET       0
+#define ITC_PAYLOAD_FRAGMENT_COUNT_SIZE         sizeof(uint8_t)
+
+#define ITC_PAYLOAD_FRAGMENT_GROUP_ID_OFFSET    (ITC_PAYLOAD_FRAGMENT_COUNT_OFFSET + ITC_PAYLOAD_FRAGMENT_COUNT_SIZE)
+#define ITC_PAYLOAD_FRAGMENT_GROUP_ID_SIZE      sizeof(uint32_t)
+
+#define ITC_PAYLOAD_FRAGMENT_INDEX_OFFSET       (ITC_PAYLOAD_FRAGMENT_GROUP_ID_OFFSET + ITC_PAYLOAD_FRAGMENT_GROUP_ID_SIZE)
+#define ITC_PAYLOAD_FRAGMENT_INDEX_SIZE         sizeof(uint16_t)
+
+#define ITC_PAYLOAD_FRAGMENT_TOTAL_OFFSET       (ITC_PAYLOAD_FRAGMENT_INDEX_OFFSET + ITC_PAYLOAD_FRAGMENT_INDEX_SIZE)
+#define ITC_PAYLOAD_FRAGMENT_TOTAL_SIZE         sizeof(uint16_t)
+
+#define ITC_PAYLOAD_FRAGMENT_BODY_OFFSET        (ITC_PAYLOAD_FRAGMENT_TOTAL_OFFSET + ITC_PAYLOAD_FRAGMENT_TOTAL_SIZE)
+#define ITC_PAYLOAD_FRAGMENT_MINIMAL_SIZE       ITC_PAYLOAD_FRAGMENT_BODY_OFFSET
+
+// Parity
+
+#define ITC_PAYLOAD_PARITY_SIZE_OFFSET      0
+#define ITC_PAYLOAD_PARITY_SIZE_SIZE        sizeof(uint8_t)
+
+#define ITC_PAYLOAD_PARITY_LENGTH_OFFSET    (ITC_PAYLOAD_PARITY_SIZE_OFFSET + ITC_PAYLOAD_PARITY_SIZE_SIZE)
+#define ITC_PAYLOAD_PARITY_LENGTH_SIZE      sizeof(uint32_t)
+
+#define ITC_PAYLOAD_PARITY_IDS_OFFSET       (ITC_PAYLOAD_PARITY_LENGTH_OFFSET + ITC_PAYLOAD_PARITY_LENGTH_SIZE)
+#define ITC_PAYLOAD_PARITY_ID_SIZE          sizeof(uint32_t)
+
+#define ITC_PAYLOAD_PARITY_MINIMAL_SIZE     ITC_PAYLOAD_PARITY_IDS_OFFSET
+
+// Note : Message, Batch and Fragment packets start their payload with the count field,
+// which is ignored by parity since it changes on each retransmission
+
+#define ITC_PROTECTED_COUNT_OFFSET          ITC_HEADER_SIZE
+
+// Number of parity groups remembered by the receiver
+
+#define ITC_FEC_HISTORY_GROUPS              64
+
+// Batch (Message body made of entries)
+
+#define ITC_BATCH_ENTRY_LENGTH_OFFSET       0
+#define ITC_BATCH_ENTRY_LENGTH_SIZE         sizeof(uint16_t)
+
+#define ITC_BATCH_ENTRY_BODY_OFFSET         ITC_BATCH_ENTRY_LENGTH_SIZE
+
 // Packets (Header + Payload)
 
 #define ITC_ACK_SIZE                        (ITC_HEADER_SIZE + ITC_PAYLOAD_ACK_SIZE)
 #define ITC_MESSAGE_MINIMAL_SIZE            (ITC_HEADER_SIZE + ITC_PAYLOAD_MESSAGE_MINIMAL_SIZE)
+#define ITC_FRAGMENT_MINIMAL_SIZE           (ITC_HEADER_SIZE + ITC_PAYLOAD_FRAGMENT_MINIMAL_SIZE)
+#define ITC_PARITY_MINIMAL_SIZE             (ITC_HEADER_SIZE + ITC_PAYLOAD_PARITY_MINIMAL_SIZE)
+
+// Tracing
+
+#define TRACE_CATEGORY                      "coreKit.Network.Reliable"
+
+// Metrics (Shared by all adapters, Stats stay per adapter)
+
+static const auto messagesSentMetric    = coreKit::Metrics::Registry::counter({ "coreKit", "Network", "Reliable", "MessagesSent" });
+static const auto retransmissionsMetric = coreKit::Metrics::Registry::counter({ "coreKit", "Network", "Reliable", "Retransmissions" });
+static const auto acknowledgedMetric    = coreKit::Metrics::Registry::counter({ "coreKit", "Network", "Reliable", "Acknowledged" });
+static const auto timeoutsMetric        = coreKit::Metrics::Registry::counter({ "coreKit", "Network", "Reliable", "Timeouts" });
+static const auto rejectedMetric        = coreKit::Metrics::Registry::counter({ "coreKit", "Network", "Reliable", "Rejected" });
+static const auto inFlightMetric        = coreKit::Metrics::Registry::gauge({ "coreKit", "Network", "Reliable", "InFlight" });
+static const auto rttMetric             = coreKit::Metrics::Registry::histogram({ "coreKit", "Network", "Reliable", "Rtt" });
 
 namespace coreKit { namespace Network {
     
@@ -90,11 +161,138 @@ namespace coreKit { namespace Network {
             
         }
         
+        void decode(const void* data,
+                    size_t bufferSize,
+                    iTC::Payload::Fragment &fragment) {
+            
+            // Check paquet size
+            if (bufferSize < ITC_FRAGMENT_MINIMAL_SIZE) {
+                throw std::runtime_error("Packet has invalid size");
+            }
+            
+            // Read count
+            fragment._count = *((uint8_t*) data);
+            
+            // Read group Id
+            uint32_t groupId;
+            memcpy(&groupId, &((uint8_t*) data)[ITC_PAYLOAD_FRAGMENT_GROUP_ID_OFFSET], ITC_PAYLOAD_FRAGMENT_GROUP_ID_SIZE);
+            fragment._groupId = ntohl(groupId);
+            
+            // Read index / total
+            uint16_t index, total;
+            memcpy(&index, &((uint8_t*) data)[ITC_PAYLOAD_FRAGMENT_INDEX_OFFSET], ITC_PAYLOAD_FRAGMENT_INDEX_SIZE);
+            memcpy(&total, &((uint8_t*) data)[ITC_PAYLOAD_FRAGMENT_TOTAL_OFFSET], ITC_PAYLOAD_FRAGMENT_TOTAL_SIZE);
+            fragment._index = ntohs(index);
+            fragment._total = ntohs(total);
+            
+            if (fragment._index >= fragment._total) {
+                throw std::runtime_error("Fragment has invalid index");
+            }
+            
+            // Read body
+            size_t payloadSize = (bufferSize - ITC_HEADER_SIZE);
+            fragment._body = boost::asio::const_buffer(&(((uint8_t*) data)[ITC_PAYLOAD_FRAGMENT_BODY_OFFSET]), (payloadSize - ITC_PAYLOAD_FRAGMENT_MINIMAL_SIZE));
+        }
+        
+        void decode(const void* data,
+                    size_t bufferSize,
+                    iTC::Payload::Parity &parity) {
+            
+            // Check paquet size
+            if (bufferSize < ITC_PARITY_MINIMAL_SIZE) {
+                throw std::runtime_error("Packet has invalid size");
+            }
+            
+            // Read size
+            uint8_t size = ((uint8_t*) data)[ITC_PAYLOAD_PARITY_SIZE_OFFSET];
+            if (size == 0 || bufferSize < ITC_PARITY_MINIMAL_SIZE + size * ITC_PAYLOAD_PARITY_ID_SIZE) {
+                throw std::runtime_error("Parity has invalid size");
+            }
+            
+            // Read length
+            uint32_t length;
+            memcpy(&length, &((uint8_t*) data)[ITC_PAYLOAD_PARITY_LENGTH_OFFSET], ITC_PAYLOAD_PARITY_LENGTH_SIZE);
+            parity._length = ntohl(length);
+            
+            // Read message Ids
+            parity._messageIds.clear();
+            for (size_t index = 0; index < size; index++) {
+                uint32_t messageId;
+                memcpy(&messageId, &((uint8_t*) data)[ITC_PAYLOAD_PARITY_IDS_OFFSET + index * ITC_PAYLOAD_PARITY_ID_SIZE], ITC_PAYLOAD_PARITY_ID_SIZE);
+                parity._messageIds.push_back(ntohl(messageId));
+            }
+            
+            // Read body
+            size_t bodyOffset = ITC_PAYLOAD_PARITY_IDS_OFFSET + size * ITC_PAYLOAD_PARITY_ID_SIZE;
+            parity._body = boost::asio::const_buffer(&(((uint8_t*) data)[bodyOffset]), (bufferSize - ITC_HEADER_SIZE - bodyOffset));
+        }
+        
+        MessageId advance(MessageId messageId,
+                          size_t span) {
+            
+            // Note : Message Id 0 is never used
+            
+            MessageId result = messageId + static_cast<MessageId>(span);
+            if (result <= messageId) {
+                result++;
+            }
+            
+            return result;
+        }
+        
+        void decode(const Buffer &body,
+                    std::vector<Buffer> &entries) {
+            
+            auto data = boost::asio::buffer_cast<const uint8_t*>(body);
+            auto bodySize = boost::asio::buffer_size(body);
+            
+            size_t offset = 0;
+            while (offset < bodySize) {
+                
+                // Read entry length
+                if (bodySize - offset < ITC_BATCH_ENTRY_BODY_OFFSET) {
+                    throw std::runtime_error("Batch entry has invalid size");
+                }
+                
+                uint16_t length;
+                memcpy(&length, &data[offset + ITC_BATCH_ENTRY_LENGTH_OFFSET], ITC_BATCH_ENTRY_LENGTH_SIZE);
+                length = ntohs(length);
+                
+                offset += ITC_BATCH_ENTRY_BODY_OFFSET;
+                
+                // Read entry body
+                if (bodySize - offset < length) {
+                    throw std::runtime_error("Batch entry has invalid size");
+                }
+                
+                entries.push_back(boost::asio::const_buffer(&data[offset], length));
+                offset += length;
+            }
+            
+            if (entries.empty()) {
+                throw std::runtime_error("Batch is empty");
+            }
+        }
+        
+        void encode(std::vector<uint8_t> &target,
+                    const Buffer &entry) {
+            
+            // Append entry length
+            uint16_t length = htons(static_cast<uint16_t>(boost::asio::buffer_size(entry)));
+            target.insert(target.end(), (uint8_t*) &length, ((uint8_t*) &length) + ITC_BATCH_ENTRY_LENGTH_SIZE);
+            
+            // Append entry body
+            auto data = boost::asio::buffer_cast<const uint8_t*>(entry);
+            target.insert(target.end(), data, data + boost::asio::buffer_size(entry));
+        }
+        
         void decode(const void* data,
                     iTC::Header &header) {
             
-            // Read payload type
-            header._payloadType = (iTC::PayloadType) *((uint8_t*) data);
+            // Read payload type / lane
+            uint8_t payloadType = *((uint8_t*) data);
+            header._payloadType = (iTC::PayloadType) (payloadType & ITC_HEADER_PAYLOAD_TYPE_MASK);
+            header._lane = (payloadType >> ITC_HEADER_LANE_SHIFT);
             
             // Read message Id
             header._messageId = ntohl(*((uint32_t*) &((uint8_t*) data)[ITC_HEADER_MESSAGE_ID_OFFSET]));
@@ -104,8 +302,8 @@ namespace coreKit { namespace Network {
         void encode(void* target,
                     const iTC::Header &header) {
             
-            // Copy payload type
-            uint8_t payloadType = static_cast<uint8_t>(header._payloadType);
+            // Copy payload type / lane
+            uint8_t payloadType = static_cast<uint8_t>(header._payloadType) | (header._lane << ITC_HEADER_LANE_SHIFT);
             memcpy(target, &payloadType, ITC_HEADER_PAYLOAD_TYPE_SIZE);
             
             // Copy message ID
@@ -134,6 +332,44 @@ namespace coreKit { namespace Network {
             memcpy(&(((uint8_t*) target)[ITC_PAYLOAD_MESSAGE_BODY_OFFSET]), boost::asio::buffer_cast<const uint8_t*>(payload._body), boost::asio::buffer_size(payload._body));
         }
         
+        void encode(void* target,
+                    const iTC::Payload::Fragment &payload) {
+            
+            // Copy count field
+            memcpy(target, &payload._count, ITC_PAYLOAD_FRAGMENT_COUNT_SIZE);
+            
+            // Copy group Id / index / total
+            uint32_t groupId = htonl(payload._groupId);
+            uint16_t index = htons(payload._index);
+            uint16_t total = htons(payload._total);
+            memcpy(&(((uint8_t*) target)[ITC_PAYLOAD_FRAGMENT_GROUP_ID_OFFSET]), &groupId, ITC_PAYLOAD_FRAGMENT_GROUP_ID_SIZE);
+            memcpy(&(((uint8_t*) target)[ITC_PAYLOAD_FRAGMENT_INDEX_OFFSET]), &index, ITC_PAYLOAD_FRAGMENT_INDEX_SIZE);
+            memcpy(&(((uint8_t*) target)[ITC_PAYLOAD_FRAGMENT_TOTAL_OFFSET]), &total, ITC_PAYLOAD_FRAGMENT_TOTAL_SIZE);
+            
+            // Copy body
+            memcpy(&(((uint8_t*) target)[ITC_PAYLOAD_FRAGMENT_BODY_OFFSET]), boost::asio::buffer_cast<const uint8_t*>(payload._body), boost::asio::buffer_size(payload._body));
+        }
+        
+        void encode(void* target,
+                    const iTC::Payload::Parity &payload) {
+            
+            // Copy size / length
+            uint8_t size = static_cast<uint8_t>(payload._messageIds.size());
+            uint32_t length = htonl(payload._length);
+            memcpy(&(((uint8_t*) target)[ITC_PAYLOAD_PARITY_SIZE_OFFSET]), &size, ITC_PAYLOAD_PARITY_SIZE_SIZE);
+            memcpy(&(((uint8_t*) target)[ITC_PAYLOAD_PARITY_LENGTH_OFFSET]), &length, ITC_PAYLOAD_PARITY_LENGTH_SIZE);
+            
+            // Copy message Ids
+            for (size_t index = 0; index < payload._messageIds.size(); index++) {
+                uint32_t messageId = htonl(payload._messageIds[index]);
+                memcpy(&(((uint8_t*) target)[ITC_PAYLOAD_PARITY_IDS_OFFSET + index * ITC_PAYLOAD_PARITY_ID_SIZE]), &messageId, ITC_PAYLOAD_PARITY_ID_SIZE);
+            }
+            
+            // Copy body
+            size_t bodyOffset = ITC_PAYLOAD_PARITY_IDS_OFFSET + payload._messageIds.size() * ITC_PAYLOAD_PARITY_ID_SIZE;
+            memcpy(&(((uint8_t*) target)[bodyOffset]), boost::asio::buffer_cast<const uint8_t*>(payload._body), boost::asio::buffer_size(payload._body));
+        }
+        
         void encode(void* target,
                     const iTC::Ack &ack) {
             encode(target, ack._header);
@@ -146,14 +382,28 @@ namespace coreKit { namespace Network {
             encode(ITC_GET_PAYLOAD(target), message._payload);
         }
         
+        void encode(void* target,
+                    const iTC::Fragment &fragment) {
+            encode(target, fragment._header);
+            encode(ITC_GET_PAYLOAD(target), fragment._payload);
+        }
+        
+        void encode(void* target,
+                    const iTC::Parity &parity) {
+            encode(target, parity._header);
+            encode(ITC_GET_PAYLOAD(target), parity._payload);
+        }
+        
     }
     
     // ReliableAdapter::HandledMessage
     
-    ReliableAdapter::HandledMessage::HandledMessage(const iTC::Message &message,
+    ReliableAdapter::HandledMessage::HandledMessage(iTC::MessageId messageId,
+                                                    uint8_t lane,
                                                     iTC::AckCode code) :
     
-    _messageId  (message._header._messageId),
+    _messageId  (messageId),
+    _lane       (lane),
     _ackCode    (code),
     _count      (0)
     
@@ -163,9 +413,89 @@ namespace coreKit { namespace Network {
         
         // Return new ack
         
-        return iTC::Ack(iTC::Header( { iTC::PayloadType::Ack, _messageId } ), iTC::Payload::Ack( { _count++, _ackCode } ) );
+        return iTC::Ack(iTC::Header( { iTC::PayloadType::Ack, _messageId, _lane } ), iTC::Payload::Ack( { _count++, _ackCode } ) );
+    }
+    
+    // ReliableAdapter::Reassembly
+    
+    ReliableAdapter::Reassembly::Reassembly(boost::asio::io_service &ioService,
+                                            const VirtualClock::Ptr &clock,
+                                            uint16_t total) :
+    
+    _fragments  (total),
+    _received   (0),
+    _size       (0),
+    _timer      (ioService, clock)
+    
+    { }
+    
+    // ReliableAdapter::Batch
+    
+    ReliableAdapter::Batch::Batch(boost::asio::io_service &ioService,
+                                  const VirtualClock::Ptr &clock) :
+    
+    _data       (nullptr),
+    _timer      (ioService, clock),
+    _sequence   (0)
+    
+    { }
+    
+    // ReliableAdapter::Ordering
+    
+    ReliableAdapter::Ordering::Ordering(boost::asio::io_service &ioService,
+                                        const VirtualClock::Ptr &clock) :
+    
+    _expected   (1),
+    _timer      (ioService, clock),
+    _sequence   (0),
+    _failed     (false)
+    
+    {
+        _stats._reordered       = 0;
+        _stats._late            = 0;
+        _stats._skipped         = 0;
+        _stats._holeTimeouts    = 0;
+        _stats._blockedTime     = 0;
+        _stats._maxBlockedTime  = 0;
+        _stats._maxDepth        = 0;
+    }
+    
+    // ReliableAdapter::Fec
+    
+    ReliableAdapter::Fec::Fec(boost::asio::io_service &ioService,
+                              const VirtualClock::Ptr &clock) :
+    
+    _length     (0),
+    _timer      (ioService, clock),
+    _sequence   (0),
+    _lossRate   (0)
+    
+    {
+        _stats._protected       = 0;
+        _stats._parities        = 0;
+        _stats._recovered       = 0;
+        _stats._bytesRecovered  = 0;
     }
     
+    // ReliableAdapter::Lane
+    
+    ReliableAdapter::Lane::Lane(boost::asio::io_service &ioService,
+                                const VirtualClock::Ptr &clock,
+                                uint8_t index,
+                                const LaneConfig &config) :
+    
+    _index          (index),
+    _config         (config),
+    _messageId      (0),
+    _handledTimer   (ioService, clock),
+    _batch          (ioService, clock),
+    _ordering       (ioService, clock),
+    _fec            (ioService, clock),
+    _inFlight       (0),
+    _credit         (0)
+    
+    { }
+    
     // ReliableTask
     
     struct ReliableTask : public std::enable_shared_from_this<ReliableTask> {
@@ -173,13 +503,24 @@ namespace coreKit { namespace Network {
         // Init
         
         ReliableTask(boost::asio::io_service &ioService,
+                     const VirtualClock::Ptr &clock,
                      const Buffer &body,
-                     iTC::MessageId messageId) :
+                     uint8_t lane,
+                     iTC::MessageId messageId,
+                     iTC::PayloadType payloadType,
+                     const iTC::Payload::Fragment *fragment) :
         
         _finished       (false),
+        _started        (false),
+        _lane           (lane),
         _message        ( { 0, messageId, body } ),
-        _timerMsg       (ioService),
-        _timerGlobal    (ioService)
+        _payloadType    (payloadType),
+        _fragment       (fragment ? *fragment : iTC::Payload::Fragment()),
+        _queuedTime     (0),
+        _sentTime       (0),
+        _traceId        (Metrics::Trace::nextId()),
+        _timerMsg       (ioService, clock),
+        _timerGlobal    (ioService, clock)
         
         { }
         
@@ -194,12 +535,50 @@ namespace coreKit { namespace Network {
             // Clear connections
             _connections.clear();
             
+            // Free our window slot
+            _adapterPtr->release(*this);
+            
         }
         
         // Encode message
         
         iTC::Message makeMessage() {
-            return iTC::Message(iTC::Header( { iTC::PayloadType::Message, _message._id } ), iTC::Payload::Message( { _message._count++, _message._body } ) );
+            return iTC::Message(iTC::Header( { _payloadType, _message._id, _lane } ), iTC::Payload::Message( { _message._count++, _message._body } ) );
+        }
+        
+        // Encode fragment
+        
+        iTC::Fragment makeFragment() {
+            
+            auto payload = _fragment;
+            payload._count  = _message._count++;
+            payload._body   = _message._body;
+            
+            return iTC::Fragment(iTC::Header( { iTC::PayloadType::Fragment, _message._id, _lane } ), payload);
+        }
+        
+        // Send the message (or the fragment)
+        
+        void send() {
+            
+            _adapterPtr->updateLossRate(*_adapterPtr->_lanes[_lane], _message._count != 0);
+            
+            if (_message._count == 0) {
+                _sentTime = _adapterPtr->now();
+                _adapterPtr->_stats._messagesSent++;
+                messagesSentMetric->add();
+            } else {
+                _adapterPtr->_stats._retransmissions++;
+                retransmissionsMetric->add();
+            }
+            
+            Metrics::Trace::record(TRACE_CATEGORY, Metrics::Trace::Stage::WriteStart, _traceId, _message._count);
+            
+            if (_payloadType == iTC::PayloadType::Fragment) {
+                _adapterPtr->send(makeFragment(), nullptr);
+            } else {
+                _adapterPtr->send(makeMessage(), nullptr);
+            }
         }
         
         // Timer callback
@@ -212,15 +591,12 @@ namespace coreKit { namespace Network {
                 
                 // Timeout !
                 
-                // Encode message
-                auto message = makeMessage();
-                
                 // Rearm timer
-                _timerMsg.expires_from_now(boost::posix_time::microseconds(_adapterPtr->timeoutFunc(message._payload._count)));
+                _timerMsg.expires_from_now(boost::posix_time::microseconds(_adapterPtr->timeoutFunc(*_adapterPtr->_lanes[_lane], _message._count)));
                 _timerMsg.async_wait(_adapterPtr->_strand.wrap(std::bind(&ReliableTask::onMsgTimerCallback, shared_from_this(), std::placeholders::_1)));
                 
                 // Send the message (again)
-                _adapterPtr->send(message, nullptr);
+                send();
             }
             
         }
@@ -230,6 +606,8 @@ namespace coreKit { namespace Network {
         // Common task attributes
         
         bool _finished;
+        bool _started;      // Set once a window slot has been granted
+        uint8_t _lane;
         WriteCallback _handler;
         std::vector<boost::signals2::scoped_connection> _connections;
         
@@ -243,10 +621,24 @@ namespace coreKit { namespace Network {
             
         } _message;
         
+        // Packet attributes (Fragment is only relevant for fragments)
+        
+        const iTC::PayloadType          _payloadType;
+        const iTC::Payload::Fragment    _fragment;
+        
+        // Statistics (Enqueue and first send times in microseconds)
+        
+        uint64_t                        _queuedTime;
+        uint64_t                        _sentTime;
+        
+        // Trace id (0 if not traced)
+        
+        const uint64_t                  _traceId;
+        
         // Timers
         
-        boost::asio::deadline_timer     _timerMsg;
-        boost::asio::deadline_timer     _timerGlobal;
+        Timer                           _timerMsg;
+        Timer                           _timerGlobal;
         
         // Shared pointers
         
@@ -259,12 +651,44 @@ namespace coreKit { namespace Network {
     ReliableAdapter::ReliableAdapter(boost::asio::io_service &ioService,
                                      const Config &config) :
     
-    _strand     (ioService),
-    _config     (config),
-    _state      (Stopped),
-    _messageId  (0)
+    _strand         (ioService),
+    _config         (config),
+    _state          (Stopped),
+    _inFlight       (0),
+    _statsTimer     (ioService, config._clock),
+    _statsInterval  (0)
     
-    { }
+    {
+        if (config._mtu != 0 &&
+            config._mtu <= ITC_FRAGMENT_MINIMAL_SIZE) {
+            throw std::invalid_argument("Invalid MTU");
+        }
+        
+        if (config._batching._delay != 0) {
+            if (config._batching._size <= ITC_BATCH_ENTRY_BODY_OFFSET ||
+                (config._mtu != 0 && ITC_MESSAGE_MINIMAL_SIZE + config._batching._size > config._mtu)) {
+                throw std::invalid_argument("Invalid batch size");
+            }
+        }
+        
+        if (config._fec._groupSize > UINT8_MAX) {
+            throw std::invalid_argument("Invalid FEC group size");
+        }
+        
+        // Create lanes
+        
+        if (config._priority._lanes.size() > ITC_HEADER_LANE_COUNT) {
+            throw std::invalid_argument("Invalid lane count");
+        }
+        
+        if (config._priority._lanes.empty()) {
+            _lanes.push_back(std::make_shared<Lane>(ioService, config._clock, 0, LaneConfig( { 0, 1, 0, nullptr } )));
+        } else {
+            for (size_t index = 0; index < config._priority._lanes.size(); index++) {
+                _lanes.push_back(std::make_shared<Lane>(ioService, config._clock, static_cast<uint8_t>(index), config._priority._lanes[index]));
+            }
+        }
+    }
     
     void ReliableAdapter::init(const Adapter::Callbacks &callbacks) {
         
@@ -304,8 +728,15 @@ namespace coreKit { namespace Network {
     
     void ReliableAdapter::handleOutgoingData(const Buffer &buffer,
                                              const WriteCallback &writeCallback) {
+        handleOutgoingData(buffer, 0, writeCallback);
+    }
+    
+    void ReliableAdapter::handleOutgoingData(const Buffer &buffer,
+                                             uint8_t lane,
+                                             const WriteCallback &writeCallback) {
         _strand.dispatch(std::bind(&ReliableAdapter::handleOutgoingData_internal, shared_from_this(),
                                    buffer,
+                                   lane,
                                    writeCallback));
     }
     
@@ -327,12 +758,28 @@ namespace coreKit { namespace Network {
             return;
         }
         
+        size_t bufferSize = boost::asio::buffer_size(buffer);
+        
+        _stats._packetsReceived++;
+        _stats._bytesReceived += bufferSize;
+        
+        Metrics::Trace::record(TRACE_CATEGORY, Metrics::Trace::Stage::Receive, 0, static_cast<uint32_t>(bufferSize));
+        
+        handlePacket_internal(buffer, writeCallback);
+    }
+    
+    void ReliableAdapter::handlePacket_internal(const Buffer &buffer,
+                                                const WriteCallback &writeCallback) {
+        
+        // Note : (Must be) Call by worker, for received and recovered packets
+        
         std::exception_ptr error = nullptr;
         
         size_t bufferSize = boost::asio::buffer_size(buffer);
         
         // First check packet size
         if (bufferSize < ITC_MESSAGE_MINIMAL_SIZE) {
+            _stats._invalidPackets++;
             error = std::make_exception_ptr(std::runtime_error("Invalid packet size"));
             if (writeCallback) {
                 writeCallback(error);
@@ -346,6 +793,25 @@ namespace coreKit { namespace Network {
         iTC::Header header;
         decode(data, header);
         
+        if (header._lane >= _lanes.size()) {
+            _stats._invalidPackets++;
+            error = std::make_exception_ptr(std::runtime_error("Invalid lane"));
+            if (writeCallback) {
+                writeCallback(error);
+            }
+            return;
+        }
+        
+        auto &lane = *_lanes[header._lane];
+        
+        // Remember protected packets
+        if (_config._fec._groupSize != 0 &&
+            (header._payloadType == iTC::PayloadType::Message ||
+             header._payloadType == iTC::PayloadType::Batch ||
+             header._payloadType == iTC::PayloadType::Fragment)) {
+            remember(lane, header._messageId, (const uint8_t*) data, bufferSize);
+        }
+        
         switch (header._payloadType) {
                 
                 /* iTC::PayloadType::Message */
@@ -360,7 +826,8 @@ namespace coreKit { namespace Network {
                 }
                 
                 if (!error) {
-                    onIncommingMessage(iTC::Message(header, payload),
+                    onIncommingMessage(lane,
+                                       iTC::Message(header, payload),
                                        writeCallback);
                 }
                 
@@ -368,6 +835,72 @@ namespace coreKit { namespace Network {
                 /* iTC::PayloadType::Message */
                 break;
                 
+                /* iTC::PayloadType::Batch */
+            case iTC::PayloadType::Batch:
+            {
+                iTC::Payload::Message payload;
+                std::vector<Buffer> entries;
+                
+                try {
+                    iTC::decode(ITC_GET_PAYLOAD(data), bufferSize, payload);
+                    iTC::decode(payload._body, entries);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                
+                if (!error) {
+                    onIncommingBatch(lane,
+                                     iTC::Message(header, payload),
+                                     entries,
+                                     writeCallback);
+                }
+                
+            }
+                /* iTC::PayloadType::Batch */
+                break;
+                
+                /* iTC::PayloadType::Fragment */
+            case iTC::PayloadType::Fragment:
+            {
+                iTC::Payload::Fragment payload;
+                
+                try {
+                    iTC::decode(ITC_GET_PAYLOAD(data), bufferSize, payload);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                
+                if (!error) {
+                    onIncommingFragment(lane,
+                                        iTC::Fragment(header, payload),
+                                        writeCallback);
+                }
+                
+            }
+                /* iTC::PayloadType::Fragment */
+                break;
+                
+                /* iTC::PayloadType::Parity */
+            case iTC::PayloadType::Parity:
+            {
+                iTC::Payload::Parity payload;
+                
+                try {
+                    iTC::decode(ITC_GET_PAYLOAD(data), bufferSize, payload);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                
+                if (!error) {
+                    onIncommingParity(lane,
+                                      iTC::Parity(header, payload),
+                                      writeCallback);
+                }
+                
+            }
+                /* iTC::PayloadType::Parity */
+                break;
+                
                 /* iTC::PayloadType::Ack */
             case iTC::PayloadType::Ack:
             {
@@ -380,7 +913,7 @@ namespace coreKit { namespace Network {
                 }
                 
                 if (!error) {
-                    onIncommingAck(iTC::Ack(header, payload));
+                    onIncommingAck(lane, iTC::Ack(header, payload));
                     
                     if (writeCallback) {
                         writeCallback(nullptr);
@@ -396,6 +929,7 @@ namespace coreKit { namespace Network {
         }
         
         if (error) {
+            _stats._invalidPackets++;
             if (writeCallback) {
                 writeCallback(error);
             }
@@ -403,6 +937,7 @@ namespace coreKit { namespace Network {
     }
     
     void ReliableAdapter::handleOutgoingData_internal(const Buffer &buffer,
+                                                      uint8_t laneIndex,
                                                       const WriteCallback &writeCallback) {
         
         // Note : Call by worker
@@ -420,11 +955,50 @@ namespace coreKit { namespace Network {
             return;
         }
         
-        auto messageId = getMessageId();
-        auto taskPtr = std::make_shared<ReliableTask>(_strand.get_io_service(), buffer, messageId);
+        if (laneIndex >= _lanes.size()) {
+            if (writeCallback) {
+                writeCallback(std::make_exception_ptr(std::runtime_error("Invalid lane (" + std::to_string(laneIndex) + ")")));
+            }
+            return;
+        }
+        
+        auto &lane = *_lanes[laneIndex];
+        
+        // Should we batch the message ?
+        
+        if (isBatchable(boost::asio::buffer_size(buffer))) {
+            sendBatched(lane, buffer, writeCallback);
+            return;
+        }
+        
+        // Keep ordering with pending batched messages
+        
+        flushBatch(lane);
+        
+        // Should we fragment the message ?
+        
+        if (_config._mtu != 0 &&
+            ITC_MESSAGE_MINIMAL_SIZE + boost::asio::buffer_size(buffer) > _config._mtu) {
+            sendFragmented(lane, buffer, writeCallback);
+        } else {
+            sendReliable(lane, buffer, getMessageId(lane), iTC::PayloadType::Message, writeCallback);
+        }
+    }
+    
+    void ReliableAdapter::sendReliable(Lane &lane,
+                                       const Buffer &body,
+                                       iTC::MessageId messageId,
+                                       iTC::PayloadType payloadType,
+                                       const WriteCallback &writeCallback,
+                                       const iTC::Payload::Fragment *fragment) {
+        
+        // Note : (Must be) call by worker
+        
+        auto taskPtr = std::make_shared<ReliableTask>(_strand.get_io_service(), _config._clock, body, lane._index, messageId, payloadType, fragment);
         
         taskPtr->_handler       = writeCallback;
         taskPtr->_adapterPtr    = shared_from_this();
+        taskPtr->_queuedTime    = now();
         
         // Disconnection callback
         
@@ -477,11 +1051,41 @@ namespace coreKit { namespace Network {
             
             if (ack._header._messageId == messageId) {
                 
-                if (!taskPtr->_finished) {
+                if (!taskPtr->_finished && ack._payload._code != iTC::AckCode::Ok) {
+                    
+                    // Rejected by the peer, retransmitting can't help
+                    
+                    auto reason = std::make_exception_ptr(std::runtime_error("Message rejected by peer"));
+                    
+                    rejectedMetric->add();
                     
                     taskPtr->_finished = true;
                     if (taskPtr->_handler) {
-                        taskPtr->_handler(nullptr);
+                        taskPtr->_handler(reason);
+                    }
+                    taskPtr->clean();
+                    
+                } else if (!taskPtr->_finished) {
+                    
+                    // Update statistics (Karn : retransmitted packets give no RTT sample)
+                    
+                    auto &stats = taskPtr->_adapterPtr->_stats;
+                    auto ackTime = taskPtr->_adapterPtr->now();
+                    
+                    stats._acknowledged++;
+                    acknowledgedMetric->add();
+                    
+                    Metrics::Trace::record(TRACE_CATEGORY, Metrics::Trace::Stage::Ack, taskPtr->_traceId, taskPtr->_message._count);
+                    
+                    stats._ackLatency.recordExclusive(ackTime - taskPtr->_queuedTime);
+                    if (taskPtr->_message._count == 1) {
+                        stats._rtt.recordExclusive(ackTime - taskPtr->_sentTime);
+                        rttMetric->record(ackTime - taskPtr->_sentTime);
+                    }
+                    
+                    taskPtr->_finished = true;
+                    if (taskPtr->_handler) {
+                        taskPtr->_handler(nullptr);
                     }
                     taskPtr->clean();
                     
@@ -503,6 +1107,9 @@ namespace coreKit { namespace Network {
                 
                 auto reason = std::make_exception_ptr(std::runtime_error("Request timeout"));
                 
+                taskPtr->_adapterPtr->_stats._timeouts++;
+                timeoutsMetric->add();
+                
                 taskPtr->_finished = true;
                 if (taskPtr->_handler) {
                     taskPtr->_handler(reason);
@@ -515,159 +1122,1329 @@ namespace coreKit { namespace Network {
         taskPtr->_connections.push_back(_disconnection_Signal.connect(onDisconnection));
         
         // Subscribe abortion callbacks
-        taskPtr->_connections.push_back(_cancel_Signal.connect(onAbortion));
+        taskPtr->_connections.push_back(lane._cancel_Signal.connect(onAbortion));
         
         // Subscribe acknowledgment callbacks
-        taskPtr->_connections.push_back(_acks_Signal.connect(onAcknowledgment));
-        
-        // Encode message
-        auto message = taskPtr->makeMessage();
+        taskPtr->_connections.push_back(lane._acks_Signal.connect(onAcknowledgment));
         
-        // Start message timer
-        taskPtr->_timerMsg.expires_from_now(boost::posix_time::microseconds(timeoutFunc(message._payload._count)));
-        taskPtr->_timerMsg.async_wait(_strand.wrap([taskPtr](const boost::system::error_code &error) {
-            taskPtr->onMsgTimerCallback(error);
-        }));
-        
-        // Start global timer
-        taskPtr->_timerGlobal.expires_from_now(boost::posix_time::microseconds(_config._globalTimeout));
+        // Start global timer (Time spent waiting for a window slot included)
+        taskPtr->_timerGlobal.expires_from_now(boost::posix_time::microseconds(globalTimeout(lane)));
         taskPtr->_timerGlobal.async_wait(_strand.wrap(timerGlobalCallback));
         
-        // Finaly send the message !
-        send(message, nullptr);
+        // Wait for a window slot
+        Metrics::Trace::record(TRACE_CATEGORY, Metrics::Trace::Stage::Enqueue, taskPtr->_traceId, static_cast<uint32_t>(lane._queue.size()));
+        lane._queue.push_back(taskPtr);
+        schedule();
         
     }
     
-    void ReliableAdapter::send(std::shared_ptr<uint8_t> buffer,
-                               size_t bufferSize,
-                               const WriteCallback &writeCallback) {
+    void ReliableAdapter::schedule() {
         
         // Note : (Must be) call by worker
         
-        _callbacks._onOutgoingData(Buffer(buffer.get(), bufferSize), [writeCallback, buffer](std::exception_ptr error) {
-            if (writeCallback) {
-                writeCallback(error);
+        while (_config._priority._window == 0 || _inFlight < _config._priority._window) {
+            
+            auto lane = nextLane();
+            if (!lane) {
+                return;
             }
-        });
+            
+            auto taskPtr = lane->_queue.front();
+            lane->_queue.pop_front();
+            
+            // Note : Task may have expired while waiting
+            
+            if (!taskPtr->_finished) {
+                start(taskPtr);
+            }
+        }
     }
     
-    void ReliableAdapter::send(const iTC::Message &message,
-                               const WriteCallback &writeCallback) {
+    ReliableAdapter::Lane* ReliableAdapter::nextLane() {
         
         // Note : (Must be) call by worker
         
-        // Allocate memory
-        size_t bufferSize = ITC_MESSAGE_MINIMAL_SIZE + boost::asio::buffer_size(message._payload._body);
-        auto buffer = std::shared_ptr<uint8_t>(new uint8_t[bufferSize], std::default_delete<uint8_t[]>());
+        // Lanes having both pending messages and room in their window
         
-        // Encode data (Will copy the body)
-        encode(buffer.get(), message);
+        std::vector<Lane*> candidates;
         
-        // Send data
-        send(buffer, bufferSize, writeCallback);
+        for (const auto &lanePtr : _lanes) {
+            if (!lanePtr->_queue.empty() &&
+                (lanePtr->_config._window == 0 || lanePtr->_inFlight < lanePtr->_config._window)) {
+                
+                if (_config._priority._scheduling == Scheduling::Strict) {
+                    return lanePtr.get();
+                }
+                
+                candidates.push_back(lanePtr.get());
+            }
+        }
+        
+        if (candidates.empty()) {
+            return nullptr;
+        }
+        
+        // Smooth weighted round robin
+        
+        Lane *result = nullptr;
+        int64_t totalWeight = 0;
+        
+        for (auto lane : candidates) {
+            
+            int64_t weight = std::max(lane->_config._weight, 1u);
+            
+            lane->_credit += weight;
+            totalWeight += weight;
+            
+            if (!result || lane->_credit > result->_credit) {
+                result = lane;
+            }
+        }
+        
+        result->_credit -= totalWeight;
         
+        return result;
     }
     
-    void ReliableAdapter::send(const iTC::Ack &ack,
-                               const WriteCallback &writeCallback) {
+    void ReliableAdapter::start(const std::shared_ptr<ReliableTask> &taskPtr) {
         
         // Note : (Must be) call by worker
         
-        // Allocate memory
-        size_t bufferSize = ITC_ACK_SIZE;
-        auto buffer = std::shared_ptr<uint8_t>(new uint8_t[bufferSize], std::default_delete<uint8_t[]>());
+        auto &lane = *_lanes[taskPtr->_lane];
         
-        // Encode data
-        encode(buffer.get(), ack);
+        // Take a window slot
+        Metrics::Trace::record(TRACE_CATEGORY, Metrics::Trace::Stage::Dequeue, taskPtr->_traceId, static_cast<uint32_t>(lane._inFlight));
+        taskPtr->_started = true;
+        lane._inFlight++;
+        _inFlight++;
+        inFlightMetric->add(1);
         
-        // Send data
-        send(buffer, bufferSize, writeCallback);
+        // Start message timer
+        taskPtr->_timerMsg.expires_from_now(boost::posix_time::microseconds(timeoutFunc(lane, taskPtr->_message._count)));
+        taskPtr->_timerMsg.async_wait(_strand.wrap([taskPtr](const boost::system::error_code &error) {
+            taskPtr->onMsgTimerCallback(error);
+        }));
         
+        // Finaly send the message !
+        taskPtr->send();
     }
     
-    uint64_t ReliableAdapter::defaultTimeoutFunc(size_t) {
-        return 100000; /* 100 Milliseconds */
+    void ReliableAdapter::release(const ReliableTask &task) {
+        
+        // Note : (Must be) call by worker
+        
+        if (!task._started) {
+            return;
+        }
+        
+        _lanes[task._lane]->_inFlight--;
+        _inFlight--;
+        inFlightMetric->sub(1);
+        
+        // Give the slot to the next message
+        if (_state == Started) {
+            schedule();
+        }
     }
     
-    uint64_t ReliableAdapter::timeoutFunc(size_t count) {
-        if (_config._timeoutFunc) {
-            return _config._timeoutFunc(count);
-        } else {
-            return defaultTimeoutFunc(count);
+    void ReliableAdapter::sendFragmented(Lane &lane,
+                                         const Buffer &buffer,
+                                         const WriteCallback &writeCallback) {
+        
+        // Note : (Must be) call by worker
+        
+        const size_t bodySize   = boost::asio::buffer_size(buffer);
+        const size_t chunkSize  = _config._mtu - ITC_FRAGMENT_MINIMAL_SIZE;
+        const size_t total      = (bodySize + chunkSize - 1) / chunkSize;
+        
+        if (total > UINT16_MAX) {
+            if (writeCallback) {
+                writeCallback(std::make_exception_ptr(std::runtime_error("Message is too large (" + std::to_string(bodySize) + " Bytes)")));
+            }
+            return;
+        }
+        
+        // Our progress container
+        
+        struct Progress {
+            
+            bool _finished;
+            size_t _remaining;
+            WriteCallback _handler;
+            std::vector<iTC::MessageId> _messageIds;
+            
+        };
+        
+        auto progressPtr = std::make_shared<Progress>();
+        
+        progressPtr->_finished  = false;
+        progressPtr->_remaining = total;
+        progressPtr->_handler   = writeCallback;
+        
+        // Fragment callback
+        
+        auto ptr = shared_from_this();
+        auto lanePtr = _lanes[lane._index];
+        auto onFragmentSent = [ptr, lanePtr, progressPtr](const std::exception_ptr error) {
+            
+            // Note : Call by worker
+            
+            if (progressPtr->_finished) {
+                return;
+            }
+            
+            if (error) {
+                
+                progressPtr->_finished = true;
+                
+                // Abort remaining fragments
+                for (auto messageId : progressPtr->_messageIds) {
+                    ptr->cancel(*lanePtr, messageId);
+                }
+                
+                if (progressPtr->_handler) {
+                    progressPtr->_handler(error);
+                }
+                
+            } else if (--progressPtr->_remaining == 0) {
+                
+                progressPtr->_finished = true;
+                if (progressPtr->_handler) {
+                    progressPtr->_handler(nullptr);
+                }
+            }
+        };
+        
+        // Send each fragment as a reliable message
+        
+        iTC::Payload::Fragment fragment = { 0, 0, 0, static_cast<uint16_t>(total), Buffer() };
+        
+        for (size_t index = 0; index < total; index++) {
+            
+            auto messageId = getMessageId(lane);
+            progressPtr->_messageIds.push_back(messageId);
+            
+            if (index == 0) {
+                fragment._groupId = messageId;
+            }
+            
+            fragment._index = static_cast<uint16_t>(index);
+            
+            auto offset = index * chunkSize;
+            auto body = boost::asio::buffer(buffer + offset, std::min(chunkSize, bodySize - offset));
+            
+            sendReliable(lane, body, messageId, iTC::PayloadType::Fragment, onFragmentSent, &fragment);
         }
     }
     
-    void ReliableAdapter::onIncommingMessage(const iTC::Message &message,
-                                             const WriteCallback &writeCallback) {
+    bool ReliableAdapter::isBatchable(size_t bodySize) const {
+        return (_config._batching._delay != 0 &&
+                bodySize <= UINT16_MAX &&
+                ITC_BATCH_ENTRY_BODY_OFFSET + bodySize <= _config._batching._size);
+    }
+    
+    void ReliableAdapter::sendBatched(Lane &lane,
+                                      const Buffer &buffer,
+                                      const WriteCallback &writeCallback) {
+        
+        // Note : (Must be) call by worker
         
-        // TODO : Add fixed size map
+        size_t entrySize = ITC_BATCH_ENTRY_BODY_OFFSET + boost::asio::buffer_size(buffer);
         
-        auto messageId = message._header._messageId;
+        // Flush the batch if the entry does not fit
+        
+        if (lane._batch._data && lane._batch._data->size() + entrySize > _config._batching._size) {
+            flushBatch(lane);
+        }
         
-        auto iterator = _handledMessages.find(messageId);
-        if (iterator == _handledMessages.end()) {
+        // Start a new batch if needed
+        
+        if (!lane._batch._data) {
             
-            // Create HandledMessage for this message
-            auto handledMsg = std::make_shared<HandledMessage>(message, iTC::AckCode::Ok);
-            _handledMessages.insert(std::make_pair(messageId, handledMsg));
-            iterator = _handledMessages.find(messageId);
+            lane._batch._data = std::make_shared<std::vector<uint8_t> >();
+            lane._batch._data->reserve(_config._batching._size);
             
-            // Forward message to user
-            _callbacks._onIncommingMessage(message._payload._body, writeCallback);
+            auto ptr = shared_from_this();
+            auto lanePtr = _lanes[lane._index];
+            auto sequence = lane._batch._sequence;
             
-        } else {
-            if (writeCallback) {
-                writeCallback(nullptr);
-            }
+            lane._batch._timer.expires_from_now(boost::posix_time::microseconds(_config._batching._delay));
+            lane._batch._timer.async_wait(_strand.wrap([ptr, lanePtr, sequence](const boost::system::error_code &error) {
+                
+                // Note : Call by worker
+                
+                if (!error && lanePtr->_batch._sequence == sequence) {
+                    ptr->flushBatch(*lanePtr);
+                }
+            }));
         }
         
-        send(iterator->second->makeAck(), nullptr);
+        // Append entry (Will copy the body)
+        
+        iTC::encode(*lane._batch._data, buffer);
+        lane._batch._callbacks.push_back(writeCallback);
+        
+        // Flush the batch if full
+        
+        if (lane._batch._data->size() + ITC_BATCH_ENTRY_BODY_OFFSET >= _config._batching._size) {
+            flushBatch(lane);
+        }
     }
     
-    bool ReliableAdapter::onIncommingAck(const iTC::Ack &ack) {
+    void ReliableAdapter::flushBatch(Lane &lane) {
         
-        // Note : (Must be) Call by worker
+        // Note : (Must be) call by worker
+        
+        if (!lane._batch._data) {
+            return;
+        }
         
-        return _acks_Signal(ack);
+        auto data       = lane._batch._data;
+        auto callbacks  = std::make_shared<std::vector<WriteCallback> >();
+        
+        callbacks->swap(lane._batch._callbacks);
+        
+        // Reset batch
+        
+        lane._batch._data = nullptr;
+        lane._batch._sequence++;
+        lane._batch._timer.cancel();
+        
+        // Send the batch as a single reliable message
+        
+        sendReliable(lane, Buffer(data->data(), data->size()), getMessageId(lane), iTC::PayloadType::Batch, [data, callbacks](const std::exception_ptr error) {
+            
+            // Note : Call by worker
+            
+            for (const auto &callback : *callbacks) {
+                if (callback) {
+                    callback(error);
+                }
+            }
+        });
     }
     
-    bool ReliableAdapter::cancel(iTC::MessageId messageId) {
+    void ReliableAdapter::protect(Lane &lane,
+                                  iTC::MessageId messageId,
+                                  const uint8_t *packet,
+                                  size_t packetSize) {
         
-        // Note : (Must be) Call by worker
+        // Note : (Must be) call by worker
+        
+        if (_config._fec._groupSize == 0) {
+            return;
+        }
+        
+        auto &fec = lane._fec;
+        
+        // Start a new group if needed
+        
+        if (fec._messageIds.empty() && _config._fec._delay != 0) {
+            
+            auto ptr = shared_from_this();
+            auto lanePtr = _lanes[lane._index];
+            auto sequence = fec._sequence;
+            
+            fec._timer.expires_from_now(boost::posix_time::microseconds(_config._fec._delay));
+            fec._timer.async_wait(_strand.wrap([ptr, lanePtr, sequence](const boost::system::error_code &error) {
+                
+                // Note : Call by worker
+                
+                if (!error && lanePtr->_fec._sequence == sequence) {
+                    ptr->flushParity(*lanePtr);
+                }
+            }));
+        }
+        
+        // Accumulate packet (Count ignored)
+        
+        if (fec._parity.size() < packetSize) {
+            fec._parity.resize(packetSize, 0);
+        }
+        
+        for (size_t index = 0; index < packetSize; index++) {
+            fec._parity[index] ^= packet[index];
+        }
+        fec._parity[ITC_PROTECTED_COUNT_OFFSET] ^= packet[ITC_PROTECTED_COUNT_OFFSET];
+        
+        fec._length ^= static_cast<uint32_t>(packetSize);
+        fec._messageIds.push_back(messageId);
+        
+        fec._stats._protected++;
         
-        return _cancel_Signal(messageId);
+        // Send parity if the group is complete
+        
+        if (fec._messageIds.size() >= groupSize(lane)) {
+            flushParity(lane);
+        }
     }
     
-    iTC::MessageId ReliableAdapter::getMessageId() {
+    void ReliableAdapter::flushParity(Lane &lane) {
         
-        unsigned int result = _messageId.fetch_add(1);
-        if (result != 0) {
-            return result;
-        } else {
-            return getMessageId();
+        // Note : (Must be) call by worker
+        
+        auto &fec = lane._fec;
+        
+        if (fec._messageIds.empty()) {
+            return;
         }
+        
+        iTC::Payload::Parity payload = { fec._messageIds, fec._length, Buffer(fec._parity.data(), fec._parity.size()) };
+        
+        send(iTC::Parity(iTC::Header( { iTC::PayloadType::Parity, fec._messageIds.front(), lane._index } ), payload), nullptr);
+        
+        fec._stats._parities++;
+        
+        // Reset group
+        
+        fec._parity.clear();
+        fec._length = 0;
+        fec._messageIds.clear();
+        fec._sequence++;
+        fec._timer.cancel();
     }
     
-    void ReliableAdapter::disconnect() {
+    size_t ReliableAdapter::groupSize(const Lane &lane) const {
         
-        // Note : Call by worker
+        if (!_config._fec._adaptive || lane._fec._lossRate <= 0) {
+            return _config._fec._groupSize;
+        }
         
-        // Check state
-        if (_state != Started) {
+        // Note : XOR parity rebuilds a single loss per group,
+        // aim at half a loss per group (Parity included)
+        
+        double size = 1.0 / (2.0 * lane._fec._lossRate) - 1.0;
+        
+        if (size < 1.0) {
+            return 1;
+        }
+        
+        return std::min(static_cast<size_t>(size), _config._fec._groupSize);
+    }
+    
+    void ReliableAdapter::updateLossRate(Lane &lane,
+                                         bool retransmission) {
+        
+        // Note : (Must be) call by worker
+        
+        // Exponential moving average over about 64 transmissions
+        
+        const double alpha = 1.0 / 64.0;
+        
+        lane._fec._lossRate = lane._fec._lossRate * (1.0 - alpha) + (retransmission ? alpha : 0.0);
+    }
+    
+    void ReliableAdapter::remember(Lane &lane,
+                                   iTC::MessageId messageId,
+                                   const uint8_t *packet,
+                                   size_t packetSize) {
+        
+        // Note : (Must be) call by worker
+        
+        auto &fec = lane._fec;
+        
+        if (fec._packets.find(messageId) != fec._packets.end()) {
             return;
         }
         
-        // Cancel tasks
-        _disconnection_Signal();
+        auto &copy = fec._packets[messageId];
+        copy.assign(packet, packet + packetSize);
+        copy[ITC_PROTECTED_COUNT_OFFSET] = 0;
         
-        // Unereference user callbacks
-        _callbacks = Callbacks();
+        fec._history.push_back(messageId);
+        
+        // Forget oldest packets
+        
+        while (fec._history.size() > _config._fec._groupSize * ITC_FEC_HISTORY_GROUPS) {
+            fec._packets.erase(fec._history.front());
+            fec._history.pop_front();
+        }
+    }
+    
+    void ReliableAdapter::send(std::shared_ptr<uint8_t> buffer,
+                               size_t bufferSize,
+                               const WriteCallback &writeCallback) {
+        
+        // Note : (Must be) call by worker
+        
+        _stats._packetsSent++;
+        _stats._bytesSent += bufferSize;
+        
+        _callbacks._onOutgoingData(Buffer(buffer.get(), bufferSize), [writeCallback, buffer](std::exception_ptr error) {
+            if (writeCallback) {
+                writeCallback(error);
+            }
+        });
+    }
+    
+    void ReliableAdapter::send(const iTC::Message &message,
+                               const WriteCallback &writeCallback) {
+        
+        // Note : (Must be) call by worker
+        
+        // Allocate memory
+        size_t bufferSize = ITC_MESSAGE_MINIMAL_SIZE + boost::asio::buffer_size(message._payload._body);
+        auto buffer = std::shared_ptr<uint8_t>(new uint8_t[bufferSize], std::default_delete<uint8_t[]>());
+        
+        // Encode data (Will copy the body)
+        encode(buffer.get(), message);
+        
+        // Protect first transmissions
+        if (message._payload._count == 0) {
+            protect(*_lanes[message._header._lane], message._header._messageId, buffer.get(), bufferSize);
+        }
+        
+        // Send data
+        send(buffer, bufferSize, writeCallback);
+        
+    }
+    
+    void ReliableAdapter::send(const iTC::Fragment &fragment,
+                               const WriteCallback &writeCallback) {
+        
+        // Note : (Must be) call by worker
+        
+        // Allocate memory
+        size_t bufferSize = ITC_FRAGMENT_MINIMAL_SIZE + boost::asio::buffer_size(fragment._payload._body);
+        auto buffer = std::shared_ptr<uint8_t>(new uint8_t[bufferSize], std::default_delete<uint8_t[]>());
+        
+        // Encode data (Will copy the body)
+        encode(buffer.get(), fragment);
+        
+        // Protect first transmissions
+        if (fragment._payload._count == 0) {
+            protect(*_lanes[fragment._header._lane], fragment._header._messageId, buffer.get(), bufferSize);
+        }
+        
+        // Send data
+        send(buffer, bufferSize, writeCallback);
+        
+    }
+    
+    void ReliableAdapter::send(const iTC::Parity &parity,
+                               const WriteCallback &writeCallback) {
+        
+        // Note : (Must be) call by worker
+        
+        // Allocate memory
+        size_t bufferSize = ITC_PARITY_MINIMAL_SIZE + parity._payload._messageIds.size() * ITC_PAYLOAD_PARITY_ID_SIZE + boost::asio::buffer_size(parity._payload._body);
+        auto buffer = std::shared_ptr<uint8_t>(new uint8_t[bufferSize], std::default_delete<uint8_t[]>());
+        
+        // Encode data (Will copy the body)
+        encode(buffer.get(), parity);
+        
+        // Send data
+        send(buffer, bufferSize, writeCallback);
+        
+    }
+    
+    void ReliableAdapter::send(const iTC::Ack &ack,
+                               const WriteCallback &writeCallback) {
+        
+        // Note : (Must be) call by worker
+        
+        // Allocate memory
+        size_t bufferSize = ITC_ACK_SIZE;
+        auto buffer = std::shared_ptr<uint8_t>(new uint8_t[bufferSize], std::default_delete<uint8_t[]>());
+        
+        // Encode data
+        encode(buffer.get(), ack);
+        
+        _stats._acksSent++;
+        
+        // Send data
+        send(buffer, bufferSize, writeCallback);
+        
+    }
+    
+    uint64_t ReliableAdapter::defaultTimeoutFunc(size_t) {
+        return 100000; /* 100 Milliseconds */
+    }
+    
+    uint64_t ReliableAdapter::timeoutFunc(const Lane &lane,
+                                          size_t count) {
+        if (lane._config._timeoutFunc) {
+            return lane._config._timeoutFunc(count);
+        } else if (_config._timeoutFunc) {
+            return _config._timeoutFunc(count);
+        } else {
+            return defaultTimeoutFunc(count);
+        }
+    }
+    
+    uint64_t ReliableAdapter::globalTimeout(const Lane &lane) const {
+        return (lane._config._globalTimeout != 0 ? lane._config._globalTimeout : _config._globalTimeout);
+    }
+    
+    uint64_t ReliableAdapter::now() const {
+        
+        if (_config._clock) {
+            return _config._clock->now();
+        }
+        
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    
+    void ReliableAdapter::onIncommingMessage(Lane &lane,
+                                             const iTC::Message &message,
+                                             const WriteCallback &writeCallback) {
+        
+        // Note : (Must be) Call by worker
+        
+        auto messageId = message._header._messageId;
+        
+        auto iterator = lane._handledMessages.find(messageId);
+        if (iterator == lane._handledMessages.end()) {
+            
+            // Create HandledMessage for this message
+            handled(lane, messageId, iTC::AckCode::Ok);
+            iterator = lane._handledMessages.find(messageId);
+            
+            // Forward message to user
+            deliver(lane, messageId, 1, { message._payload._body }, writeCallback);
+            
+        } else {
+            
+            // Already handled, acknowledge it again
+            _stats._duplicates++;
+            
+            if (writeCallback) {
+                writeCallback(nullptr);
+            }
+        }
+        
+        send(iterator->second->makeAck(), nullptr);
+    }
+    
+    void ReliableAdapter::onIncommingFragment(Lane &lane,
+                                              const iTC::Fragment &fragment,
+                                              const WriteCallback &writeCallback) {
+        
+        // Note : (Must be) Call by worker
+        
+        auto messageId  = fragment._header._messageId;
+        auto groupId    = fragment._payload._groupId;
+        
+        auto iterator = lane._handledMessages.find(messageId);
+        if (iterator == lane._handledMessages.end()) {
+            
+            // Find (or create) the reassembly for this group
+            auto reassemblyIt = lane._reassemblies.find(groupId);
+            if (reassemblyIt == lane._reassemblies.end()) {
+                
+                auto reassemblyPtr = std::make_shared<Reassembly>(_strand.get_io_service(), _config._clock, fragment._payload._total);
+                reassemblyIt = lane._reassemblies.insert(std::make_pair(groupId, reassemblyPtr)).first;
+                
+                // Note : The sender gives up after its global timeout,
+                // so does the reassembly
+                
+                auto lanePtr = _lanes[lane._index];
+                reassemblyPtr->_timer.expires_from_now(boost::posix_time::microseconds(globalTimeout(lane)));
+                reassemblyPtr->_timer.async_wait(_strand.wrap([lanePtr, groupId, reassemblyPtr](const boost::system::error_code &error) {
+                    
+                    // Note : Call by worker
+                    
+                    if (!error) {
+                        auto iterator = lanePtr->_reassemblies.find(groupId);
+                        if (iterator != lanePtr->_reassemblies.end() && iterator->second == reassemblyPtr) {
+                            lanePtr->_reassemblies.erase(iterator);
+                        }
+                    }
+                }));
+            }
+            
+            auto reassemblyPtr = reassemblyIt->second;
+            if (reassemblyPtr->_fragments.size() != fragment._payload._total) {
+                
+                // Note : Rejected rather than left unacknowledged, the sender
+                // would retransmit it until its global timeout
+                
+                auto handledMsg = handled(lane, messageId, iTC::AckCode::Rejected);
+                
+                if (writeCallback) {
+                    writeCallback(std::make_exception_ptr(std::runtime_error("Fragment does not match its group")));
+                }
+                
+                send(handledMsg->makeAck(), nullptr);
+                return;
+            }
+            
+            // Create HandledMessage for this fragment
+            handled(lane, messageId, iTC::AckCode::Ok);
+            iterator = lane._handledMessages.find(messageId);
+            
+            // Save fragment body
+            auto body = boost::asio::buffer_cast<const uint8_t*>(fragment._payload._body);
+            auto bodySize = boost::asio::buffer_size(fragment._payload._body);
+            
+            reassemblyPtr->_fragments[fragment._payload._index].assign(body, body + bodySize);
+            reassemblyPtr->_received++;
+            reassemblyPtr->_size += bodySize;
+            
+            if (reassemblyPtr->_received == reassemblyPtr->_fragments.size()) {
+                
+                // Message is complete
+                reassemblyPtr->_timer.cancel();
+                lane._reassemblies.erase(reassemblyIt);
+                
+                auto message = std::make_shared<std::vector<uint8_t> >();
+                message->reserve(reassemblyPtr->_size);
+                for (const auto &chunk : reassemblyPtr->_fragments) {
+                    message->insert(message->end(), chunk.begin(), chunk.end());
+                }
+                
+                // Forward message to user
+                deliver(lane, groupId, reassemblyPtr->_fragments.size(), { Buffer(message->data(), message->size()) }, [message, writeCallback](const std::exception_ptr error) {
+                    if (writeCallback) {
+                        writeCallback(error);
+                    }
+                });
+                
+            } else {
+                if (writeCallback) {
+                    writeCallback(nullptr);
+                }
+            }
+            
+        } else {
+            
+            // Already handled, acknowledge it again
+            _stats._duplicates++;
+            
+            if (writeCallback) {
+                writeCallback(nullptr);
+            }
+        }
+        
+        send(iterator->second->makeAck(), nullptr);
+    }
+    
+    void ReliableAdapter::onIncommingBatch(Lane &lane,
+                                           const iTC::Message &batch,
+                                           const std::vector<Buffer> &entries,
+                                           const WriteCallback &writeCallback) {
+        
+        // Note : (Must be) Call by worker
+        
+        auto messageId = batch._header._messageId;
+        
+        auto iterator = lane._handledMessages.find(messageId);
+        if (iterator == lane._handledMessages.end()) {
+            
+            // Create HandledMessage for this batch
+            handled(lane, messageId, iTC::AckCode::Ok);
+            iterator = lane._handledMessages.find(messageId);
+            
+            // Forward entries to user
+            deliver(lane, messageId, 1, entries, writeCallback);
+            
+        } else {
+            
+            // Already handled, acknowledge it again
+            _stats._duplicates++;
+            
+            if (writeCallback) {
+                writeCallback(nullptr);
+            }
+        }
+        
+        send(iterator->second->makeAck(), nullptr);
+    }
+    
+    ReliableAdapter::HandledMessage::Ptr ReliableAdapter::handled(Lane &lane,
+                                                                  iTC::MessageId messageId,
+                                                                  iTC::AckCode code) {
+        
+        // Note : (Must be) Call by worker
+        
+        auto handledMsg = std::make_shared<HandledMessage>(messageId, lane._index, code);
+        lane._handledMessages[messageId] = handledMsg;
+        
+        // Note : The sender gives up after its global timeout,
+        // the handled message is forgotten after it as well
+        
+        auto timeout = globalTimeout(lane);
+        
+        lane._handledHistory.push_back(std::make_pair(now() + timeout, messageId));
+        
+        if (lane._handledHistory.size() == 1) {
+            armHandledTimer(lane, timeout);
+        }
+        
+        return handledMsg;
+    }
+    
+    void ReliableAdapter::armHandledTimer(Lane &lane,
+                                          uint64_t delay) {
+        
+        // Note : (Must be) Call by worker
+        
+        auto ptr = shared_from_this();
+        auto lanePtr = _lanes[lane._index];
+        
+        lane._handledTimer.expires_from_now(boost::posix_time::microseconds(delay));
+        lane._handledTimer.async_wait(_strand.wrap([ptr, lanePtr](const boost::system::error_code &error) {
+            
+            // Note : Call by worker
+            
+            if (!error) {
+                ptr->onHandledTimeout(*lanePtr);
+            }
+        }));
+    }
+    
+    void ReliableAdapter::onHandledTimeout(Lane &lane) {
+        
+        // Note : (Must be) Call by worker
+        
+        auto current = now();
+        
+        while (!lane._handledHistory.empty() && lane._handledHistory.front().first <= current) {
+            lane._handledMessages.erase(lane._handledHistory.front().second);
+            lane._handledHistory.pop_front();
+        }
+        
+        // Wait for the next expiration
+        
+        if (!lane._handledHistory.empty()) {
+            armHandledTimer(lane, lane._handledHistory.front().first - current);
+        }
+    }
+    
+    void ReliableAdapter::onIncommingParity(Lane &lane,
+                                            const iTC::Parity &parity,
+                                            const WriteCallback &writeCallback) {
+        
+        // Note : (Must be) Call by worker
+        
+        // Parity is not acknowledged, just release the buffer
+        
+        if (writeCallback) {
+            writeCallback(nullptr);
+        }
+        
+        // Find the missing message (A single one can be rebuilt)
+        
+        auto &fec = lane._fec;
+        
+        size_t missingCount = 0;
+        iTC::MessageId missingId = 0;
+        
+        for (auto messageId : parity._payload._messageIds) {
+            if (fec._packets.find(messageId) == fec._packets.end()) {
+                missingId = messageId;
+                missingCount++;
+            }
+        }
+        
+        if (missingCount != 1 || lane._handledMessages.find(missingId) != lane._handledMessages.end()) {
+            return;
+        }
+        
+        // Rebuild the missing packet
+        
+        auto body = boost::asio::buffer_cast<const uint8_t*>(parity._payload._body);
+        auto packet = std::make_shared<std::vector<uint8_t> >(body, body + boost::asio::buffer_size(parity._payload._body));
+        uint32_t length = parity._payload._length;
+        
+        for (auto messageId : parity._payload._messageIds) {
+            
+            auto iterator = fec._packets.find(messageId);
+            if (iterator == fec._packets.end()) {
+                continue;
+            }
+            
+            const auto &received = iterator->second;
+            for (size_t index = 0; index < received.size() && index < packet->size(); index++) {
+                (*packet)[index] ^= received[index];
+            }
+            
+            length ^= static_cast<uint32_t>(received.size());
+        }
+        
+        if (length < ITC_MESSAGE_MINIMAL_SIZE || length > packet->size()) {
+            return;
+        }
+        
+        packet->resize(length);
+        
+        // Check header before handling it as a regular packet
+        
+        iTC::Header header;
+        decode(packet->data(), header);
+        
+        if (header._messageId != missingId || header._lane != lane._index) {
+            return;
+        }
+        
+        // Note : Not a received packet, only counted as recovered
+        
+        fec._stats._recovered++;
+        fec._stats._bytesRecovered += packet->size();
+        
+        handlePacket_internal(Buffer(packet->data(), packet->size()), [packet](const std::exception_ptr) { });
+    }
+    
+    void ReliableAdapter::deliver(Lane &lane,
+                                  iTC::MessageId messageId,
+                                  size_t span,
+                                  const std::vector<Buffer> &entries,
+                                  const WriteCallback &writeCallback) {
+        
+        // Note : (Must be) Call by worker
+        
+        if (_config._ordering._bufferSize == 0) {
+            forward(entries, writeCallback);
+            return;
+        }
+        
+        if (lane._ordering._failed) {
+            if (writeCallback) {
+                writeCallback(nullptr);
+            }
+            return;
+        }
+        
+        if (messageId == lane._ordering._expected) {
+            
+            // In order, forward it directly
+            lane._ordering._expected = iTC::advance(messageId, span);
+            forward(entries, writeCallback);
+            
+            // Release messages waiting for this one
+            deliverPending(lane);
+            
+        } else if (SerialLess()(messageId, lane._ordering._expected)) {
+            
+            // Too late, the message has been skipped
+            lane._ordering._stats._late++;
+            
+            if (writeCallback) {
+                writeCallback(nullptr);
+            }
+            
+        } else {
+            
+            // Too early, keep a copy until the hole is filled
+            auto pending = std::make_shared<PendingDelivery>();
+            
+            pending->_span      = span;
+            pending->_arrival   = now();
+            
+            for (const auto &entry : entries) {
+                auto data = boost::asio::buffer_cast<const uint8_t*>(entry);
+                pending->_entries.push_back(std::vector<uint8_t>(data, data + boost::asio::buffer_size(entry)));
+            }
+            
+            lane._ordering._buffer.insert(std::make_pair(messageId, pending));
+            
+            if (writeCallback) {
+                writeCallback(nullptr);
+            }
+            
+            // Update statistics
+            lane._ordering._stats._reordered++;
+            if (lane._ordering._buffer.size() > lane._ordering._stats._maxDepth) {
+                lane._ordering._stats._maxDepth = lane._ordering._buffer.size();
+            }
+            
+            if (lane._ordering._buffer.size() > _config._ordering._bufferSize) {
+                
+                // Buffer is full, resolve the hole right now
+                onHoleTimeout(lane);
+                
+            } else if (lane._ordering._buffer.size() == 1) {
+                
+                // A new hole has been detected
+                armHoleTimer(lane);
+            }
+        }
+    }
+    
+    void ReliableAdapter::forward(const std::vector<Buffer> &entries,
+                                  const WriteCallback &writeCallback) {
+        
+        // Note : (Must be) Call by worker
+        
+        _stats._delivered += entries.size();
+        
+        if (entries.size() == 1) {
+            _callbacks._onIncommingMessage(entries.front(), writeCallback);
+            return;
+        }
+        
+        // Our progress container
+        
+        struct Progress {
+            
+            size_t _remaining;
+            std::exception_ptr _error;
+            WriteCallback _handler;
+            
+        };
+        
+        auto progressPtr = std::make_shared<Progress>();
+        
+        progressPtr->_remaining = entries.size();
+        progressPtr->_error     = nullptr;
+        progressPtr->_handler   = writeCallback;
+        
+        // Forward each entry to user
+        
+        for (const auto &entry : entries) {
+            _callbacks._onIncommingMessage(entry, [progressPtr](const std::exception_ptr error) {
+                
+                if (error && !progressPtr->_error) {
+                    progressPtr->_error = error;
+                }
+                
+                if (--progressPtr->_remaining == 0 && progressPtr->_handler) {
+                    progressPtr->_handler(progressPtr->_error);
+                }
+            });
+        }
+    }
+    
+    void ReliableAdapter::forward(Lane &lane,
+                                  const PendingDelivery::Ptr &pending) {
+        
+        // Note : (Must be) Call by worker
+        
+        // Update statistics
+        
+        uint64_t blockedTime = now() - pending->_arrival;
+        
+        lane._ordering._stats._blockedTime += blockedTime;
+        if (blockedTime > lane._ordering._stats._maxBlockedTime) {
+            lane._ordering._stats._maxBlockedTime = blockedTime;
+        }
+        
+        // Forward copied entries
+        
+        std::vector<Buffer> entries;
+        for (const auto &entry : pending->_entries) {
+            entries.push_back(Buffer(entry.data(), entry.size()));
+        }
+        
+        forward(entries, [pending](const std::exception_ptr) { });
+    }
+    
+    void ReliableAdapter::deliverPending(Lane &lane) {
+        
+        // Note : (Must be) Call by worker
+        
+        auto iterator = lane._ordering._buffer.begin();
+        while (iterator != lane._ordering._buffer.end() && iterator->first == lane._ordering._expected) {
+            
+            auto pending = iterator->second;
+            
+            lane._ordering._buffer.erase(iterator);
+            lane._ordering._expected = iTC::advance(lane._ordering._expected, pending->_span);
+            
+            forward(lane, pending);
+            
+            iterator = lane._ordering._buffer.begin();
+        }
+        
+        // Progress has been made, restart the hole timer
+        armHoleTimer(lane);
+    }
+    
+    void ReliableAdapter::armHoleTimer(Lane &lane) {
+        
+        // Note : (Must be) Call by worker
+        
+        lane._ordering._sequence++;
+        lane._ordering._timer.cancel();
+        
+        if (lane._ordering._buffer.empty() || _config._ordering._holeTimeout == 0) {
+            return;
+        }
+        
+        auto ptr = shared_from_this();
+        auto lanePtr = _lanes[lane._index];
+        auto sequence = lane._ordering._sequence;
+        
+        lane._ordering._timer.expires_from_now(boost::posix_time::microseconds(_config._ordering._holeTimeout));
+        lane._ordering._timer.async_wait(_strand.wrap([ptr, lanePtr, sequence](const boost::system::error_code &error) {
+            
+            // Note : Call by worker
+            
+            if (!error && lanePtr->_ordering._sequence == sequence) {
+                ptr->onHoleTimeout(*lanePtr);
+            }
+        }));
+    }
+    
+    void ReliableAdapter::onHoleTimeout(Lane &lane) {
+        
+        // Note : (Must be) Call by worker
+        
+        if (lane._ordering._buffer.empty()) {
+            return;
+        }
+        
+        lane._ordering._stats._holeTimeouts++;
+        
+        if (_config._ordering._holePolicy == HolePolicy::Skip) {
+            
+            // Give up on missing messages
+            
+            auto head = lane._ordering._buffer.begin()->first;
+            
+            lane._ordering._stats._skipped += static_cast<iTC::MessageId>(head - lane._ordering._expected);
+            lane._ordering._expected = head;
+            
+            deliverPending(lane);
+            
+        } else {
+            
+            auto error = std::make_exception_ptr(std::runtime_error("Message N°" + std::to_string(lane._ordering._expected) + " of lane " + std::to_string(lane._index) + " is missing"));
+            
+            // Stop delivering messages
+            
+            lane._ordering._failed = true;
+            lane._ordering._buffer.clear();
+            lane._ordering._sequence++;
+            lane._ordering._timer.cancel();
+            
+            if (_callbacks._onReadError) {
+                _callbacks._onReadError(error);
+            }
+            
+            // Note : We may be processing an incomming packet
+            
+            auto ptr = shared_from_this();
+            _strand.post([ptr]() {
+                ptr->disconnect();
+            });
+        }
+    }
+    
+    ReliableAdapter::OrderingStats ReliableAdapter::getOrderingStats() const {
+        
+        OrderingStats result = { 0, 0, 0, 0, 0, 0, 0 };
+        
+        for (const auto &lanePtr : _lanes) {
+            
+            const auto &stats = lanePtr->_ordering._stats;
+            
+            result._reordered       += stats._reordered;
+            result._late            += stats._late;
+            result._skipped         += stats._skipped;
+            result._holeTimeouts    += stats._holeTimeouts;
+            result._blockedTime     += stats._blockedTime;
+            result._maxBlockedTime  = std::max<uint64_t>(result._maxBlockedTime, stats._maxBlockedTime);
+            result._maxDepth        = std::max<uint64_t>(result._maxDepth, stats._maxDepth);
+        }
+        
+        return result;
+    }
+    
+    ReliableAdapter::FecStats ReliableAdapter::getFecStats() const {
+        
+        FecStats result = { 0, 0, 0, 0 };
+        
+        for (const auto &lanePtr : _lanes) {
+            
+            const auto &stats = lanePtr->_fec._stats;
+            
+            result._protected       += stats._protected;
+            result._parities        += stats._parities;
+            result._recovered       += stats._recovered;
+            result._bytesRecovered  += stats._bytesRecovered;
+        }
+        
+        return result;
+    }
+    
+    ReliableAdapter::Stats ReliableAdapter::getStats() const {
+        return {
+            _stats._messagesSent,
+            _stats._retransmissions,
+            _stats._acknowledged,
+            _stats._timeouts,
+            _stats._packetsSent,
+            _stats._bytesSent,
+            _stats._packetsReceived,
+            _stats._bytesReceived,
+            _stats._invalidPackets,
+            _stats._acksSent,
+            _stats._acksReceived,
+            _stats._unmatchedAcks,
+            _stats._duplicates,
+            _stats._delivered,
+            _stats._rtt.snapshot(),
+            _stats._ackLatency.snapshot()
+        };
+    }
+    
+    void ReliableAdapter::logStats(uint64_t interval) {
+        
+        auto ptr = shared_from_this();
+        _strand.dispatch([ptr, interval]() {
+            
+            // Note : Call by worker
+            
+            ptr->_statsInterval = interval;
+            ptr->_statsTimer.cancel();
+            
+            if (interval != 0) {
+                ptr->armStatsTimer();
+            }
+        });
+    }
+    
+    void ReliableAdapter::armStatsTimer() {
+        
+        // Note : (Must be) call by worker
+        
+        _statsTimer.expires_from_now(boost::posix_time::microseconds(_statsInterval));
+        
+        auto ptr = shared_from_this();
+        _statsTimer.async_wait(_strand.wrap([ptr](const boost::system::error_code &error) {
+            
+            // Note : Call by worker
+            
+            if (error || ptr->_statsInterval == 0) {
+                return;
+            }
+            
+            auto stats = ptr->getStats();
+            
+            _networkLogger->info("ReliableAdapter : {} sent, {} retransmitted, {} acknowledged, {} timeouts, {} duplicates, {} delivered, "
+                                 "{} / {} packets sent / received ({} / {} bytes), {} invalid, {} / {} acks sent / received ({} unmatched), "
+                                 "rtt {} us median / {} us p99, ack latency {} us median / {} us p99",
+                                 stats._messagesSent, stats._retransmissions,
+                                 stats._acknowledged, stats._timeouts,
+                                 stats._duplicates, stats._delivered,
+                                 stats._packetsSent, stats._packetsReceived,
+                                 stats._bytesSent, stats._bytesReceived,
+                                 stats._invalidPackets,
+                                 stats._acksSent, stats._acksReceived, stats._unmatchedAcks,
+                                 stats._rtt.quantile(0.5), stats._rtt.quantile(0.99),
+                                 stats._ackLatency.quantile(0.5), stats._ackLatency.quantile(0.99));
+            
+            ptr->armStatsTimer();
+        }));
+    }
+    
+    bool ReliableAdapter::onIncommingAck(Lane &lane,
+                                         const iTC::Ack &ack) {
+        
+        // Note : (Must be) Call by worker
+        
+        _stats._acksReceived++;
+        
+        if (!lane._acks_Signal(ack)) {
+            _stats._unmatchedAcks++;
+            return false;
+        }
+        
+        return true;
+    }
+    
+    bool ReliableAdapter::cancel(Lane &lane,
+                                 iTC::MessageId messageId) {
+        
+        // Note : (Must be) Call by worker
+        
+        return lane._cancel_Signal(messageId);
+    }
+    
+    iTC::MessageId ReliableAdapter::getMessageId(Lane &lane) {
+        
+        unsigned int result = lane._messageId.fetch_add(1);
+        if (result != 0) {
+            return result;
+        } else {
+            return getMessageId(lane);
+        }
+    }
+    
+    void ReliableAdapter::disconnect() {
+        
+        // Note : Call by worker
+        
+        // Check state
+        if (_state != Started) {
+            return;
+        }
+        
+        // Drop queued messages (They are cancelled along with the others)
+        for (auto &lanePtr : _lanes) {
+            lanePtr->_queue.clear();
+        }
+        
+        // Cancel tasks
+        _disconnection_Signal();
+        
+        // Unereference user callbacks
+        _callbacks = Callbacks();
+        
+        for (auto &lanePtr : _lanes) {
+            
+            auto &lane = *lanePtr;
+            
+            // Cancel batched messages
+            if (lane._batch._data) {
+                
+                auto reason = std::make_exception_ptr(std::runtime_error("Reliable adapter stopped"));
+                
+                for (const auto &callback : lane._batch._callbacks) {
+                    if (callback) {
+                        callback(reason);
+                    }
+                }
+                
+                lane._batch._data = nullptr;
+                lane._batch._callbacks.clear();
+                lane._batch._sequence++;
+                lane._batch._timer.cancel();
+            }
+            
+            // Drop out of order messages
+            lane._ordering._buffer.clear();
+            lane._ordering._expected = 1;
+            lane._ordering._failed = false;
+            lane._ordering._sequence++;
+            lane._ordering._timer.cancel();
+            
+            // Drop parity state
+            lane._fec._parity.clear();
+            lane._fec._length = 0;
+            lane._fec._messageIds.clear();
+            lane._fec._sequence++;
+            lane._fec._timer.cancel();
+            lane._fec._lossRate = 0;
+            lane._fec._packets.clear();
+            lane._fec._history.clear();
+            
+            // Clear active messgae ID
+            lane._messageId = 0;
+            
+            // Clear handled messgaes map
+            lane._handledMessages.clear();
+            lane._handledHistory.clear();
+            lane._handledTimer.cancel();
+            
+            // Drop incomplete messages
+            for (auto &reassembly : lane._reassemblies) {
+                reassembly.second->_timer.cancel();
+            }
+            lane._reassemblies.clear();
+            
+            // Reset scheduling
+            lane._inFlight = 0;
+            lane._credit = 0;
+        }
         
-        // Clear active messgae ID
-        _messageId = 0;
+        inFlightMetric->sub(_inFlight);
+        _inFlight = 0;
         
-        // Clear handled messgaes map
-        _handledMessages.clear();
+        // Stop statistics log
+        _statsInterval = 0;
+        _statsTimer.cancel();
         
         // Update state
         _state = Stopped;
@@ -9,13 +9,23 @@
 
 #include <stdint.h>
 
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <map>
 #include <memory>
+#include <vector>
 
 #include <boost/asio/io_service.hpp>
 #include <boost/asio/strand.hpp>
 #include <boost/signals2/signal.hpp>
 
+#include <coreKit/Utils/Counter.hpp>
+#include <coreKit/Utils/Histogram.hpp>
+
 #include "Adapter.hpp"
+#include "Timer.hpp"
+#include "VirtualClock.hpp"
 
 namespace coreKit { namespace Network {
     
@@ -34,7 +44,10 @@ namespace coreKit { namespace Network {
         enum class PayloadType {
             
             Message     = 0,
-            Ack         = 1
+            Ack         = 1,
+            Fragment    = 2,
+            Batch       = 3,
+            Parity      = 4
             
         };
         
@@ -42,7 +55,8 @@ namespace coreKit { namespace Network {
         
         enum class AckCode {
             
-            Ok          = 0
+            Ok          = 0,
+            Rejected    = 1         // Can't be handled, the sender fails the message at once
             
         };
         
@@ -52,6 +66,7 @@ namespace coreKit { namespace Network {
             
             PayloadType _payloadType;
             MessageId   _messageId;
+            uint8_t     _lane;          // Priority lane (Each lane has its own message Ids)
             
         };
         
@@ -95,10 +110,34 @@ namespace coreKit { namespace Network {
                 
             };
             
+            // Fragment
+            
+            struct Fragment {
+                
+                uint8_t     _count;
+                MessageId   _groupId;   // Message Id of the first fragment
+                uint16_t    _index;
+                uint16_t    _total;
+                Buffer      _body;
+                
+            };
+            
+            // Parity (XOR of a group of packets)
+            
+            struct Parity {
+                
+                std::vector<MessageId>  _messageIds;    // Protected messages
+                uint32_t                _length;        // XOR of protected packets sizes
+                Buffer                  _body;          // XOR of protected packets (Count ignored)
+                
+            };
+            
         }
         
         using Ack = Packet<Payload::Ack>;
         using Message = Packet<Payload::Message>;
+        using Fragment = Packet<Payload::Fragment>;
+        using Parity = Packet<Payload::Parity>;
         
     }
     
@@ -120,6 +159,45 @@ namespace coreKit { namespace Network {
         
         using Ptr = std::shared_ptr<ReliableAdapter>;
         
+        // HolePolicy (What to do when a missing message blocks ordered delivery for too long)
+        
+        enum class HolePolicy {
+            
+            Skip        = 0,    // Give up on the missing message(s)
+            Fail        = 1     // Report an error and stop the adapter
+            
+        };
+        
+        // Scheduling (How lanes share the global window)
+        
+        enum class Scheduling {
+            
+            Strict      = 0,    // Lowest lane index first
+            Weighted    = 1     // Smooth weighted round robin
+            
+        };
+        
+        // LaneConfig
+        
+        struct LaneConfig {
+            
+            // Attributes
+            
+            // Maximum number of in flight messages (0 = unlimited)
+            
+            size_t _window;
+            
+            // Share of the global window under weighted scheduling
+            
+            unsigned int _weight;
+            
+            // Message timeouts in microseconds (Default to the adapter ones if 0 / empty)
+            
+            uint64_t _globalTimeout;
+            std::function<uint64_t(size_t)> _timeoutFunc;
+            
+        };
+        
         // Config
         
         struct Config {
@@ -136,6 +214,106 @@ namespace coreKit { namespace Network {
             
             std::function<uint64_t(size_t)> _timeoutFunc;
             
+            // Maximum packet size in bytes (Header included)
+            // Larger messages are fragmented, 0 disables fragmentation
+            
+            size_t _mtu;
+            
+            // Batching of small messages (Disabled if delay is 0)
+            
+            struct {
+                
+                uint64_t    _delay;     // Maximum time a message waits for its batch in microseconds
+                size_t      _size;      // Maximum batch body size in bytes
+                
+            } _batching;
+            
+            // Ordered delivery (Disabled if buffer size is 0)
+            
+            struct {
+                
+                size_t      _bufferSize;    // Maximum number of out of order messages kept
+                uint64_t    _holeTimeout;   // Maximum blocking time of a missing message in microseconds (0 waits for a full buffer)
+                HolePolicy  _holePolicy;
+                
+            } _ordering;
+            
+            // Priority lanes (Lane 0 is the highest priority)
+            // A single unlimited lane is used if empty
+            
+            struct {
+                
+                std::vector<LaneConfig> _lanes;
+                Scheduling              _scheduling;
+                size_t                  _window;    // Maximum number of in flight messages for all lanes (0 = unlimited)
+                
+            } _priority;
+            
+            // Forward error correction (Disabled if group size is 0)
+            // A parity packet lets the receiver rebuild one lost message per group
+            // Note : Parity packets may exceed the MTU by their own header
+            
+            struct {
+                
+                size_t      _groupSize;     // Number of messages per parity packet (Maximum one if adaptive)
+                bool        _adaptive;      // Shrink groups as the observed loss rate grows
+                uint64_t    _delay;         // Maximum time a partial group waits for its parity in microseconds (0 waits for a full group)
+                
+            } _fec;
+            
+            // Virtual time source (Real time if null)
+            
+            VirtualClock::Ptr _clock;
+            
+        };
+        
+        // OrderingStats
+        
+        struct OrderingStats {
+            
+            uint64_t _reordered;        // Messages buffered because they arrived early
+            uint64_t _late;             // Messages dropped because they were skipped
+            uint64_t _skipped;          // Message Ids given up on
+            uint64_t _holeTimeouts;     // Number of holes resolved by the hole policy
+            uint64_t _blockedTime;      // Total time spent by messages in the reorder buffer in microseconds
+            uint64_t _maxBlockedTime;   // Maximum time spent by a message in the reorder buffer in microseconds
+            uint64_t _maxDepth;         // Maximum reorder buffer occupancy
+            
+        };
+        
+        // FecStats
+        
+        struct FecStats {
+            
+            uint64_t _protected;        // Messages covered by a parity packet
+            uint64_t _parities;         // Parity packets sent
+            uint64_t _recovered;        // Messages rebuilt from a parity packet (Not counted as received)
+            uint64_t _bytesRecovered;
+            
+        };
+        
+        // Stats
+        
+        struct Stats {
+            
+            uint64_t _messagesSent;     // Reliable packets sent for the first time
+            uint64_t _retransmissions;  // Reliable packets sent again on timeout
+            uint64_t _acknowledged;     // Reliable packets acknowledged
+            uint64_t _timeouts;         // Reliable packets given up on
+            uint64_t _packetsSent;      // Packets handed to the lower layer (Acks and parities included)
+            uint64_t _bytesSent;
+            uint64_t _packetsReceived;  // Packets received from the lower layer
+            uint64_t _bytesReceived;
+            uint64_t _invalidPackets;   // Packets failing to decode
+            uint64_t _acksSent;
+            uint64_t _acksReceived;
+            uint64_t _unmatchedAcks;    // Acks matching no pending packet (Late or duplicated)
+            uint64_t _duplicates;       // Packets received twice (Acked again, not delivered)
+            uint64_t _delivered;        // Messages forwarded to user
+            
+            Histogram::Snapshot _rtt;           // First send to ack of never retransmitted packets in microseconds
+            Histogram::Snapshot _ackLatency;    // Enqueue to ack in microseconds (Window wait and retransmissions included)
+            
         };
         
         // Init
@@ -156,6 +334,30 @@ namespace coreKit { namespace Network {
         void handleOutgoingData(const Buffer &buffer,
                                 const WriteCallback &writeCallback) override;
         
+        // Send data on a specific lane (The Adapter interface uses lane 0)
+        
+        void handleOutgoingData(const Buffer &buffer,
+                                uint8_t lane,
+                                const WriteCallback &writeCallback);
+        
+        // Ordered delivery statistics (Thread safe)
+        
+        OrderingStats getOrderingStats() const;
+        
+        // Forward error correction statistics (Thread safe)
+        
+        FecStats getFecStats() const;
+        
+        // Statistics (Thread safe)
+        
+        Stats getStats() const;
+        
+        // Log statistics every interval microseconds (0 stops it)
+        
+        // Note : On a virtual clock, the periodic log keeps the clock running until stopped
+        
+        void logStats(uint64_t interval);
+        
     private:
         
         // Private declations
@@ -179,7 +381,8 @@ namespace coreKit { namespace Network {
             
             // Methods
             
-            HandledMessage(const iTC::Message &message,
+            HandledMessage(iTC::MessageId messageId,
+                           uint8_t lane,
                            iTC::AckCode code);
             
             iTC::Ack makeAck();
@@ -190,6 +393,10 @@ namespace coreKit { namespace Network {
             
             iTC::MessageId   _messageId;
             
+            // The message lane
+            
+            uint8_t         _lane;
+            
             // The ack code for this message
             
             iTC::AckCode    _ackCode;
@@ -202,6 +409,198 @@ namespace coreKit { namespace Network {
             
         };
         
+        // Reassembly
+        
+        struct Reassembly {
+            
+            // Declarations
+            
+            using Ptr = std::shared_ptr<Reassembly>;
+            
+            // Methods
+            
+            Reassembly(boost::asio::io_service &ioService,
+                       const VirtualClock::Ptr &clock,
+                       uint16_t total);
+            
+            // Attributes
+            
+            // Received fragments (Indexed by fragment index)
+            
+            std::vector<std::vector<uint8_t> > _fragments;
+            
+            // Number of received fragments
+            
+            uint16_t _received;
+            
+            // Total size of received bodies
+            
+            size_t _size;
+            
+            // Incomplete message expiration
+            
+            Timer _timer;
+            
+        };
+        
+        // Batch
+        
+        struct Batch {
+            
+            // Methods
+            
+            Batch(boost::asio::io_service &ioService,
+                  const VirtualClock::Ptr &clock);
+            
+            // Attributes
+            
+            // Encoded entries
+            
+            std::shared_ptr<std::vector<uint8_t> > _data;
+            
+            // Entries write callbacks
+            
+            std::vector<WriteCallback> _callbacks;
+            
+            // Flush timer
+            
+            Timer _timer;
+            
+            // Incremented on each flush
+            
+            uint32_t _sequence;
+            
+        };
+        
+        // SerialLess (Message Ids comparison, wrap around aware)
+        
+        struct SerialLess {
+            
+            bool operator()(iTC::MessageId lhs,
+                            iTC::MessageId rhs) const {
+                return static_cast<int32_t>(lhs - rhs) < 0;
+            }
+            
+        };
+        
+        // PendingDelivery (Message waiting in the reorder buffer)
+        
+        struct PendingDelivery {
+            
+            // Declarations
+            
+            using Ptr = std::shared_ptr<PendingDelivery>;
+            
+            // Attributes
+            
+            // Number of message Ids covered (Fragments)
+            
+            size_t _span;
+            
+            // Copied entries
+            
+            std::vector<std::vector<uint8_t> > _entries;
+            
+            // Arrival time in microseconds
+            
+            uint64_t _arrival;
+            
+        };
+        
+        // Ordering
+        
+        struct Ordering {
+            
+            // Methods
+            
+            Ordering(boost::asio::io_service &ioService,
+                     const VirtualClock::Ptr &clock);
+            
+            // Attributes
+            
+            // Next message Id to be delivered
+            
+            iTC::MessageId _expected;
+            
+            // Out of order messages
+            
+            std::map<iTC::MessageId, PendingDelivery::Ptr, SerialLess> _buffer;
+            
+            // Hole timer
+            
+            Timer _timer;
+            
+            // Incremented each time the hole timer is rearmed
+            
+            uint32_t _sequence;
+            
+            // Set once a hole made the adapter fail
+            
+            bool _failed;
+            
+            // Statistics
+            
+            struct {
+                
+                std::atomic<uint64_t> _reordered;
+                std::atomic<uint64_t> _late;
+                std::atomic<uint64_t> _skipped;
+                std::atomic<uint64_t> _holeTimeouts;
+                std::atomic<uint64_t> _blockedTime;
+                std::atomic<uint64_t> _maxBlockedTime;
+                std::atomic<uint64_t> _maxDepth;
+                
+            } _stats;
+            
+        };
+        
+        // Fec
+        
+        struct Fec {
+            
+            // Methods
+            
+            Fec(boost::asio::io_service &ioService,
+                const VirtualClock::Ptr &clock);
+            
+            // Attributes
+            
+            // Parity being computed
+            
+            std::vector<uint8_t> _parity;
+            uint32_t _length;
+            std::vector<iTC::MessageId> _messageIds;
+            
+            // Flush timer
+            
+            Timer _timer;
+            
+            // Incremented on each flush
+            
+            uint32_t _sequence;
+            
+            // Estimated loss rate (Share of retransmissions)
+            
+            double _lossRate;
+            
+            // Recently received packets (Count ignored)
+            
+            std::map<iTC::MessageId, std::vector<uint8_t> > _packets;
+            std::deque<iTC::MessageId> _history;
+            
+            // Statistics
+            
+            struct {
+                
+                std::atomic<uint64_t> _protected;
+                std::atomic<uint64_t> _parities;
+                std::atomic<uint64_t> _recovered;
+                std::atomic<uint64_t> _bytesRecovered;
+                
+            } _stats;
+            
+        };
+        
         // AckResult
         
         struct AckResult {
@@ -224,14 +623,145 @@ namespace coreKit { namespace Network {
             
         };
         
+        // Lane (Independent message Ids, window and queue)
+        
+        struct Lane {
+            
+            // Declarations
+            
+            using Ptr = std::shared_ptr<Lane>;
+            
+            // Methods
+            
+            Lane(boost::asio::io_service &ioService,
+                 const VirtualClock::Ptr &clock,
+                 uint8_t index,
+                 const LaneConfig &config);
+            
+            // Attributes
+            
+            // Lane index (Priority)
+            
+            const uint8_t _index;
+            
+            // Lane config
+            
+            const LaneConfig _config;
+            
+            // Active message Id
+            
+            std::atomic_uint _messageId;
+            
+            // Here are all handled messages
+            
+            std::map<iTC::MessageId, HandledMessage::Ptr> _handledMessages;
+            
+            // Handled messages expiration (Expiration time and message Id, in handling order)
+            
+            std::deque<std::pair<uint64_t, iTC::MessageId> > _handledHistory;
+            Timer _handledTimer;
+            
+            // Here are all messages being reassembled (Indexed by group Id)
+            
+            std::map<iTC::MessageId, Reassembly::Ptr> _reassemblies;
+            
+            // Outgoing batch being filled
+            
+            Batch _batch;
+            
+            // Ordered delivery state
+            
+            Ordering _ordering;
+            
+            // Forward error correction state
+            
+            Fec _fec;
+            
+            // Messages waiting for a window slot
+            
+            std::deque<std::shared_ptr<ReliableTask> > _queue;
+            
+            // Number of in flight messages
+            
+            size_t _inFlight;
+            
+            // Weighted scheduling credit
+            
+            int64_t _credit;
+            
+            // Acknowledgment handling
+            
+            boost::signals2::signal<bool(const iTC::Ack&), AckResult> _acks_Signal;
+            
+            // Task abortion handling
+            
+            boost::signals2::signal<bool(iTC::MessageId), AckResult> _cancel_Signal;
+            
+        };
+        
         // Private methods
         
         void handleIncommingData_internal(const Buffer &buffer,
                                           const WriteCallback &writeCallback);
+        void handlePacket_internal(const Buffer &buffer,
+                                   const WriteCallback &writeCallback);
         
         void handleOutgoingData_internal(const Buffer &buffer,
+                                         uint8_t lane,
                                          const WriteCallback &writeCallback);
         
+        // Outgoing message handling
+        
+        void sendReliable(Lane &lane,
+                          const Buffer &body,
+                          iTC::MessageId messageId,
+                          iTC::PayloadType payloadType,
+                          const WriteCallback &writeCallback,
+                          const iTC::Payload::Fragment *fragment = nullptr);
+        
+        void sendFragmented(Lane &lane,
+                            const Buffer &buffer,
+                            const WriteCallback &writeCallback);
+        
+        // Lanes scheduling
+        
+        void schedule();
+        
+        Lane* nextLane();
+        
+        void start(const std::shared_ptr<ReliableTask> &taskPtr);
+        
+        void release(const ReliableTask &task);
+        
+        // Batching
+        
+        bool isBatchable(size_t bodySize) const;
+        
+        void sendBatched(Lane &lane,
+                         const Buffer &buffer,
+                         const WriteCallback &writeCallback);
+        
+        void flushBatch(Lane &lane);
+        
+        // Forward error correction
+        
+        void protect(Lane &lane,
+                     iTC::MessageId messageId,
+                     const uint8_t *packet,
+                     size_t packetSize);
+        
+        void flushParity(Lane &lane);
+        
+        size_t groupSize(const Lane &lane) const;
+        
+        void updateLossRate(Lane &lane,
+                            bool retransmission);
+        
+        void remember(Lane &lane,
+                      iTC::MessageId messageId,
+                      const uint8_t *packet,
+                      size_t packetSize);
+        
         // Helpers
         
         void send(std::shared_ptr<uint8_t> buffer,
@@ -244,24 +774,86 @@ namespace coreKit { namespace Network {
         void send(const iTC::Ack &ack,
                   const WriteCallback &writeCallback);
         
+        void send(const iTC::Fragment &fragment,
+                  const WriteCallback &writeCallback);
+        
+        void send(const iTC::Parity &parity,
+                  const WriteCallback &writeCallback);
+        
         static uint64_t defaultTimeoutFunc(size_t count);
         
-        uint64_t timeoutFunc(size_t count);
+        uint64_t timeoutFunc(const Lane &lane,
+                             size_t count);
+        
+        uint64_t globalTimeout(const Lane &lane) const;
+        
+        // Current time in microseconds (Virtual if a clock is set)
+        
+        uint64_t now() const;
         
         // Functions to be call to handle incomming data
         
-        void onIncommingMessage(const iTC::Message &message,
+        void onIncommingMessage(Lane &lane,
+                                const iTC::Message &message,
                                 const WriteCallback &writeCallback);
         
-        bool onIncommingAck(const iTC::Ack &ack);
+        void onIncommingFragment(Lane &lane,
+                                 const iTC::Fragment &fragment,
+                                 const WriteCallback &writeCallback);
+        
+        void onIncommingBatch(Lane &lane,
+                              const iTC::Message &batch,
+                              const std::vector<Buffer> &entries,
+                              const WriteCallback &writeCallback);
+        
+        void onIncommingParity(Lane &lane,
+                               const iTC::Parity &parity,
+                               const WriteCallback &writeCallback);
+        
+        // Delivery to user (Ordered per lane if enabled)
+        
+        void deliver(Lane &lane,
+                     iTC::MessageId messageId,
+                     size_t span,
+                     const std::vector<Buffer> &entries,
+                     const WriteCallback &writeCallback);
+        
+        void forward(const std::vector<Buffer> &entries,
+                     const WriteCallback &writeCallback);
+        
+        void forward(Lane &lane,
+                     const PendingDelivery::Ptr &pending);
+        
+        void deliverPending(Lane &lane);
+        
+        HandledMessage::Ptr handled(Lane &lane,
+                                    iTC::MessageId messageId,
+                                    iTC::AckCode code);
+        
+        void armHandledTimer(Lane &lane,
+                             uint64_t delay);
+        
+        void onHandledTimeout(Lane &lane);
+        
+        void armHoleTimer(Lane &lane);
+        
+        void onHoleTimeout(Lane &lane);
+        
+        bool onIncommingAck(Lane &lane,
+                            const iTC::Ack &ack);
         
         // Cancel a specific task
         
-        bool cancel(iTC::MessageId messageId);
+        bool cancel(Lane &lane,
+                    iTC::MessageId messageId);
         
         // Message Ids generator
         
-        iTC::MessageId getMessageId();
+        iTC::MessageId getMessageId(Lane &lane);
+        
+        // Periodic statistics log
+        
+        void armStatsTimer();
         
         // Disconnection handling
         
@@ -285,21 +877,42 @@ namespace coreKit { namespace Network {
         
         Adapter::Callbacks _callbacks;
         
-        // Active message Id
+        // Priority lanes
         
-        std::atomic_uint _messageId;
+        std::vector<Lane::Ptr> _lanes;
         
-        // Here are all handled messages
+        // Number of in flight messages (All lanes)
         
-        std::map<iTC::MessageId, HandledMessage::Ptr> _handledMessages;
+        size_t _inFlight;
         
-        // Acknowledgment handling
+        // Statistics (Written by worker only)
         
-        boost::signals2::signal<bool(const iTC::Ack&), AckResult> _acks_Signal;
+        struct {
+            
+            Counter _messagesSent;
+            Counter _retransmissions;
+            Counter _acknowledged;
+            Counter _timeouts;
+            Counter _packetsSent;
+            Counter _bytesSent;
+            Counter _packetsReceived;
+            Counter _bytesReceived;
+            Counter _invalidPackets;
+            Counter _acksSent;
+            Counter _acksReceived;
+            Counter _unmatchedAcks;
+            Counter _duplicates;
+            Counter _delivered;
+            
+            Histogram _rtt;
+            Histogram _ackLatency;
+            
+        } _stats;
         
-        // Task abortion handling
+        // Periodic statistics log
         
-        boost::signals2::signal<bool(iTC::MessageId), AckResult> _cancel_Signal;
+        Timer _statsTimer;
+        uint64_t _statsInterval;
         
         // Disconnection handling
         
@@ -0,0 +1,66 @@
+//
+//  Timer.cpp
+//  coreKit
+//
+//
+
+#include "Timer.hpp"
+
+namespace coreKit { namespace Network {
+    
+    // Timer
+    
+    Timer::Timer(boost::asio::io_service &ioService,
+                 const VirtualClock::Ptr &clock) :
+    
+    _timer      (ioService),
+    _clock      (clock),
+    _deadline   (0)
+    
+    { }
+    
+    Timer::~Timer() {
+        if (_clock) {
+            cancel();
+        }
+    }
+    
+    void Timer::expires_from_now(const boost::posix_time::time_duration &duration) {
+        
+        if (!_clock) {
+            _timer.expires_from_now(duration);
+            return;
+        }
+        
+        // Note : Like deadline_timer, pending waits are cancelled
+        
+        cancel();
+        
+        _deadline = _clock->now() + std::max<int64_t>(duration.total_microseconds(), 0);
+    }
+    
+    void Timer::async_wait(const Handler &handler) {
+        
+        if (!_clock) {
+            _timer.async_wait(handler);
+            return;
+        }
+        
+        _events.push_back(_clock->schedule(_deadline, handler));
+    }
+    
+    void Timer::cancel() {
+        
+        if (!_clock) {
+            _timer.cancel();
+            return;
+        }
+        
+        for (const auto &event : _events) {
+            _clock->cancel(event);
+        }
+        
+        _events.clear();
+    }
+    
+} }
@@ -0,0 +1,61 @@
+//
+//  Timer.hpp
+//  coreKit
+//
+//
+
+#pragma once
+
+#include <vector>
+
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/io_service.hpp>
+
+#include "VirtualClock.hpp"
+
+namespace coreKit { namespace Network {
+    
+    // Timer (Subset of boost::asio::deadline_timer, real or virtual time)
+    
+    class Timer {
+    
+    public:
+        
+        // Declarations
+        
+        using Handler = VirtualClock::Handler;
+        
+        // Init (Real time if clock is null)
+        
+        Timer(boost::asio::io_service &ioService,
+              const VirtualClock::Ptr &clock);
+        
+        ~Timer();
+        
+        // deadline_timer interface
+        
+        void expires_from_now(const boost::posix_time::time_duration &duration);
+        
+        void async_wait(const Handler &handler);
+        
+        void cancel();
+    
+    private:
+        
+        // Attributes
+        
+        // Real time
+        
+        boost::asio::deadline_timer _timer;
+        
+        // Virtual time
+        
+        VirtualClock::Ptr _clock;
+        
+        uint64_t _deadline;
+        
+        std::vector<VirtualClock::Event> _events;
+        
+    };
+    
+} }
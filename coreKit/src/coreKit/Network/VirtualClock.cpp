@@ -0,0 +1,98 @@
+//
+//  VirtualClock.cpp
+//  coreKit
+//
+//
+
+#include "VirtualClock.hpp"
+
+#include <boost/asio/error.hpp>
+
+namespace coreKit { namespace Network {
+    
+    // VirtualClock
+    
+    VirtualClock::VirtualClock(boost::asio::io_service &ioService) :
+    
+    _ioService  (ioService),
+    _now        (0),
+    _sequence   (0)
+    
+    { }
+    
+    uint64_t VirtualClock::now() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _now;
+    }
+    
+    size_t VirtualClock::run(uint64_t until) {
+        
+        size_t result = 0;
+        
+        while (true) {
+            
+            // Run every ready handler first
+            
+            _ioService.reset();
+            _ioService.poll();
+            
+            // Then jump to the next deadline
+            
+            Handler handler;
+            
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                
+                auto iterator = _events.begin();
+                if (iterator == _events.end() || iterator->first.first > until) {
+                    break;
+                }
+                
+                if (iterator->first.first > _now) {
+                    _now = iterator->first.first;
+                }
+                
+                handler = iterator->second;
+                _events.erase(iterator);
+            }
+            
+            handler(boost::system::error_code());
+            result++;
+        }
+        
+        return result;
+    }
+    
+    VirtualClock::Event VirtualClock::schedule(uint64_t deadline,
+                                               const Handler &handler) {
+        
+        std::lock_guard<std::mutex> lock(_mutex);
+        
+        auto event = Event(deadline, _sequence++);
+        _events.insert(std::make_pair(event, handler));
+        
+        return event;
+    }
+    
+    bool VirtualClock::cancel(const Event &event) {
+        
+        Handler handler;
+        
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            
+            auto iterator = _events.find(event);
+            if (iterator == _events.end()) {
+                return false;
+            }
+            
+            handler = iterator->second;
+            _events.erase(iterator);
+        }
+        
+        _ioService.post(std::bind(handler, boost::system::error_code(boost::asio::error::operation_aborted)));
+        
+        return true;
+    }
+    
+} }
@@ -0,0 +1,88 @@
+//
+//  VirtualClock.hpp
+//  coreKit
+//
+//
+
+#pragma once
+
+#include <stdint.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/system/error_code.hpp>
+
+namespace coreKit { namespace Network {
+    
+    // VirtualClock (Discrete event time source for emulated links)
+    
+    // Note : Timers bound to a virtual clock never wait for real time,
+    // the clock jumps to the next deadline once the io service is idle.
+    // The io service must only be run through the clock, from a single thread.
+    
+    class VirtualClock {
+    
+    public:
+        
+        // Declarations
+        
+        using Ptr = std::shared_ptr<VirtualClock>;
+        using Handler = std::function<void(const boost::system::error_code&)>;
+        
+        // Event (Deadline in microseconds, insertion order)
+        
+        using Event = std::pair<uint64_t, uint64_t>;
+        
+        // Init
+        
+        VirtualClock(boost::asio::io_service &ioService);
+        
+        // Current time in microseconds (Starts at 0)
+        
+        uint64_t now() const;
+        
+        // Run handlers and events until there is nothing left to do,
+        // or until the next event is after the given time
+        // Returns the number of fired events
+        
+        size_t run(uint64_t until = UINT64_MAX);
+        
+        // Events handling (Thread safe)
+        
+        Event schedule(uint64_t deadline,
+                       const Handler &handler);
+        
+        // Cancelled handlers are posted with operation_aborted
+        
+        bool cancel(const Event &event);
+    
+    private:
+        
+        // Attributes
+        
+        boost::asio::io_service &_ioService;
+        
+        // Protects everything below
+        
+        mutable std::mutex _mutex;
+        
+        // Current time
+        
+        uint64_t _now;
+        
+        // Pending events (Sorted by deadline then insertion order)
+        
+        std::map<Event, Handler> _events;
+        
+        // Insertion counter
+        
+        uint64_t _sequence;
+        
+    };
+    
+} }
@@ -8,9 +8,11 @@
 
 #include "Handler.hpp"
 
+#include <chrono>
 #include <future>
 
 #include <coreKit/Config/Config.hpp>
+#include <coreKit/Metrics/Registry.hpp>
 
 #include "Declarations.hpp"
 
@@ -22,6 +24,13 @@ static const coreKit::ConfigList configList({ "coreKit", "Service" }, {
     
 });
 
+// Metrics (Durations in microseconds)
+
+static const auto startDurationMetric           = coreKit::Metrics::Registry::histogram({ "coreKit", "Service", "Handler", "StartDuration" });
+static const auto stopDurationMetric            = coreKit::Metrics::Registry::histogram({ "coreKit", "Service", "Handler", "StopDuration" });
+static const auto serviceStartDurationMetric    = coreKit::Metrics::Registry::histogram({ "coreKit", "Service", "Handler", "ServiceStartDuration" });
+static const auto serviceStopDurationMetric     = coreKit::Metrics::Registry::histogram({ "coreKit", "Service", "Handler", "ServiceStopDuration" });
+
 namespace coreKit {
     
     namespace Service {
@@ -40,6 +49,10 @@ namespace coreKit {
             return policy;
         }
         
+        static uint64_t steadyTime() {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+        
         // HandlerStatus
         
         std::string HandlerStatus::toString() const {
@@ -97,12 +110,16 @@ namespace coreKit {
             
             std::exception_ptr exceptionPtr = nullptr;
             
+            auto startTime = steadyTime();
+            
             try {
                 start_internal();
             } catch (...) {
                 exceptionPtr = std::current_exception();
             }
             
+            startDurationMetric->record(steadyTime() - startTime);
+            
             {
                 std::lock_guard<std::mutex> lock(_mutex);
                 if (exceptionPtr) {
@@ -120,7 +137,7 @@ namespace coreKit {
             
             // Build the dependency graph
             auto graph = _registryPtr->buildDependencyGraph();
-            _serviceLogger->debug("Dependency graph : \n{}", graph.toString());
+            COREKIT_LOG_DEBUG(_serviceLogger, "Dependency graph : \n{}", graph.toString());
             
             if (graph._startOrder.size() == 0) {
                 _serviceLogger->warn("No service to start");
@@ -137,7 +154,7 @@ namespace coreKit {
                 size_t slot = 0;
                 for (StartOrder::const_iterator it_vec = startOrder.begin(); it_vec != startOrder.end(); it_vec++) {
                     
-                    _serviceLogger->debug("Starting services attached to time slot N°{}", slot);
+                    COREKIT_LOG_DEBUG(_serviceLogger, "Starting services attached to time slot N°{}", slot);
                     
                     std::map<Id, std::exception_ptr> errors;
                     
@@ -198,9 +215,9 @@ namespace coreKit {
                                 lastKnownReason = "Unknown error | Please check use of exception(s)";
                             }
                             
-                            _serviceLogger->error("An error occurs while starting service {} : [{}]",
-                                                  lastKnownServiceInfo,
-                                                  lastKnownReason);
+                            COREKIT_LOG_ERROR(_serviceLogger, "An error occurs while starting service {} : [{}]",
+                                              lastKnownServiceInfo,
+                                              lastKnownReason);
                         }
                         
                         stop_internal(slot);
@@ -239,8 +256,12 @@ namespace coreKit {
                 _state = HandlerStopping;
             }
             
+            auto stopTime = steadyTime();
+            
             stop_internal();
             
+            stopDurationMetric->record(steadyTime() - stopTime);
+            
             {
                 std::lock_guard<std::mutex> lock(_mutex);
                 _state = HandlerIdle;
@@ -278,7 +299,7 @@ namespace coreKit {
                 StartOrder::const_iterator it_vec = startOrder.begin();
                 std::advance(it_vec, slot);
                 
-                _serviceLogger->debug("Stopping services attached to time slot N°{}", slot);
+                COREKIT_LOG_DEBUG(_serviceLogger, "Stopping services attached to time slot N°{}", slot);
                 
                 if (it_vec->size() == 1) {
                     const Id id = it_vec->front();
@@ -301,7 +322,7 @@ namespace coreKit {
                     }
                 }
                 
-                _serviceLogger->debug("Services attached to time slot N°{} are now stopped", slot);
+                COREKIT_LOG_DEBUG(_serviceLogger, "Services attached to time slot N°{} are now stopped", slot);
                 
                 if (slot == 0) {
                     break;
@@ -347,17 +368,26 @@ namespace coreKit {
                 
                 Container newContainer(factoryPtr);
                 
-                _serviceLogger->debug("Automatically creating (dependency) service {}",
-                                      newContainer.formatServiceInfo());
+                COREKIT_LOG_DEBUG(_serviceLogger, "Automatically creating (dependency) service {}",
+                                                  newContainer.formatServiceInfo());
                 
                 servicePtr = subscribe_internal(newContainer);
             }
             
+            auto startTime = steadyTime();
+            
             _registryPtr->startService(id);
+            
+            serviceStartDurationMetric->record(steadyTime() - startTime);
         }
         
         void Handler::stopService_internal(const Id &id) {
+            
+            auto stopTime = steadyTime();
+            
             _registryPtr->stopService(id);
+            
+            serviceStopDurationMetric->record(steadyTime() - stopTime);
         }
         
     }
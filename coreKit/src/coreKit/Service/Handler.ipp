@@ -44,7 +44,7 @@ namespace coreKit {
         
         template <class T, class... Args> std::shared_ptr<T> Handler::subscribe_internal(Args&&... args) {
             
-            _serviceLogger->debug("Creating service {}", Registry::formatServiceInfo<T>());
+            COREKIT_LOG_DEBUG(_serviceLogger, "Creating service {}", Registry::formatServiceInfo<T>());
             
             std::shared_ptr<T> ptr = std::make_shared<T>(std::forward<Args>(args)...);
             subscribe_internal(Container(ptr));
@@ -92,7 +92,7 @@ namespace coreKit {
                                          "' is already registered");
             }
             
-            _serviceLogger->debug("Subscribing service {}", container.formatServiceInfo());
+            COREKIT_LOG_DEBUG(_serviceLogger, "Subscribing service {}", container.formatServiceInfo());
             
             _containers.insert(std::make_pair(id, container));
         }
@@ -160,13 +160,13 @@ namespace coreKit {
             
             auto serviceInfo = formatServiceInfo(it->second.getName(), id);
             
-            _serviceLogger->debug("Starting service {}",
-                                  serviceInfo);
+            COREKIT_LOG_DEBUG(_serviceLogger, "Starting service {}",
+                                              serviceInfo);
             
             it->second._ptr->start();
             
-            _serviceLogger->debug("Service {} is now started",
-                                  serviceInfo);
+            COREKIT_LOG_DEBUG(_serviceLogger, "Service {} is now started",
+                                              serviceInfo);
         }
         
         // Stop service
@@ -186,13 +186,13 @@ namespace coreKit {
             
             auto serviceInfo = formatServiceInfo(it->second.getName(), id);
             
-            _serviceLogger->debug("Stopping service {}",
-                                  serviceInfo);
+            COREKIT_LOG_DEBUG(_serviceLogger, "Stopping service {}",
+                                              serviceInfo);
             
             it->second._ptr->stop();
             
-            _serviceLogger->debug("Service {} is now stopped",
-                                  serviceInfo);
+            COREKIT_LOG_DEBUG(_serviceLogger, "Service {} is now stopped",
+                                              serviceInfo);
         }
         
         std::vector<Status> Registry::getSericesStatus() {
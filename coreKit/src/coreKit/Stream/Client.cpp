@@ -106,7 +106,25 @@ namespace coreKit {
                           const Session::WriteCallback &writeCallback) {
             _strand.dispatch(std::bind(&Client::send_internal, shared_from_this(),
                                        buffers,
-                                       writeCallback));
+                                       writeCallback,
+                                       Session::traceSend(buffers)));
+        }
+        
+        uint64_t Client::getCorruptions() {
+            
+            std::promise<uint64_t> promise;
+            auto future = promise.get_future();
+            
+            _strand.post([this, &promise]() {
+                
+                if (_state != Connected) {
+                    promise.set_exception(std::make_exception_ptr(std::runtime_error("Client is not connected")));
+                } else {
+                    promise.set_value(_sessionPtr->getCorruptions());
+                }
+            });
+            
+            return future.get();
         }
         
         void Client::open_internal(const Callbacks &callbacks,
@@ -205,7 +223,7 @@ namespace coreKit {
                                 ptr->_onDisonnection_Connection = ptr->_disconnection_Signal.connect(callbacks._onConnectionClose, boost::signals2::connect_position::at_front);
                             }
                             
-                            ptr->onSocketConnected(callbacks._onDataReceived);
+                            ptr->onSocketConnected(callbacks);
                             
                             taskPtr->_finished = true;
                             taskPtr->_handler(nullptr);
@@ -236,7 +254,8 @@ namespace coreKit {
         }
         
         void Client::send_internal(const Session::Buffers &buffers,
-                                   const Session::WriteCallback &writeCallback) {
+                                   const Session::WriteCallback &writeCallback,
+                                   uint64_t traceId) {
             
             // Note : Call by worker
             
@@ -249,10 +268,10 @@ namespace coreKit {
                 return;
             }
             
-            _sessionPtr->Session::send(buffers, writeCallback);
+            _sessionPtr->Session::send(buffers, writeCallback, traceId);
         }
         
-        void Client::onSocketConnected(const Session::OnDataReceived &onDataReceived) {
+        void Client::onSocketConnected(const Callbacks &callbacks) {
             
             // Note : Call by worker
             
@@ -261,8 +280,10 @@ namespace coreKit {
             
             // Session callbacks
             Session::Callbacks sessionCallbacks = {
-                onDataReceived,
-                _strand.wrap(std::bind(&Client::onReadError, shared_from_this(), std::placeholders::_1))
+                callbacks._onDataReceived,
+                _strand.wrap(std::bind(&Client::onReadError, shared_from_this(), std::placeholders::_1)),
+                callbacks._compression,
+                callbacks._framing
             };
             
             // Start reader
@@ -370,6 +391,10 @@ namespace coreKit {
             _clientPtr->send(buffers, writeCallback);
         }
         
+        uint64_t ScopedClient::getCorruptions() {
+            return _clientPtr->getCorruptions();
+        }
+        
         // Factory
         
         Client::Ptr makeClient(const std::string &remoteUri) {
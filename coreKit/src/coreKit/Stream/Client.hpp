@@ -50,6 +50,14 @@ namespace coreKit {
                 
                 OnConnectionClose           _onConnectionClose;
                 
+                // Compression settings (Negotiated once connected)
+                
+                Session::Compression        _compression;
+                
+                // Framing (Must match the server)
+                
+                Session::Framing            _framing;
+                
             };
             
             // Interface declarations
@@ -69,6 +77,10 @@ namespace coreKit {
             virtual void send(const Session::Buffers &buffers,
                               const Session::WriteCallback &writeCallback) = 0;
             
+            // Corrupted frames dropped by the current session
+            
+            virtual uint64_t getCorruptions() = 0;
+            
         };
         
         // Client
@@ -108,6 +120,10 @@ namespace coreKit {
             void send(const Session::Buffers &buffers,
                       const Session::WriteCallback &writeCallback) override;
             
+            // Corrupted frames dropped by the current session
+            
+            uint64_t getCorruptions() override;
+            
         protected:
             
             // Protected attributes
@@ -142,11 +158,12 @@ namespace coreKit {
                                uint64_t timeout_ms);
             
             void send_internal(const Session::Buffers &buffers,
-                               const Session::WriteCallback &writeCallback);
+                               const Session::WriteCallback &writeCallback,
+                               uint64_t traceId);
             
             // Callbacks / Disconnection handling
             
-            void onSocketConnected(const Session::OnDataReceived &onDataReceived);
+            void onSocketConnected(const Callbacks &callbacks);
             
             void onDisconnection(const std::exception_ptr cause);
             
@@ -208,6 +225,10 @@ namespace coreKit {
             void send(const Session::Buffers &buffers,
                       const Session::WriteCallback &writeCallback) override;
             
+            // Corrupted frames dropped by the current session
+            
+            uint64_t getCorruptions() override;
+            
         private:
             
             // Attributes
@@ -45,6 +45,10 @@ namespace coreKit {
                       const std::function<void(const boost::system::error_code&,
                                                size_t)> &handler) override;
             
+            void readSome(boost::asio::mutable_buffer &buffer,
+                          const std::function<void(const boost::system::error_code&,
+                                                   size_t)> &handler) override;
+            
             // Write operations
             
             void write(const Buffers &buffers,
@@ -42,6 +42,12 @@ namespace coreKit {
             boost::asio::async_read(_socket, boost::asio::buffer(buffer), _strand.wrap(handler));
         }
         
+        template <class Socket>
+        void SessionImpl<Socket>::readSome(boost::asio::mutable_buffer &buffer,
+                                           const std::function<void(const boost::system::error_code&, size_t)> &handler) {
+            _socket.async_read_some(boost::asio::buffer(buffer), _strand.wrap(handler));
+        }
+        
         template <class Socket>
         void SessionImpl<Socket>::write(const Buffers &buffers,
                                         const std::function<void(const boost::system::error_code&, size_t)> &handler) {
@@ -200,11 +200,13 @@ namespace coreKit {
                           const Session::WriteCallback &writeCallback) {
             _strand.dispatch(std::bind((void(Server::*)(SessionId,
                                                         const Session::Buffers&,
-                                                        const Session::WriteCallback&)) &Server::send_internal,
+                                                        const Session::WriteCallback&,
+                                                        uint64_t)) &Server::send_internal,
                                        shared_from_this(),
                                        sessionId,
                                        buffers,
-                                       writeCallback));
+                                       writeCallback,
+                                       Session::traceSend(buffers)));
         }
         
         void Server::send(const Session::Buffers &buffers,
@@ -216,6 +218,24 @@ namespace coreKit {
                                        writeCallback));
         }
         
+        uint64_t Server::getCorruptions(SessionId sessionId) {
+            
+            std::promise<uint64_t> promise;
+            auto future = promise.get_future();
+            
+            _strand.post([this, sessionId, &promise]() {
+                
+                auto iterator = _sessions._map.find(sessionId);
+                if (iterator == _sessions._map.end()) {
+                    promise.set_exception(std::make_exception_ptr(std::runtime_error("Unknown session")));
+                } else {
+                    promise.set_value(iterator->second.first->getCorruptions());
+                }
+            });
+            
+            return future.get();
+        }
+        
         void Server::onNewSession(Session::Ptr sessionPtr,
                                   const boost::system::error_code &error) {
             
@@ -244,7 +264,13 @@ namespace coreKit {
                     _strand.wrap(std::bind(&Server::onReadError,
                                            shared_from_this(),
                                            sessionId,
-                                           std::placeholders::_1))
+                                           std::placeholders::_1)),
+                    
+                    // Compression
+                    _callbacks._compression,
+                    
+                    // Framing
+                    _callbacks._framing
                     
                 };
                 
@@ -337,7 +363,8 @@ namespace coreKit {
         
         void Server::send_internal(SessionId sessionId,
                                    const Session::Buffers &buffers,
-                                   const Session::WriteCallback &writeCallback) {
+                                   const Session::WriteCallback &writeCallback,
+                                   uint64_t traceId) {
             
             // Note : Call by worker
             
@@ -353,7 +380,7 @@ namespace coreKit {
                 } else {
                     
                     auto sessionsPtr = iterator->second.first;
-                    sessionsPtr->Session::send(buffers, writeCallback);
+                    sessionsPtr->Session::send(buffers, writeCallback, traceId);
                 }
                 
             } else {
@@ -515,6 +542,10 @@ namespace coreKit {
             _serverPtr->send(buffers, writeCallback);
         }
         
+        uint64_t ScopedServer::getCorruptions(SessionId sessionId) {
+            return _serverPtr->getCorruptions(sessionId);
+        }
+        
         // Factory
         
         Server::Ptr makeServer(const std::string &localUri) {
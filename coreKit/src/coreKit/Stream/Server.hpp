@@ -66,6 +66,14 @@ namespace coreKit {
                 
                 OnSessionDisconnected   _onSessionDisconnected;
                 
+                // Compression settings (Negotiated with each session)
+                
+                Session::Compression    _compression;
+                
+                // Framing (Must match the clients)
+                
+                Session::Framing        _framing;
+                
             };
             
             // Server Interface
@@ -99,6 +107,10 @@ namespace coreKit {
             virtual void send(const Session::Buffers &buffers,
                               const Session::WriteCallback &writeCallback) = 0;
             
+            // Corrupted frames dropped by a specific session
+            
+            virtual uint64_t getCorruptions(SessionId sessionId) = 0;
+            
         };
         
         // Server
@@ -152,6 +164,10 @@ namespace coreKit {
             void send(const Session::Buffers &buffers,
                       const Session::WriteCallback &writeCallback) override;
             
+            // Corrupted frames dropped by a specific session
+            
+            uint64_t getCorruptions(SessionId sessionId) override;
+            
         protected:
             
             // Protected attributes
@@ -201,7 +217,8 @@ namespace coreKit {
             
             void send_internal(SessionId sessionId,
                                const Session::Buffers &buffers,
-                               const Session::WriteCallback &writeCallback);
+                               const Session::WriteCallback &writeCallback,
+                               uint64_t traceId);
             
             void send_internal(const Session::Buffers &buffers,
                                const Session::WriteCallback &writeCallback);
@@ -319,6 +336,10 @@ namespace coreKit {
             void send(const Session::Buffers &buffers,
                       const Session::WriteCallback &writeCallback) override;
             
+            // Corrupted frames dropped by a specific session
+            
+            uint64_t getCorruptions(SessionId sessionId) override;
+            
         private:
             
             // Attributes
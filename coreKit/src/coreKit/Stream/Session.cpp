@@ -8,14 +8,83 @@
 
 #include "Session.hpp"
 
+#include <chrono>
+#include <cstring>
 #include <iostream>
 
 #include <boost/asio/ip/tcp.hpp>
 
+#include <coreKit/Metrics/Registry.hpp>
+#include <coreKit/Metrics/Trace.hpp>
+#include <coreKit/Utils/Crc.hpp>
+
 #ifndef PROTO_HEADER_SIZE
 #define PROTO_HEADER_SIZE   sizeof(uint32_t)
 #endif
 
+// Checked header (Magic, header check, length word, payload CRC-32C)
+
+#define PROTO_CHECKED_HEADER_SIZE   12
+#define PROTO_CHECKED_MAGIC_0       0xC3
+#define PROTO_CHECKED_MAGIC_1       0x5A
+#define PROTO_CHECKED_LENGTH_OFFSET 4
+#define PROTO_CHECKED_CRC_OFFSET    8
+
+// Header flags (Within the length word)
+
+#define PROTO_FLAG_COMPRESSED   0x80000000U
+#define PROTO_FLAG_CONTROL      0x40000000U
+#define PROTO_LENGTH_MASK       0x3FFFFFFFU
+
+// Compressed payload (Raw size followed by the compressed block)
+
+#define PROTO_RAW_SIZE_SIZE     sizeof(uint32_t)
+
+// Compression announcement (Magic, version, decodable codecs mask, codec used to send, dictionary)
+
+#define PROTO_HELLO_MAGIC       "CKZ"
+#define PROTO_HELLO_MAGIC_SIZE  3
+#define PROTO_HELLO_VERSION     1
+#define PROTO_HELLO_SIZE        7
+#define PROTO_DECODABLE_CODECS  (1 << static_cast<uint8_t>(Session::Codec::Lz4))
+
+#define TRACE_CATEGORY          "coreKit.Stream.Session"
+
+// Metrics (Shared by all sessions)
+
+static const auto sessionsMetric        = coreKit::Metrics::Registry::gauge({ "coreKit", "Stream", "Session", "Active" });
+static const auto queueDepthMetric      = coreKit::Metrics::Registry::gauge({ "coreKit", "Stream", "Session", "QueueDepth" });
+static const auto bytesSentMetric       = coreKit::Metrics::Registry::counter({ "coreKit", "Stream", "Session", "BytesSent" });
+static const auto bytesReceivedMetric   = coreKit::Metrics::Registry::counter({ "coreKit", "Stream", "Session", "BytesReceived" });
+static const auto framesSentMetric      = coreKit::Metrics::Registry::counter({ "coreKit", "Stream", "Session", "FramesSent" });
+static const auto framesReceivedMetric  = coreKit::Metrics::Registry::counter({ "coreKit", "Stream", "Session", "FramesReceived" });
+static const auto sendLatencyMetric     = coreKit::Metrics::Registry::histogram({ "coreKit", "Stream", "Session", "SendLatency" });
+static const auto compressedMetric      = coreKit::Metrics::Registry::counter({ "coreKit", "Stream", "Session", "FramesCompressed" });
+static const auto rawBytesMetric        = coreKit::Metrics::Registry::counter({ "coreKit", "Stream", "Session", "BytesBeforeCompression" });
+static const auto corruptedMetric       = coreKit::Metrics::Registry::counter({ "coreKit", "Stream", "Session", "FramesCorrupted" });
+
+static uint64_t steadyTime() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static inline void write32(uint8_t *data, uint32_t value) {
+    value = htonl(value);
+    memcpy(data, &value, sizeof(value));
+}
+
+static inline uint32_t read32(const uint8_t *data) {
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return ntohl(value);
+}
+
+static inline uint16_t headerCheck(const uint8_t *header) {
+    
+    // Note : Covers the length word and the payload CRC
+    
+    return static_cast<uint16_t>(coreKit::crc32c(0, header + PROTO_CHECKED_LENGTH_OFFSET, 2 * sizeof(uint32_t)));
+}
+
 namespace coreKit {
     
     namespace Stream {
@@ -38,9 +107,13 @@ namespace coreKit {
         // Session::Node
         
         Session::Node::Node(const Buffers &data,
-                            const WriteCallback &writeCallback) :
+                            const WriteCallback &writeCallback,
+                            uint64_t traceId) :
         _data(data),
-        _writeCallback(writeCallback)
+        _writeCallback(writeCallback),
+        _control(false),
+        _queuedTime(steadyTime()),
+        _traceId(traceId)
         
         { }
         
@@ -52,7 +125,20 @@ namespace coreKit {
         
         // Session
         
-        Session::Session() : _current(nullptr) { }
+        Session::Session() : _framing(Framing::Length), _corruptions(0), _current(nullptr) {
+            
+            _header._readSize = 0;
+            _header._lost = false;
+            
+            _compression._helloSent = false;
+            
+            sessionsMetric->add(1);
+        }
+        
+        Session::~Session() {
+            sessionsMetric->sub(1);
+            queueDepthMetric->sub(_queue.size());
+        }
         
         void Session::read(const Callbacks &callbacks) {
             getStrand().dispatch(std::bind(&Session::read_internal, shared_from_this(),
@@ -60,10 +146,33 @@ namespace coreKit {
         }
         
         void Session::send(const Buffers &buffers,
-                           const WriteCallback &writeCallback) {
+                           const WriteCallback &writeCallback,
+                           uint64_t traceId) {
+            
+            if (Metrics::Trace::isEnabled() && traceId == 0) {
+                traceId = traceSend(buffers);
+            }
+            
             getStrand().dispatch(std::bind(&Session::send_internal, shared_from_this(),
                                            buffers,
-                                           writeCallback));
+                                           writeCallback,
+                                           traceId));
+        }
+        
+        uint64_t Session::traceSend(const Buffers &buffers) {
+            
+            if (!Metrics::Trace::isEnabled()) {
+                return 0;
+            }
+            
+            auto traceId = Metrics::Trace::nextId();
+            Metrics::Trace::record(TRACE_CATEGORY, Metrics::Trace::Stage::Send, traceId, static_cast<uint32_t>(buffers.getBufferSize()));
+            
+            return traceId;
+        }
+        
+        uint64_t Session::getCorruptions() const {
+            return _corruptions.load(std::memory_order_relaxed);
         }
         
         void Session::read_internal(const Callbacks &callbacks) {
@@ -73,25 +182,78 @@ namespace coreKit {
             // Save callbacks
             
             _callbacks = callbacks;
+            _framing = callbacks._framing;
+            
+            // Announce compression support (Raw sessions have no control frame)
+            
+            if (_callbacks._compression._codec != Codec::None && _framing != Framing::Raw && !_compression._helloSent) {
+                sendHello();
+            }
             
             // Start reader
             
-            boost::asio::mutable_buffer buffer(&_header._read, PROTO_HEADER_SIZE);
-            read(buffer, std::bind(&Session::readHeader, shared_from_this(),
-                                   std::placeholders::_1,
-                                   std::placeholders::_2));
+            requestHeader();
         }
         
         void Session::send_internal(const Buffers &buffers,
-                                    const WriteCallback &writeCallback) {
+                                    const WriteCallback &writeCallback,
+                                    uint64_t traceId) {
             
             // Note : Call by worker
             
-            auto node = std::make_shared<Node>(buffers, writeCallback);
+            Metrics::Trace::record(TRACE_CATEGORY, Metrics::Trace::Stage::Enqueue, traceId, static_cast<uint32_t>(_queue.size()));
+            
+            auto node = std::make_shared<Node>(buffers, writeCallback, traceId);
             
             send(node);
         }
         
+        void Session::requestHeader() {
+            
+            // Note : Call by worker
+            
+            if (_framing == Framing::Raw) {
+                
+                // Whatever is available
+                boost::asio::mutable_buffer buffer(_readBuffer, sizeof(_readBuffer));
+                readSome(buffer, std::bind(&Session::readRaw, shared_from_this(),
+                                           std::placeholders::_1,
+                                           std::placeholders::_2));
+                return;
+            }
+            
+            size_t headerSize = (_framing == Framing::Checked ? PROTO_CHECKED_HEADER_SIZE : PROTO_HEADER_SIZE);
+            
+            boost::asio::mutable_buffer buffer(_header._read + _header._readSize, headerSize - _header._readSize);
+            read(buffer, std::bind(&Session::readHeader, shared_from_this(),
+                                   std::placeholders::_1,
+                                   std::placeholders::_2));
+        }
+        
+        void Session::readRaw(const boost::system::error_code &error,
+                              size_t bytesTransferred) {
+            
+            // Note : Call by worker
+            
+            if (!error) {
+                
+                bytesReceivedMetric->add(bytesTransferred);
+                
+                Metrics::Trace::record(TRACE_CATEGORY, Metrics::Trace::Stage::Receive, 0, static_cast<uint32_t>(bytesTransferred));
+                
+                if (_callbacks._onDataReceived) {
+                    _callbacks._onDataReceived(_readBuffer, bytesTransferred);
+                }
+                
+                // Read again ...
+                requestHeader();
+                
+            } else {
+                
+                onReadError(error);
+            }
+        }
+        
         void Session::readHeader(const boost::system::error_code &error,
                                  size_t) {
             
@@ -99,11 +261,34 @@ namespace coreKit {
             
             if (!error) {
                 
-                // Convert into host byte order
-                _header._read = ntohl(_header._read);
+                if (_framing == Framing::Checked) {
+                    
+                    if (!checkHeader()) {
+                        resynchronize();
+                        requestHeader();
+                        return;
+                    }
+                    
+                    _header._length = read32(_header._read + PROTO_CHECKED_LENGTH_OFFSET);
+                    _header._crc = read32(_header._read + PROTO_CHECKED_CRC_OFFSET);
+                    
+                } else {
+                    
+                    // Convert into host byte order
+                    _header._length = read32(_header._read);
+                }
+                
+                _header._readSize = 0;
+                _header._lost = false;
+                
+                size_t length = _header._length & PROTO_LENGTH_MASK;
+                if (length > sizeof(_readBuffer)) {
+                    onReadError(boost::asio::error::message_size);
+                    return;
+                }
                 
                 // Request the payload ...
-                boost::asio::mutable_buffer buffer(_readBuffer, _header._read);
+                boost::asio::mutable_buffer buffer(_readBuffer, length);
                 read(buffer, std::bind(&Session::readPayload, shared_from_this(),
                                        std::placeholders::_1,
                                        std::placeholders::_2));
@@ -121,15 +306,48 @@ namespace coreKit {
             
             if (!error) {
                 
-                if (_callbacks._onDataReceived) {
-                    _callbacks._onDataReceived(_readBuffer, bytesTransferred);
+                bytesReceivedMetric->add((_framing == Framing::Checked ? PROTO_CHECKED_HEADER_SIZE : PROTO_HEADER_SIZE) + bytesTransferred);
+                
+                // Drop corrupted payloads (The header was valid, the next one follows)
+                
+                if (_framing == Framing::Checked && crc32c(0, _readBuffer, bytesTransferred) != _header._crc) {
+                    
+                    _corruptions++;
+                    corruptedMetric->add();
+                    
+                    requestHeader();
+                    return;
+                }
+                
+                framesReceivedMetric->add();
+                
+                Metrics::Trace::record(TRACE_CATEGORY, Metrics::Trace::Stage::Receive, 0, static_cast<uint32_t>(bytesTransferred));
+                
+                // Note : Raw frames are given from the read buffer, compressed ones from the decoder window
+                
+                const void *data = _readBuffer;
+                size_t dataLength = bytesTransferred;
+                
+                if (_header._length & PROTO_FLAG_CONTROL) {
+                    
+                    onHello(_readBuffer, bytesTransferred);
+                    data = nullptr;
+                    
+                } else if (_header._length & PROTO_FLAG_COMPRESSED) {
+                    
+                    data = decompress(dataLength);
+                    if (!data) {
+                        onReadError(boost::system::errc::make_error_code(boost::system::errc::bad_message));
+                        return;
+                    }
+                }
+                
+                if (data && _callbacks._onDataReceived) {
+                    _callbacks._onDataReceived(data, dataLength);
                 }
                 
                 // Request the header ...
-                boost::asio::mutable_buffer buffer(&_header._read, PROTO_HEADER_SIZE);
-                read(buffer, std::bind(&Session::readHeader, shared_from_this(),
-                                       std::placeholders::_1,
-                                       std::placeholders::_2));
+                requestHeader();
                 
             } else {
                 
@@ -147,6 +365,7 @@ namespace coreKit {
                 
                 auto node = _queue.front();
                 _queue.pop();
+                queueDepthMetric->sub(1);
                 
                 node->operator()(std::make_exception_ptr(boost::system::system_error(boost::asio::error::operation_aborted)));
             }
@@ -163,10 +382,19 @@ namespace coreKit {
             _callbacks = Callbacks();
         }
         
-        void Session::onWriteCallback(const boost::system::error_code &error, size_t) {
+        void Session::onWriteCallback(const boost::system::error_code &error,
+                                      size_t bytesTransferred) {
             
             // Note : Call by worker
             
+            if (!error) {
+                framesSentMetric->add();
+                bytesSentMetric->add(bytesTransferred);
+                sendLatencyMetric->record(steadyTime() - _current->_queuedTime);
+            }
+            
+            Metrics::Trace::record(TRACE_CATEGORY, Metrics::Trace::Stage::WriteComplete, _current->_traceId, static_cast<uint32_t>(bytesTransferred));
+            
             {
                 // Call user callback
                 
@@ -190,6 +418,7 @@ namespace coreKit {
                 // Get a node from the queue
                 auto node = _queue.front();
                 _queue.pop();
+                queueDepthMetric->sub(1);
                 
                 // Process the node
                 process(node);
@@ -204,16 +433,52 @@ namespace coreKit {
             // Erase current node
             _current = node;
             
-            // Build header
-            _header._write = static_cast<uint32_t>(_current->_data.getBufferSize());
+            Metrics::Trace::record(TRACE_CATEGORY, Metrics::Trace::Stage::Dequeue, _current->_traceId);
+            
+            // Compress payload (Control frames are never compressed)
+            uint32_t flags = 0;
+            if (_current->_control) {
+                flags = PROTO_FLAG_CONTROL;
+            } else if (_compression._encoder && compress(*_current)) {
+                flags = PROTO_FLAG_COMPRESSED;
+            }
+            
+            // Build header (Network byte order)
+            auto length = static_cast<uint32_t>(_current->_data.getBufferSize());
+            size_t headerSize = PROTO_HEADER_SIZE;
             
-            // Convert to network byte order
-            _header._write = htonl(_header._write);
+            if (_framing == Framing::Checked) {
+                
+                uint32_t crc = 0;
+                for (const auto &buffer : _current->_data._container) {
+                    crc = crc32c(crc, boost::asio::buffer_cast<const void*>(buffer), boost::asio::buffer_size(buffer));
+                }
+                
+                write32(_header._write + PROTO_CHECKED_LENGTH_OFFSET, length | flags);
+                write32(_header._write + PROTO_CHECKED_CRC_OFFSET, crc);
+                
+                auto check = headerCheck(_header._write);
+                
+                _header._write[0] = PROTO_CHECKED_MAGIC_0;
+                _header._write[1] = PROTO_CHECKED_MAGIC_1;
+                _header._write[2] = static_cast<uint8_t>(check >> 8);
+                _header._write[3] = static_cast<uint8_t>(check);
+                
+                headerSize = PROTO_CHECKED_HEADER_SIZE;
+                
+            } else if (_framing == Framing::Length) {
+                write32(_header._write, length | flags);
+            } else {
+                headerSize = 0;
+            }
             
-            // Insert header into buffers
-            _current->_data._container.insert(_current->_data._container.begin(), Buffer(&_header._write, PROTO_HEADER_SIZE));
+            // Insert header into buffers (Raw data has none)
+            if (headerSize != 0) {
+                _current->_data._container.insert(_current->_data._container.begin(), Buffer(_header._write, headerSize));
+            }
             
             // Here it is
+            Metrics::Trace::record(TRACE_CATEGORY, Metrics::Trace::Stage::WriteStart, _current->_traceId, length);
             write(_current->_data._container,
                   std::bind(&Session::onWriteCallback, shared_from_this(),
                             std::placeholders::_1,
@@ -235,6 +500,195 @@ namespace coreKit {
                 // Add the node into the queue
                 
                 _queue.push(node);
+                queueDepthMetric->add(1);
+            }
+        }
+        
+        bool Session::checkHeader() {
+            
+            // Note : Call by worker
+            
+            const auto header = _header._read;
+            
+            if (header[0] != PROTO_CHECKED_MAGIC_0 || header[1] != PROTO_CHECKED_MAGIC_1) {
+                return false;
+            }
+            
+            auto check = headerCheck(header);
+            
+            if (header[2] != static_cast<uint8_t>(check >> 8) || header[3] != static_cast<uint8_t>(check)) {
+                return false;
+            }
+            
+            // Note : A valid check with an impossible length is still a corruption
+            
+            return (read32(header + PROTO_CHECKED_LENGTH_OFFSET) & PROTO_LENGTH_MASK) <= sizeof(_readBuffer);
+        }
+        
+        void Session::resynchronize() {
+            
+            // Note : Call by worker
+            
+            // Count the corruption once, not once per byte skipped
+            
+            if (!_header._lost) {
+                _header._lost = true;
+                _corruptions++;
+                corruptedMetric->add();
+            }
+            
+            // Keep the bytes from the next possible marker
+            
+            size_t offset = 1;
+            while (offset < PROTO_CHECKED_HEADER_SIZE &&
+                   !(_header._read[offset] == PROTO_CHECKED_MAGIC_0 &&
+                     (offset + 1 == PROTO_CHECKED_HEADER_SIZE || _header._read[offset + 1] == PROTO_CHECKED_MAGIC_1))) {
+                offset++;
+            }
+            
+            _header._readSize = PROTO_CHECKED_HEADER_SIZE - offset;
+            memmove(_header._read, _header._read + offset, _header._readSize);
+        }
+        
+        void Session::sendHello() {
+            
+            // Note : Call by worker
+            
+            const auto &settings = _callbacks._compression;
+            auto hello = _compression._hello;
+            
+            memcpy(hello, PROTO_HELLO_MAGIC, PROTO_HELLO_MAGIC_SIZE);
+            hello[3] = PROTO_HELLO_VERSION;
+            hello[4] = (settings._codec != Codec::None ? PROTO_DECODABLE_CODECS : 0);     // None while disabled
+            hello[5] = static_cast<uint8_t>(settings._codec);
+            hello[6] = (settings._dictionary ? 1 : 0);
+            
+            auto node = std::make_shared<Node>(Buffer(hello, PROTO_HELLO_SIZE), nullptr, 0);
+            node->_control = true;
+            
+            _compression._helloSent = true;
+            
+            send(node);
+        }
+        
+        void Session::onHello(const uint8_t *data,
+                              size_t dataLength) {
+            
+            // Note : Call by worker
+            
+            // Unknown announcements are ignored (Frames stay raw)
+            
+            if (dataLength < PROTO_HELLO_SIZE ||
+                memcmp(data, PROTO_HELLO_MAGIC, PROTO_HELLO_MAGIC_SIZE) != 0 ||
+                data[3] < PROTO_HELLO_VERSION) {
+                return;
+            }
+            
+            const auto &settings = _callbacks._compression;
+            
+            // Frames from the peer
+            
+            if (static_cast<Codec>(data[5]) == Codec::Lz4) {
+                _compression._decoder.reset(new Lz4::Decoder(data[6] != 0));
+            }
+            
+            // Frames to the peer
+            
+            if (settings._codec == Codec::Lz4 && (data[4] & (1 << static_cast<uint8_t>(Codec::Lz4)))) {
+                _compression._encoder.reset(new Lz4::Encoder(settings._dictionary));
+            }
+            
+            // Let the peer know what we support
+            
+            if (!_compression._helloSent) {
+                sendHello();
+            }
+        }
+        
+        bool Session::compress(Node &node) {
+            
+            // Note : Call by worker
+            
+            const auto &settings = _callbacks._compression;
+            auto &container = node._data._container;
+            auto size = node._data.getBufferSize();
+            
+            if (size < settings._threshold || size > sizeof(_readBuffer)) {
+                return false;
+            }
+            
+            // Gather the frame if needed
+            
+            const void *source = nullptr;
+            
+            if (container.size() == 1) {
+                source = boost::asio::buffer_cast<const void*>(container.front());
+            } else {
+                
+                if (_compression._input.size() < size) {
+                    _compression._input.resize(size);
+                }
+                
+                boost::asio::buffer_copy(boost::asio::buffer(_compression._input), container);
+                source = _compression._input.data();
+            }
+            
+            // Compress
+            
+            auto &output = _compression._output;
+            
+            if (output.size() < PROTO_RAW_SIZE_SIZE + Lz4::compressBound(size)) {
+                output.resize(PROTO_RAW_SIZE_SIZE + Lz4::compressBound(size));
+            }
+            
+            uint32_t rawSize = htonl(static_cast<uint32_t>(size));
+            memcpy(output.data(), &rawSize, PROTO_RAW_SIZE_SIZE);
+            
+            auto compressedSize = _compression._encoder->compress(source, size, output.data() + PROTO_RAW_SIZE_SIZE);
+            
+            // Note : With a dictionary, the peer must decode every block we compressed, even the larger ones
+            
+            if (!settings._dictionary && PROTO_RAW_SIZE_SIZE + compressedSize >= size) {
+                return false;
+            }
+            
+            compressedMetric->add();
+            rawBytesMetric->add(size);
+            
+            // The frame now points to our output buffer (Only one frame is written at a time)
+            
+            container.assign(1, Buffer(output.data(), PROTO_RAW_SIZE_SIZE + compressedSize));
+            
+            return true;
+        }
+        
+        const void* Session::decompress(size_t &dataLength) {
+            
+            // Note : Call by worker
+            
+            if (!_compression._decoder || dataLength < PROTO_RAW_SIZE_SIZE) {
+                return nullptr;
+            }
+            
+            uint32_t rawSize;
+            memcpy(&rawSize, _readBuffer, PROTO_RAW_SIZE_SIZE);
+            rawSize = ntohl(rawSize);
+            
+            // Note : Decompressed frames are bounded as raw ones
+            
+            if (rawSize > sizeof(_readBuffer)) {
+                return nullptr;
+            }
+            
+            try {
+                
+                auto result = _compression._decoder->decompress(&_readBuffer[PROTO_RAW_SIZE_SIZE], dataLength - PROTO_RAW_SIZE_SIZE, rawSize);
+                dataLength = rawSize;
+                
+                return result;
+                
+            } catch (const std::exception&) {
+                return nullptr;
             }
         }
         
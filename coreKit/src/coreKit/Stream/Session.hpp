@@ -10,6 +10,7 @@
 
 #include <stdint.h>
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <queue>
@@ -19,6 +20,8 @@
 #include <boost/asio/io_service.hpp>
 #include <boost/asio/strand.hpp>
 
+#include <coreKit/Utils/Lz4.hpp>
+
 namespace coreKit {
     
     namespace Stream {
@@ -44,6 +47,51 @@ namespace coreKit {
             template <class T>
             using ContainerType     = std::vector<T>;
             
+            // Compression
+            
+            enum class Codec : uint8_t {
+                
+                None    = 0,
+                Lz4     = 1
+                
+            };
+            
+            // Note : Both peers announce what they can decode when the session starts,
+            // frames are compressed only once the peer accepted the codec (Zero initialized means disabled, both ways).
+            // Peers must both support the announcement, it is only sent when compression is requested or answered.
+            
+            struct Compression {
+                
+                // Attributes
+                
+                // Codec used to send frames (None announces no decodable codec, the peer then sends raw frames)
+                
+                Codec           _codec;
+                
+                // Frames smaller than this (in bytes) are sent raw
+                
+                size_t          _threshold;
+                
+                // Use the previous frames as a dictionary (Helps small and repetitive frames)
+                
+                bool            _dictionary;
+                
+            };
+            
+            // Framing
+            
+            // Note : Checked frames start with a magic marker and carry a header check and a CRC-32C of the payload,
+            // corrupted frames are dropped and the reader resynchronizes on the next marker. Both peers must use the same framing.
+            // Raw sessions carry no header, data is given as it is read and sent as is (For foreign protocols, no compression).
+            
+            enum class Framing : uint8_t {
+                
+                Length  = 0,    // Length only
+                Raw     = 1,
+                Checked = 2
+                
+            };
+            
             // Callbacks
             
             struct Callbacks {
@@ -58,6 +106,14 @@ namespace coreKit {
                 
                 OnReadError     _onReadError;
                 
+                // Compression settings
+                
+                Compression     _compression;
+                
+                // Framing
+                
+                Framing         _framing;
+                
             };
             
             // Buffers
@@ -74,6 +130,7 @@ namespace coreKit {
             // Init
             
             Session();
+            virtual ~Session();
             
             /* Non-copyable.*/
             Session(const Session&) = delete;
@@ -85,10 +142,19 @@ namespace coreKit {
             
             void read(const Callbacks &callbacks);
             
-            // Send data
+            // Send data (Trace id given by the owner when the send went through its own strand first)
             
             void send(const Buffers &buffers,
-                      const WriteCallback &writeCallback);
+                      const WriteCallback &writeCallback,
+                      uint64_t traceId = 0);
+            
+            // Trace a send request (Returns the frame id, 0 if tracing is disabled)
+            
+            static uint64_t traceSend(const Buffers &buffers);
+            
+            // Number of corrupted frames dropped so far (Checked framing only)
+            
+            uint64_t getCorruptions() const;
             
             // Close session
             
@@ -113,7 +179,8 @@ namespace coreKit {
                 using Ptr = std::shared_ptr<Node>;
                 
                 Node(const Buffers &data,
-                     const WriteCallback &writeCallback);
+                     const WriteCallback &writeCallback,
+                     uint64_t traceId);
                 
                 /* Non-copyable.*/
                 Node(const Node&) = delete;
@@ -123,6 +190,9 @@ namespace coreKit {
                 
                 Buffers         _data;
                 WriteCallback   _writeCallback;
+                bool            _control;       // Session control frame (Never compressed)
+                uint64_t        _queuedTime;    // Steady time of the send request in microseconds
+                uint64_t        _traceId;       // Frame id (0 if not traced)
                 
             };
             
@@ -131,13 +201,22 @@ namespace coreKit {
             void read_internal(const Callbacks &callbacks);
             
             void send_internal(const Buffers &buffers,
-                               const WriteCallback &writeCallback);
+                               const WriteCallback &writeCallback,
+                               uint64_t traceId);
             
             // Read operationd
             
             virtual void read(boost::asio::mutable_buffer &buffer,
                               const std::function<void(const boost::system::error_code&, size_t)> &handler) = 0;
             
+            virtual void readSome(boost::asio::mutable_buffer &buffer,
+                                  const std::function<void(const boost::system::error_code&, size_t)> &handler) = 0;
+            
+            void requestHeader();
+            
+            void readRaw(const boost::system::error_code &error,
+                         size_t bytesTransferred);
+            
             void readHeader(const boost::system::error_code &error,
                             size_t bytesTransferred);
             
@@ -146,6 +225,12 @@ namespace coreKit {
             
             void onReadError(const boost::system::error_code &error);
             
+            // Integrity handling
+            
+            bool checkHeader();
+            
+            void resynchronize();
+            
             // Write operations
             
             virtual void write(const Buffers &buffers,
@@ -158,6 +243,17 @@ namespace coreKit {
             
             void send(Node::Ptr &node);
             
+            // Compression handling
+            
+            void sendHello();
+            
+            void onHello(const uint8_t *data,
+                         size_t dataLength);
+            
+            bool compress(Node &node);
+            
+            const void* decompress(size_t &dataLength);
+            
             // Attributes
             
             // User callbacks
@@ -168,15 +264,28 @@ namespace coreKit {
             
             uint8_t                 _readBuffer[UINT16_MAX];
             
-            // Header buffer
+            // Framing in use
+            
+            Framing                 _framing;
+            
+            // Header buffer (Large enough for checked frames)
             
             struct {
                 
-                uint32_t            _write;
-                uint32_t            _read;
+                uint8_t             _write[12];
+                uint8_t             _read[12];
+                size_t              _readSize;  // Bytes already in the read buffer (Kept while resynchronizing)
+                
+                uint32_t            _length;    // Length word of the frame being read (Host byte order, with flags)
+                uint32_t            _crc;       // Payload CRC-32C of the frame being read
+                bool                _lost;      // Looking for the next marker
                 
             } _header;
             
+            // Corrupted frames
+            
+            std::atomic<uint64_t>   _corruptions;
+            
             // Write queue
             
             std::queue<Node::Ptr>   _queue;
@@ -185,6 +294,21 @@ namespace coreKit {
             
             Node::Ptr               _current;
             
+            // Compression state
+            
+            struct {
+                
+                bool                            _helloSent;
+                uint8_t                         _hello[8];
+                
+                std::unique_ptr<Lz4::Encoder>   _encoder;   // Set once the peer accepted our codec
+                std::unique_ptr<Lz4::Decoder>   _decoder;   // Set once the peer announced its codec
+                
+                std::vector<uint8_t>            _input;     // Gathered frame (When sent from several buffers)
+                std::vector<uint8_t>            _output;    // Raw size followed by the compressed block
+                
+            } _compression;
+            
         };
         
     }
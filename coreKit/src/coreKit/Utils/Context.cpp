@@ -19,6 +19,10 @@ namespace coreKit {
         return _ioService;
     }
     
+    size_t Context::getThreadCount() const {
+        return _threadCount;
+    }
+    
     void Context::start() {
         
         if (!_ioServiceWork) {
@@ -31,6 +31,10 @@ namespace coreKit {
         
         boost::asio::io_service& getIoService();
         
+        // Number of worker threads
+        
+        size_t getThreadCount() const;
+        
         // Start / Stop
         
         void start();
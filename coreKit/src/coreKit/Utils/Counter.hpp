@@ -0,0 +1,72 @@
+//
+//  Counter.hpp
+//  coreKit
+//
+//
+
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+
+namespace coreKit {
+    
+    // Counter (Single writer, readable from any thread)
+    
+    // Note : Updates must be serialized (E.g. by a strand), they then cost a plain load and store
+    // instead of a locked read-modify-write.
+    
+    class Counter {
+    
+    public:
+        
+        // Init
+        
+        Counter() :
+        
+        _value(0)
+        
+        { }
+        
+        // Non-copyable by design
+        
+        Counter(const Counter&) = delete;
+        Counter& operator=(const Counter&) = delete;
+        
+        // Update (Writers must be serialized)
+        
+        Counter& operator++() {
+            return (*this += 1);
+        }
+        
+        uint64_t operator++(int) {
+            uint64_t value = *this;
+            *this += 1;
+            return value;
+        }
+        
+        Counter& operator+=(uint64_t value) {
+            _value.store(_value.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+            return *this;
+        }
+        
+        void reset() {
+            _value.store(0, std::memory_order_relaxed);
+        }
+        
+        // Read (Thread safe)
+        
+        operator uint64_t() const {
+            return _value.load(std::memory_order_relaxed);
+        }
+    
+    private:
+        
+        // Attributes
+        
+        std::atomic<uint64_t> _value;
+        
+    };
+    
+}
@@ -14,8 +14,14 @@
 
 namespace coreKit {
     
+    // Forward declarations
+    
+    class Context;
+    
     // Functions prototypes
     
+    // Note : crc<T> only inverts the low 32 bits of wider registers, CrcEngine.hpp has the standard parameterized CRCs
+    
     template<typename T>
     T crc(T crc, const void *data,
           size_t dataLength,
@@ -31,6 +37,9 @@ namespace coreKit {
         return crc ^ ~0U;
     }
     
+    // Note : Without a custom table, the fastest kernel for the CPU is selected on first use
+    // (PCLMULQDQ folding, SSE 4.2 / ARMv8 CRC instructions or slice-by-8 tables), results match crc<T>
+    
     uint16_t crc16(uint16_t crc16,
                    const void *data,
                    size_t dataLength,
@@ -46,4 +55,84 @@ namespace coreKit {
                    size_t dataLength,
                    const uint64_t* tab = nullptr);
     
+    // CRC-32C (Castagnoli)
+    
+    uint32_t crc32c(uint32_t crc32c,
+                    const void *data,
+                    size_t dataLength);
+    
+    // Combine (CRC of A followed by B, from both CRCs and the length of B, as zlib crc32_combine)
+    
+    uint32_t crc32Combine(uint32_t crc1,
+                          uint32_t crc2,
+                          uint64_t length2);
+    
+    uint32_t crc32cCombine(uint32_t crc1,
+                           uint32_t crc2,
+                           uint64_t length2);
+    
+    uint64_t crc64Combine(uint64_t crc1,
+                          uint64_t crc2,
+                          uint64_t length2);
+    
+    // Combinable CRCs
+    
+    enum class CrcType {
+        
+        Crc32   = 0,
+        Crc32c  = 1,
+        Crc64   = 2
+        
+    };
+    
+    // Parallel CRC (Chunks are spread over the context workers, then combined)
+    
+    // Note : The calling thread processes chunks too, it never waits for a busy or stopped context
+    
+    uint64_t crcParallel(Context &context,
+                         CrcType type,
+                         uint64_t crc,
+                         const void *data,
+                         size_t dataLength);
+    
+    // CrcStream (Incremental CRC over chunked data)
+    
+    class CrcStream {
+        
+    public:
+        
+        // Init
+        
+        CrcStream(CrcType type,
+                  uint64_t crc = 0);
+        
+        // Add data
+        
+        void update(const void *data,
+                    size_t dataLength);
+        
+        // Add the data of another stream (Started from a zero CRC, following this one)
+        
+        void append(const CrcStream &stream);
+        
+        // Start again
+        
+        void reset(uint64_t crc = 0);
+        
+        // Accessors
+        
+        CrcType getType() const;
+        uint64_t getValue() const;
+        uint64_t getLength() const;
+        
+    private:
+        
+        // Attributes
+        
+        CrcType     _type;
+        uint64_t    _crc;
+        uint64_t    _length;    // Bytes since the stream started
+        
+    };
+    
 }
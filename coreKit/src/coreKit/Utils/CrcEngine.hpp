@@ -0,0 +1,213 @@
+//
+//  CrcEngine.hpp
+//  coreKit
+//
+//
+
+#pragma once
+
+#include <stdint.h>
+
+#include <cstddef>
+#include <type_traits>
+
+namespace coreKit {
+    
+    // Compile time CRC tables and the slice-by-8 kernels using them
+    
+    namespace CrcTables {
+        
+        // Index sequence (Logarithmic instantiation depth, C++11)
+        
+        template<size_t... I> struct Indexes { using Type = Indexes; };
+        
+        template<typename A, typename B> struct Concat;
+        template<size_t... I, size_t... J> struct Concat<Indexes<I...>, Indexes<J...> > : Indexes<I..., (sizeof...(I) + J)...> { };
+        
+        template<size_t N> struct MakeIndexes : Concat<typename MakeIndexes<N / 2>::Type, typename MakeIndexes<N - N / 2>::Type> { };
+        template<> struct MakeIndexes<0> : Indexes<> { };
+        template<> struct MakeIndexes<1> : Indexes<0> { };
+        
+        // Bit helpers
+        
+        template<typename T>
+        constexpr T mask(unsigned width) {
+            return static_cast<T>(width >= sizeof(T) * 8 ? ~T(0) : (T(1) << width) - 1);
+        }
+        
+        template<typename T>
+        constexpr T reflect(T value, unsigned width) {
+            return width == 0 ? T(0) : static_cast<T>(((value & 1) << (width - 1)) | reflect<T>(static_cast<T>(value >> 1), width - 1));
+        }
+        
+        // Byte tables
+        
+        // Reflected (Least significant bit first, reflected polynomial)
+        
+        template<typename T, T polynomial>
+        struct ReflectedTable {
+            
+            using Value = T;
+            
+            static constexpr T step(T crc, unsigned bits) {
+                return bits == 0 ? crc : step(static_cast<T>((crc & 1) ? (crc >> 1) ^ polynomial : crc >> 1), bits - 1);
+            }
+            
+            static constexpr T entry(size_t index) {
+                return step(static_cast<T>(index), 8);
+            }
+            
+        };
+        
+        // Normal (Most significant bit first, width from 8 to 64 bits)
+        
+        template<typename T, unsigned width, T polynomial>
+        struct NormalTable {
+            
+            using Value = T;
+            
+            static constexpr T step(T crc, unsigned bits) {
+                return bits == 0 ? crc : step(static_cast<T>(((crc >> (width - 1)) & 1 ? (crc << 1) ^ polynomial : crc << 1) & mask<T>(width)), bits - 1);
+            }
+            
+            static constexpr T entry(size_t index) {
+                return step(static_cast<T>(static_cast<T>(index) << (width - 8)), 8);
+            }
+            
+        };
+        
+        // Register update (One byte, and k zero bytes for the slices)
+        
+        template<typename Table>
+        struct ReflectedUpdate {
+            
+            using Value = typename Table::Value;
+            
+            static constexpr Value byte(Value crc, uint8_t data) {
+                return static_cast<Value>(Table::entry((crc ^ data) & 0xFF) ^ (sizeof(Value) > 1 ? crc >> 8 : 0));
+            }
+            
+            static constexpr Value slice(size_t k, Value value) {
+                return k == 0 ? value : slice(k - 1, byte(value, 0));
+            }
+            
+        };
+        
+        template<typename Table, unsigned width>
+        struct NormalUpdate {
+            
+            using Value = typename Table::Value;
+            
+            static constexpr Value byte(Value crc, uint8_t data) {
+                return static_cast<Value>((Table::entry(((crc >> (width - 8)) ^ data) & 0xFF) ^ (width > 8 ? crc << 8 : 0)) & mask<Value>(width));
+            }
+            
+            static constexpr Value slice(size_t k, Value value) {
+                return k == 0 ? value : slice(k - 1, byte(value, 0));
+            }
+            
+        };
+        
+        // Slice-by-8 tables (Slice k at k * 256 : a byte followed by k zero bytes)
+        
+        template<typename T>
+        struct Slices {
+            
+            T _entries[8 * 256];
+            
+        };
+        
+        template<typename Update, typename Table, size_t... I>
+        constexpr Slices<typename Table::Value> makeSlices(Indexes<I...>) {
+            return { { Update::slice(I / 256, Table::entry(I % 256))... } };
+        }
+        
+        template<typename Update, typename Table>
+        constexpr Slices<typename Table::Value> makeSlices() {
+            return makeSlices<Update, Table>(typename MakeIndexes<8 * 256>::Type());
+        }
+        
+        // Kernels (Raw register, eight bytes per step)
+        
+        template<typename T>
+        T updateReflected(T crc, const uint8_t *data, size_t dataLength, const T *slices);
+        
+        template<typename T, unsigned width>
+        T updateNormal(T crc, const uint8_t *data, size_t dataLength, const T *slices);
+        
+    }
+    
+    // CrcEngine (Any CRC from 8 to 64 bits, described as in the CRC RevEng catalogue)
+    
+    // Note : Input and output reflection are the same, init is given unreflected
+    
+    template<typename T, unsigned Width, T Polynomial, bool Reflected, T Init, T XorOut>
+    class CrcEngine {
+        
+        static_assert(std::is_unsigned<T>::value && Width >= 8 && Width <= sizeof(T) * 8, "Unsupported CRC width");
+    
+    public:
+        
+        // Public declarations
+        
+        using Value = T;
+        
+        // Compile time CRC (Byte by byte, for short constants and checks)
+        
+        static constexpr Value checksum(const char *data, size_t dataLength);
+        
+        // Run time CRC (Slice-by-8)
+        
+        static Value compute(const void *data, size_t dataLength);
+        
+        // Incremental CRC (Start from initial(), update with each chunk, then finalize())
+        
+        static constexpr Value initial();
+        static Value update(Value crc, const void *data, size_t dataLength);
+        static constexpr Value finalize(Value crc);
+    
+    private:
+        
+        // Private declarations
+        
+        using Table = typename std::conditional<Reflected,
+                                                CrcTables::ReflectedTable<T, CrcTables::reflect<T>(Polynomial, Width)>,
+                                                CrcTables::NormalTable<T, Width, Polynomial> >::type;
+        
+        using Update = typename std::conditional<Reflected,
+                                                 CrcTables::ReflectedUpdate<Table>,
+                                                 CrcTables::NormalUpdate<Table, Width> >::type;
+        
+        // Private methods
+        
+        static constexpr Value process(Value crc, const char *data, size_t dataLength);
+        
+        // Attributes
+        
+        static constexpr CrcTables::Slices<T> _slices = CrcTables::makeSlices<Update, Table>();
+        
+    };
+    
+    // Presets (Parameters and check values from the CRC RevEng catalogue)
+    
+    using Crc8Smbus         = CrcEngine<uint8_t,    8,  0x07,                           false,  0x00,                           0x00>;
+    using Crc8Maxim         = CrcEngine<uint8_t,    8,  0x31,                           true,   0x00,                           0x00>;
+    using Crc8Autosar       = CrcEngine<uint8_t,    8,  0x2F,                           false,  0xFF,                           0xFF>;
+    using Crc15Can          = CrcEngine<uint16_t,   15, 0x4599,                         false,  0x0000,                         0x0000>;
+    using Crc16Arc          = CrcEngine<uint16_t,   16, 0x8005,                         true,   0x0000,                         0x0000>;
+    using Crc16Modbus       = CrcEngine<uint16_t,   16, 0x8005,                         true,   0xFFFF,                         0x0000>;
+    using Crc16Kermit       = CrcEngine<uint16_t,   16, 0x1021,                         true,   0x0000,                         0x0000>;
+    using Crc16Xmodem       = CrcEngine<uint16_t,   16, 0x1021,                         false,  0x0000,                         0x0000>;
+    using Crc16Ibm3740      = CrcEngine<uint16_t,   16, 0x1021,                         false,  0xFFFF,                         0x0000>;   // CCITT-FALSE
+    using Crc24OpenPgp      = CrcEngine<uint32_t,   24, 0x864CFB,                       false,  0xB704CE,                       0x000000>;
+    using Crc32IsoHdlc      = CrcEngine<uint32_t,   32, 0x04C11DB7,                     true,   0xFFFFFFFF,                     0xFFFFFFFF>;
+    using Crc32Iscsi        = CrcEngine<uint32_t,   32, 0x1EDC6F41,                     true,   0xFFFFFFFF,                     0xFFFFFFFF>;   // CRC-32C
+    using Crc32Bzip2        = CrcEngine<uint32_t,   32, 0x04C11DB7,                     false,  0xFFFFFFFF,                     0xFFFFFFFF>;
+    using Crc32Mpeg2        = CrcEngine<uint32_t,   32, 0x04C11DB7,                     false,  0xFFFFFFFF,                     0x00000000>;
+    using Crc64Ecma182      = CrcEngine<uint64_t,   64, UINT64_C(0x42F0E1EBA9EA3693),   false,  UINT64_C(0),                    UINT64_C(0)>;
+    using Crc64Xz           = CrcEngine<uint64_t,   64, UINT64_C(0x42F0E1EBA9EA3693),   true,   ~UINT64_C(0),                   ~UINT64_C(0)>;
+    using Crc64Redis        = CrcEngine<uint64_t,   64, UINT64_C(0xAD93D23594C935A9),   true,   UINT64_C(0),                    UINT64_C(0)>;
+    
+}
+
+#include "CrcEngine.ipp"
@@ -0,0 +1,133 @@
+//
+//  CrcEngine.ipp
+//  coreKit
+//
+//
+
+#pragma once
+
+#include <cstring>
+
+#include "CrcEngine.hpp"
+
+namespace coreKit {
+    
+    namespace CrcTables {
+        
+        // Kernels
+        
+        inline uint64_t load64(const uint8_t *data, bool bigEndian) {
+            
+            uint64_t result;
+            memcpy(&result, data, sizeof(result));
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+            bool swap = !bigEndian;
+#else
+            bool swap = bigEndian;
+#endif
+            
+            return (swap ? __builtin_bswap64(result) : result);
+        }
+        
+        template<typename T>
+        T updateReflected(T crc, const uint8_t *data, size_t dataLength, const T *slices) {
+            
+            // Note : The register covers the first bytes of the word (Little endian)
+            
+            while (dataLength >= 8) {
+                
+                uint64_t word = load64(data, false) ^ crc;
+                
+                crc = static_cast<T>(slices[7 * 256 + (word & 0xFF)] ^
+                                     slices[6 * 256 + ((word >> 8) & 0xFF)] ^
+                                     slices[5 * 256 + ((word >> 16) & 0xFF)] ^
+                                     slices[4 * 256 + ((word >> 24) & 0xFF)] ^
+                                     slices[3 * 256 + ((word >> 32) & 0xFF)] ^
+                                     slices[2 * 256 + ((word >> 40) & 0xFF)] ^
+                                     slices[1 * 256 + ((word >> 48) & 0xFF)] ^
+                                     slices[word >> 56]);
+                
+                data += 8;
+                dataLength -= 8;
+            }
+            
+            while (dataLength--) {
+                crc = static_cast<T>(slices[(crc ^ *data++) & 0xFF] ^ (sizeof(T) > 1 ? crc >> 8 : 0));
+            }
+            
+            return crc;
+        }
+        
+        template<typename T, unsigned width>
+        T updateNormal(T crc, const uint8_t *data, size_t dataLength, const T *slices) {
+            
+            // Note : The register covers the first bits of the word (Big endian)
+            
+            while (dataLength >= 8) {
+                
+                uint64_t word = load64(data, true) ^ (static_cast<uint64_t>(crc) << (64 - width));
+                
+                crc = static_cast<T>(slices[7 * 256 + (word >> 56)] ^
+                                     slices[6 * 256 + ((word >> 48) & 0xFF)] ^
+                                     slices[5 * 256 + ((word >> 40) & 0xFF)] ^
+                                     slices[4 * 256 + ((word >> 32) & 0xFF)] ^
+                                     slices[3 * 256 + ((word >> 24) & 0xFF)] ^
+                                     slices[2 * 256 + ((word >> 16) & 0xFF)] ^
+                                     slices[1 * 256 + ((word >> 8) & 0xFF)] ^
+                                     slices[word & 0xFF]);
+                
+                data += 8;
+                dataLength -= 8;
+            }
+            
+            while (dataLength--) {
+                crc = static_cast<T>((slices[((crc >> (width - 8)) ^ *data++) & 0xFF] ^ (width > 8 ? static_cast<uint64_t>(crc) << 8 : 0)) & mask<T>(width));
+            }
+            
+            return crc;
+        }
+        
+    }
+    
+    // CrcEngine
+    
+    template<typename T, unsigned Width, T Polynomial, bool Reflected, T Init, T XorOut>
+    constexpr CrcTables::Slices<T> CrcEngine<T, Width, Polynomial, Reflected, Init, XorOut>::_slices;
+    
+    template<typename T, unsigned Width, T Polynomial, bool Reflected, T Init, T XorOut>
+    constexpr T CrcEngine<T, Width, Polynomial, Reflected, Init, XorOut>::checksum(const char *data, size_t dataLength) {
+        return finalize(process(initial(), data, dataLength));
+    }
+    
+    template<typename T, unsigned Width, T Polynomial, bool Reflected, T Init, T XorOut>
+    T CrcEngine<T, Width, Polynomial, Reflected, Init, XorOut>::compute(const void *data, size_t dataLength) {
+        return finalize(update(initial(), data, dataLength));
+    }
+    
+    template<typename T, unsigned Width, T Polynomial, bool Reflected, T Init, T XorOut>
+    constexpr T CrcEngine<T, Width, Polynomial, Reflected, Init, XorOut>::initial() {
+        return (Reflected ? CrcTables::reflect<T>(Init, Width) : static_cast<T>(Init & CrcTables::mask<T>(Width)));
+    }
+    
+    template<typename T, unsigned Width, T Polynomial, bool Reflected, T Init, T XorOut>
+    T CrcEngine<T, Width, Polynomial, Reflected, Init, XorOut>::update(T crc, const void *data, size_t dataLength) {
+        
+        auto bytes = static_cast<const uint8_t*>(data);
+        
+        return (Reflected ?
+                CrcTables::updateReflected<T>(crc, bytes, dataLength, _slices._entries) :
+                CrcTables::updateNormal<T, Width>(crc, bytes, dataLength, _slices._entries));
+    }
+    
+    template<typename T, unsigned Width, T Polynomial, bool Reflected, T Init, T XorOut>
+    constexpr T CrcEngine<T, Width, Polynomial, Reflected, Init, XorOut>::finalize(T crc) {
+        return static_cast<T>((crc ^ XorOut) & CrcTables::mask<T>(Width));
+    }
+    
+    template<typename T, unsigned Width, T Polynomial, bool Reflected, T Init, T XorOut>
+    constexpr T CrcEngine<T, Width, Polynomial, Reflected, Init, XorOut>::process(T crc, const char *data, size_t dataLength) {
+        return dataLength == 0 ? crc : process(Update::byte(crc, static_cast<uint8_t>(*data)), data + 1, dataLength - 1);
+    }
+    
+}
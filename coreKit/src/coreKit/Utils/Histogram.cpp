@@ -0,0 +1,209 @@
+//
+//  Histogram.cpp
+//  coreKit
+//
+//
+
+#include "Histogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace coreKit {
+    
+    // Histogram constants
+    
+    const unsigned Histogram::LinearBits;
+    const size_t Histogram::BucketCount;
+    
+    // Histogram::Snapshot
+    
+    Histogram::Snapshot::Snapshot() :
+    
+    _count      (0),
+    _sum        (0),
+    _min        (UINT64_MAX),
+    _max        (0),
+    _buckets    (BucketCount, 0)
+    
+    { }
+    
+    uint64_t Histogram::Snapshot::quantile(double quantile) const {
+        
+        if (_count == 0) {
+            return 0;
+        }
+        
+        // Rank of the wanted sample (1 based)
+        
+        auto rank = static_cast<uint64_t>(std::ceil(std::min(std::max(quantile, 0.0), 1.0) * _count));
+        rank = std::max<uint64_t>(rank, 1);
+        
+        uint64_t seen = 0;
+        for (size_t index = 0; index < _buckets.size(); index++) {
+            
+            seen += _buckets[index];
+            
+            if (seen >= rank) {
+                return std::min(std::max(bucketHighest(index), _min), _max);
+            }
+        }
+        
+        // Note : Buckets may lag behind the count while recording
+        
+        return _max;
+    }
+    
+    double Histogram::Snapshot::mean() const {
+        return (_count != 0 ? static_cast<double>(_sum) / _count : 0);
+    }
+    
+    void Histogram::Snapshot::merge(const Snapshot &other) {
+        
+        _count += other._count;
+        _sum += other._sum;
+        _min = std::min(_min, other._min);
+        _max = std::max(_max, other._max);
+        
+        for (size_t index = 0; index < _buckets.size(); index++) {
+            _buckets[index] += other._buckets[index];
+        }
+    }
+    
+    void Histogram::Snapshot::reset() {
+        
+        _count = 0;
+        _sum = 0;
+        _min = UINT64_MAX;
+        _max = 0;
+        
+        std::fill(_buckets.begin(), _buckets.end(), 0);
+    }
+    
+    // Histogram
+    
+    Histogram::Histogram() {
+        reset();
+    }
+    
+    void Histogram::record(uint64_t value) {
+        
+        _buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        _count.fetch_add(1, std::memory_order_relaxed);
+        _sum.fetch_add(value, std::memory_order_relaxed);
+        
+        // Note : Extremes rarely change, only then we pay for a CAS
+        
+        auto min = _min.load(std::memory_order_relaxed);
+        while (value < min && !_min.compare_exchange_weak(min, value, std::memory_order_relaxed)) { }
+        
+        auto max = _max.load(std::memory_order_relaxed);
+        while (value > max && !_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) { }
+    }
+    
+    void Histogram::recordExclusive(uint64_t value) {
+        
+        // Note : Plain loads and stores, readers still see consistent words
+        
+        auto &bucket = _buckets[bucketIndex(value)];
+        
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        _count.store(_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        _sum.store(_sum.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        
+        if (value < _min.load(std::memory_order_relaxed)) {
+            _min.store(value, std::memory_order_relaxed);
+        }
+        
+        if (value > _max.load(std::memory_order_relaxed)) {
+            _max.store(value, std::memory_order_relaxed);
+        }
+    }
+    
+    Histogram::Snapshot Histogram::snapshot() const {
+        
+        Snapshot result;
+        
+        result._count = _count.load(std::memory_order_relaxed);
+        result._sum = _sum.load(std::memory_order_relaxed);
+        result._min = _min.load(std::memory_order_relaxed);
+        result._max = _max.load(std::memory_order_relaxed);
+        
+        for (size_t index = 0; index < BucketCount; index++) {
+            result._buckets[index] = _buckets[index].load(std::memory_order_relaxed);
+        }
+        
+        return result;
+    }
+    
+    void Histogram::mergeInto(Snapshot &result) const {
+        
+        result._count += _count.load(std::memory_order_relaxed);
+        result._sum += _sum.load(std::memory_order_relaxed);
+        result._min = std::min(result._min, _min.load(std::memory_order_relaxed));
+        result._max = std::max(result._max, _max.load(std::memory_order_relaxed));
+        
+        for (size_t index = 0; index < BucketCount; index++) {
+            result._buckets[index] += _buckets[index].load(std::memory_order_relaxed);
+        }
+    }
+    
+    void Histogram::reset() {
+        
+        _count = 0;
+        _sum = 0;
+        _min = UINT64_MAX;
+        _max = 0;
+        
+        for (auto &bucket : _buckets) {
+            bucket = 0;
+        }
+    }
+    
+    size_t Histogram::bucketIndex(uint64_t value) {
+        
+        const uint64_t linear = 1ull << LinearBits;
+        const uint64_t half = linear >> 1;
+        
+        if (value < linear) {
+            return static_cast<size_t>(value);
+        }
+        
+        // Groups cover [2^(LinearBits + group - 1), 2^(LinearBits + group)) with half as many buckets
+        
+        unsigned msb = 63 - __builtin_clzll(value);
+        unsigned group = msb - LinearBits + 1;
+        
+        return static_cast<size_t>(linear + (group - 1) * half + ((value >> group) - half));
+    }
+    
+    uint64_t Histogram::bucketLowest(size_t index) {
+        
+        const uint64_t linear = 1ull << LinearBits;
+        const uint64_t half = linear >> 1;
+        
+        if (index < linear) {
+            return index;
+        }
+        
+        auto group = (index - linear) / half + 1;
+        auto sub = (index - linear) % half;
+        
+        return (sub + half) << group;
+    }
+    
+    uint64_t Histogram::bucketHighest(size_t index) {
+        
+        const uint64_t linear = 1ull << LinearBits;
+        const uint64_t half = linear >> 1;
+        
+        if (index < linear) {
+            return index;
+        }
+        
+        auto group = (index - linear) / half + 1;
+        
+        return bucketLowest(index) + ((1ull << group) - 1);
+    }
+    
+}
@@ -0,0 +1,115 @@
+//
+//  Histogram.hpp
+//  coreKit
+//
+//
+
+#pragma once
+
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace coreKit {
+    
+    // Histogram (Lock-free, HDR-style log-linear buckets)
+    
+    // Note : Values below 2^LinearBits are exact,
+    // larger ones fall in buckets less than 1/2^(LinearBits - 1) of their value wide (About 3 %).
+    // Recording is wait-free and may happen from any thread, snapshots too.
+    
+    class Histogram {
+    
+    public:
+        
+        // Declarations
+        
+        static const unsigned LinearBits = 6;
+        static const size_t BucketCount = (1u << LinearBits) + (64 - LinearBits) * (1u << (LinearBits - 1));
+        
+        // Snapshot (Plain copy, safe to share)
+        
+        struct Snapshot {
+            
+            // Methods
+            
+            Snapshot();
+            
+            // Value below which the given share of samples lies (quantile in %1)
+            
+            uint64_t quantile(double quantile) const;
+            
+            double mean() const;
+            
+            // Add samples of another snapshot
+            
+            void merge(const Snapshot &other);
+            
+            // Back to no sample (Buckets are kept allocated)
+            
+            void reset();
+            
+            // Attributes
+            
+            uint64_t _count;
+            uint64_t _sum;
+            uint64_t _min;
+            uint64_t _max;
+            
+            std::vector<uint64_t> _buckets;
+            
+        };
+        
+        // Init
+        
+        Histogram();
+        
+        // Non-copyable by design
+        
+        Histogram(const Histogram&) = delete;
+        Histogram& operator=(const Histogram&) = delete;
+        
+        // Record a value (Thread safe)
+        
+        void record(uint64_t value);
+        
+        // Record a value, cheaper when writers are serialized (E.g. by a strand)
+        
+        // Note : Must not race with any other record
+        
+        void recordExclusive(uint64_t value);
+        
+        // Consistent enough copy (Thread safe, concurrent records may be partially seen)
+        
+        Snapshot snapshot() const;
+        
+        // Add the samples to a snapshot (No allocation, for snapshots reused across reads)
+        
+        void mergeInto(Snapshot &result) const;
+        
+        void reset();
+        
+        // Bucket helpers
+        
+        static size_t bucketIndex(uint64_t value);
+        
+        static uint64_t bucketLowest(size_t index);
+        static uint64_t bucketHighest(size_t index);
+    
+    private:
+        
+        // Attributes
+        
+        std::atomic<uint64_t> _count;
+        std::atomic<uint64_t> _sum;
+        std::atomic<uint64_t> _min;
+        std::atomic<uint64_t> _max;
+        
+        std::array<std::atomic<uint64_t>, BucketCount> _buckets;
+        
+    };
+    
+}
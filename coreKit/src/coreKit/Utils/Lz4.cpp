@@ -0,0 +1,359 @@
+//
+//  Lz4.cpp
+//  coreKit
+//
+//
+
+#include "Lz4.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+// LZ4 block format defines
+
+#define LZ4_MIN_MATCH       4
+#define LZ4_LAST_LITERALS   5       // The last bytes of a block are always literals
+#define LZ4_MF_LIMIT        12      // No match may start in the last bytes of a block
+#define LZ4_MAX_OFFSET      65535
+#define LZ4_RUN_MASK        15
+
+#define LZ4_HASH_LOG        12
+#define LZ4_SKIP_TRIGGER    6       // Search step grows after 2^6 failed attempts
+
+// Streaming window (Dictionary size and buffer size before sliding)
+
+#define LZ4_DICTIONARY_SIZE (64 * 1024)
+#define LZ4_WINDOW_SIZE     (256 * 1024)
+
+static inline uint32_t read32(const uint8_t *data) {
+    uint32_t result;
+    memcpy(&result, data, sizeof(result));
+    return result;
+}
+
+static inline uint32_t hash(uint32_t sequence) {
+    return (sequence * 2654435761U) >> (32 - LZ4_HASH_LOG);
+}
+
+static inline uint8_t* writeLength(uint8_t *target, size_t length) {
+    
+    // Note : Length minus the nibble already in the token
+    
+    while (length >= 255) {
+        *target++ = 255;
+        length -= 255;
+    }
+    
+    *target++ = static_cast<uint8_t>(length);
+    
+    return target;
+}
+
+static inline uint8_t* writeLiterals(uint8_t *target, const uint8_t *literals, size_t length, uint8_t matchToken) {
+    
+    uint8_t *token = target++;
+    
+    if (length >= LZ4_RUN_MASK) {
+        *token = (LZ4_RUN_MASK << 4) | matchToken;
+        target = writeLength(target, length - LZ4_RUN_MASK);
+    } else {
+        *token = static_cast<uint8_t>(length << 4) | matchToken;
+    }
+    
+    memcpy(target, literals, length);
+    
+    return target + length;
+}
+
+static size_t compressBlock(const uint8_t *base,
+                            size_t start,
+                            size_t end,
+                            uint32_t *table,
+                            uint8_t *target) {
+    
+    // Note : Matches may reference any position in [0, start) (Dictionary) or in the block itself
+    
+    uint8_t *output = target;
+    size_t anchor = start;
+    
+    if (end - start > LZ4_MF_LIMIT) {
+        
+        const size_t limit = end - LZ4_MF_LIMIT;
+        const size_t matchLimit = end - LZ4_LAST_LITERALS;
+        
+        size_t position = start;
+        size_t attempts = 1 << LZ4_SKIP_TRIGGER;
+        
+        while (position < limit) {
+            
+            uint32_t sequence = read32(base + position);
+            uint32_t &entry = table[hash(sequence)];
+            size_t reference = entry;
+            
+            entry = static_cast<uint32_t>(position);
+            
+            if (reference >= position ||
+                position - reference > LZ4_MAX_OFFSET ||
+                read32(base + reference) != sequence) {
+                
+                // Skip faster through incompressible data
+                
+                position += (attempts++ >> LZ4_SKIP_TRIGGER);
+                continue;
+            }
+            
+            attempts = 1 << LZ4_SKIP_TRIGGER;
+            
+            // Extend backward (Within the pending literals)
+            
+            while (position > anchor && reference > 0 && base[position - 1] == base[reference - 1]) {
+                position--;
+                reference--;
+            }
+            
+            // Extend forward
+            
+            size_t length = LZ4_MIN_MATCH;
+            while (position + length < matchLimit && base[reference + length] == base[position + length]) {
+                length++;
+            }
+            
+            // Emit literals, offset and match length
+            
+            size_t matchLength = length - LZ4_MIN_MATCH;
+            uint8_t matchToken = static_cast<uint8_t>(std::min<size_t>(matchLength, LZ4_RUN_MASK));
+            
+            output = writeLiterals(output, base + anchor, position - anchor, matchToken);
+            
+            uint16_t offset = static_cast<uint16_t>(position - reference);
+            *output++ = static_cast<uint8_t>(offset);
+            *output++ = static_cast<uint8_t>(offset >> 8);
+            
+            if (matchLength >= LZ4_RUN_MASK) {
+                output = writeLength(output, matchLength - LZ4_RUN_MASK);
+            }
+            
+            position += length;
+            anchor = position;
+            
+            // Index the end of the match
+            
+            if (position < limit) {
+                table[hash(read32(base + position - 2))] = static_cast<uint32_t>(position - 2);
+            }
+        }
+    }
+    
+    // Last literals
+    
+    output = writeLiterals(output, base + anchor, end - anchor, 0);
+    
+    return output - target;
+}
+
+static size_t decompressBlock(const uint8_t *source,
+                              size_t size,
+                              uint8_t *base,
+                              size_t start,
+                              size_t rawSize) {
+    
+    // Note : Returns the decompressed size, (size_t) -1 on malformed input
+    
+    const size_t failure = static_cast<size_t>(-1);
+    
+    const uint8_t *input = source;
+    const uint8_t *inputEnd = source + size;
+    uint8_t *output = base + start;
+    uint8_t *outputEnd = output + rawSize;
+    
+    auto readLength = [&input, inputEnd](size_t &length) {
+        
+        uint8_t byte;
+        do {
+            if (input == inputEnd) {
+                return false;
+            }
+            byte = *input++;
+            length += byte;
+        } while (byte == 255);
+        
+        return true;
+    };
+    
+    while (input < inputEnd) {
+        
+        uint8_t token = *input++;
+        
+        // Literals
+        
+        size_t literals = token >> 4;
+        if (literals == LZ4_RUN_MASK && !readLength(literals)) {
+            return failure;
+        }
+        
+        if (literals > static_cast<size_t>(inputEnd - input) ||
+            literals > static_cast<size_t>(outputEnd - output)) {
+            return failure;
+        }
+        
+        memcpy(output, input, literals);
+        input += literals;
+        output += literals;
+        
+        // The last sequence has no match
+        
+        if (input == inputEnd) {
+            break;
+        }
+        
+        // Match
+        
+        if (inputEnd - input < 2) {
+            return failure;
+        }
+        
+        size_t offset = input[0] | (input[1] << 8);
+        input += 2;
+        
+        size_t length = token & LZ4_RUN_MASK;
+        if (length == LZ4_RUN_MASK && !readLength(length)) {
+            return failure;
+        }
+        length += LZ4_MIN_MATCH;
+        
+        if (offset == 0 ||
+            offset > static_cast<size_t>(output - base) ||
+            length > static_cast<size_t>(outputEnd - output)) {
+            return failure;
+        }
+        
+        const uint8_t *match = output - offset;
+        
+        if (offset >= length) {
+            memcpy(output, match, length);
+            output += length;
+        } else {
+            
+            // Overlapping copy (Repeated pattern)
+            
+            while (length--) {
+                *output++ = *match++;
+            }
+        }
+    }
+    
+    return output - (base + start);
+}
+
+namespace coreKit {
+    
+    namespace Lz4 {
+        
+        size_t compressBound(size_t size) {
+            return size + size / 255 + 16;
+        }
+        
+        // Encoder
+        
+        Encoder::Encoder(bool streaming) :
+        
+        _streaming  (streaming),
+        _table      (1 << LZ4_HASH_LOG, 0),
+        _window     (streaming ? LZ4_WINDOW_SIZE : 0),
+        _windowSize (0)
+        
+        { }
+        
+        size_t Encoder::compress(const void *source, size_t size, void *target) {
+            
+            if (!_streaming) {
+                
+                std::fill(_table.begin(), _table.end(), 0);
+                return compressBlock(static_cast<const uint8_t*>(source), 0, size, _table.data(), static_cast<uint8_t*>(target));
+            }
+            
+            // Slide the window, keep the dictionary
+            
+            if (_windowSize + size > _window.size()) {
+                
+                size_t kept = std::min<size_t>(_windowSize, LZ4_DICTIONARY_SIZE);
+                size_t shift = _windowSize - kept;
+                
+                if (kept != 0) {
+                    memmove(_window.data(), _window.data() + shift, kept);
+                }
+                
+                _windowSize = kept;
+                
+                for (auto &entry : _table) {
+                    entry = (entry >= shift ? static_cast<uint32_t>(entry - shift) : 0);
+                }
+                
+                if (kept + size > _window.size()) {
+                    _window.resize(kept + size);
+                }
+            }
+            
+            memcpy(_window.data() + _windowSize, source, size);
+            
+            size_t result = compressBlock(_window.data(), _windowSize, _windowSize + size, _table.data(), static_cast<uint8_t*>(target));
+            _windowSize += size;
+            
+            return result;
+        }
+        
+        void Encoder::reset() {
+            std::fill(_table.begin(), _table.end(), 0);
+            _windowSize = 0;
+        }
+        
+        // Decoder
+        
+        Decoder::Decoder(bool streaming) :
+        
+        _streaming  (streaming),
+        _window     (streaming ? LZ4_WINDOW_SIZE : 0),
+        _windowSize (0)
+        
+        { }
+        
+        const uint8_t* Decoder::decompress(const void *source, size_t size, size_t rawSize) {
+            
+            if (!_streaming) {
+                _windowSize = 0;
+            }
+            
+            // Slide the window, keep the dictionary
+            
+            if (_windowSize + rawSize > _window.size()) {
+                
+                size_t kept = std::min<size_t>(_windowSize, LZ4_DICTIONARY_SIZE);
+                
+                if (kept != 0) {
+                    memmove(_window.data(), _window.data() + _windowSize - kept, kept);
+                }
+                
+                _windowSize = kept;
+                
+                if (kept + rawSize > _window.size()) {
+                    _window.resize(kept + rawSize);
+                }
+            }
+            
+            if (decompressBlock(static_cast<const uint8_t*>(source), size, _window.data(), _windowSize, rawSize) != rawSize) {
+                throw std::runtime_error("Malformed LZ4 block");
+            }
+            
+            const uint8_t *result = _window.data() + _windowSize;
+            _windowSize += rawSize;
+            
+            return result;
+        }
+        
+        void Decoder::reset() {
+            _windowSize = 0;
+        }
+        
+    }
+}
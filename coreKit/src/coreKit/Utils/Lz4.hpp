@@ -0,0 +1,97 @@
+//
+//  Lz4.hpp
+//  coreKit
+//
+//
+
+#pragma once
+
+#include <stdint.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace coreKit {
+    
+    namespace Lz4 {
+        
+        // LZ4 block format (Compatible with LZ4_compress_default / LZ4_decompress_safe)
+        
+        // Note : In streaming mode, the last 64 KB of data are used as a dictionary for the next block
+        // (As LZ4_compress_fast_continue), both sides must then process every block in the same order
+        
+        // Worst case compressed size
+        
+        size_t compressBound(size_t size);
+        
+        // Encoder
+        
+        class Encoder {
+        
+        public:
+            
+            // Init
+            
+            Encoder(bool streaming);
+            
+            /* Non-copyable.*/
+            Encoder(const Encoder&) = delete;
+            Encoder & operator=(const Encoder&) = delete;
+            
+            // Compress a block (Target must hold compressBound(size) bytes, returns the compressed size)
+            
+            size_t compress(const void *source, size_t size, void *target);
+            
+            // Forget the dictionary
+            
+            void reset();
+        
+        private:
+            
+            // Attributes
+            
+            const bool _streaming;
+            
+            std::vector<uint32_t> _table;   // Positions by hash
+            std::vector<uint8_t> _window;   // Dictionary followed by the current block (Streaming only)
+            size_t _windowSize;
+            
+        };
+        
+        // Decoder
+        
+        class Decoder {
+        
+        public:
+            
+            // Init
+            
+            Decoder(bool streaming);
+            
+            /* Non-copyable.*/
+            Decoder(const Decoder&) = delete;
+            Decoder & operator=(const Decoder&) = delete;
+            
+            // Decompress a block (Throws on malformed input)
+            
+            // Note : The result is valid until the next call
+            
+            const uint8_t* decompress(const void *source, size_t size, size_t rawSize);
+            
+            // Forget the dictionary
+            
+            void reset();
+        
+        private:
+            
+            // Attributes
+            
+            const bool _streaming;
+            
+            std::vector<uint8_t> _window;   // Dictionary followed by the current block
+            size_t _windowSize;
+            
+        };
+        
+    }
+}